@@ -54,7 +54,17 @@ struct FACEFX_API FAnimNode_BlendFaceFXAnimation : public FAnimNode_Base
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Performance, meta = (DisplayName = "LOD Threshold"))
 	int32 LODThreshold;
 
+	/**
+	* Indicator if all FaceFX transforms shall be blended in local space within a single pass and written back into the pose at once instead of once per bone.
+	* Identical results at full alpha. Below full alpha the transforms are blended relative to the parent bones instead of in component space.
+	* As with the component space blend, changes upstream nodes made in component space are kept for all bones except the children of the blended bones
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Performance)
+	bool bBlendInLocalSpace;
+
 	// FAnimNode_Base interface
+	virtual bool HasPreUpdate() const override { return true; }
+	virtual void PreUpdate(const UAnimInstance* InAnimInstance) override;
 	virtual void Initialize_AnyThread(const FAnimationInitializeContext& Context) override;
 	virtual void CacheBones_AnyThread(const FAnimationCacheBonesContext & Context) override;
 	virtual void Update_AnyThread(const FAnimationUpdateContext& Context) override;
@@ -65,6 +75,9 @@ struct FACEFX_API FAnimNode_BlendFaceFXAnimation : public FAnimNode_Base
 
 private:
 
+	friend class FFaceFXBoneMappingCache;
+	friend class FFaceFXBlendLocalSpaceTest;
+
 	/** struct that holds a transform / boneidx mapping */
 	struct FBlendFacialAnimationEntry
 	{
@@ -82,8 +95,94 @@ private:
 		FQuat BoneRefPoseRotationInv;
 	};
 
-	/** The bone indices where to copy the transforms into. Based on the bone names coming from the facefx character instance */
-	TArray<FBlendFacialAnimationEntry> BoneIndices;
+	typedef TSharedPtr<const TArray<FBlendFacialAnimationEntry>, ESPMode::ThreadSafe> FBoneMappingPtr;
+
+	/** The bone indices where to copy the transforms into. Based on the bone names coming from the facefx character instance. Shared by all nodes using the same actor asset and skeletal mesh */
+	FBoneMappingPtr BoneIndices;
+
+	/**
+	* Builds the bone mapping of a FaceFX character onto a skeletal mesh
+	* @param FaceFXChar The character to map the bones of
+	* @param Component The skeletal mesh component to map the bones onto
+	* @param IsSkipBoneMappingWithoutNS Indicator if stripped name space bone mapping shall be skipped
+	* @returns The bone mapping in parents before children order
+	*/
+	static FBoneMappingPtr BuildBoneMapping(const class UFaceFXCharacter* FaceFXChar, const USkeletalMeshComponent* Component, bool IsSkipBoneMappingWithoutNS);
+
+	/** struct that holds a transform / compact pose bone index mapping for a bone that is present at the current LOD */
+	struct FCompactPoseEntry
+	{
+		FCompactPoseEntry(const FCompactPoseBoneIndex& InCompactPoseBoneIndex, int32 InTransformIdx) : CompactPoseBoneIndex(InCompactPoseBoneIndex), TransformIdx(InTransformIdx) {}
+
+		FCompactPoseBoneIndex CompactPoseBoneIndex;
+		int32 TransformIdx;
+	};
+
+	/** The bone mapping filtered for the bones required by the current bone container, translated to compact pose indices */
+	TArray<FCompactPoseEntry> CompactPoseEntries;
+
+	/** The number of FaceFX bone transforms required by the compact pose entries */
+	int32 NumRequiredTransforms;
+
+	/** The generation of the bone mapping cache the bone mapping got fetched at. The mapping gets fetched again once the cache purged mappings */
+	uint32 BoneMappingGeneration;
+
+	/** The FaceFX character the exclusions were taken from on the game thread */
+	TWeakObjectPtr<const class UFaceFXCharacter> LODMaskFaceFXChar;
+
+	/** The version of the LOD masks of the FaceFX character the exclusions were taken from */
+	uint32 LODMasksVersion;
+
+	/** The index of the LOD mask of the FaceFX character the exclusions were taken from. INDEX_NONE if none */
+	int32 LODMaskIdx;
+
+	/** The bone transforms skipped by the current LOD mask. Empty if none are skipped */
+	TBitArray<> ExcludedBones;
+
+	/** The track values skipped by the current LOD mask. Empty if none are skipped */
+	TBitArray<> ExcludedTracks;
+
+	/**
+	* Rebuilds the compact pose entries out of the bone mapping. Skips the bones excluded by the current LOD mask
+	* @param RequiredBones The bone container of the current LOD
+	*/
+	void CacheCompactPoseEntries(const FBoneContainer& RequiredBones);
+
+	/** struct that holds a skeleton curve / track value mapping */
+	struct FCurveEntry
+	{
+		FCurveEntry(SmartName::UID_Type InCurveUID, int32 InTrackIdx) : CurveUID(InCurveUID), TrackIdx(InTrackIdx) {}
+
+		SmartName::UID_Type CurveUID;
+		int32 TrackIdx;
+	};
+
+	/** The morph target and material curves of the skeleton that get driven by FaceFX track values */
+	TArray<FCurveEntry> CurveEntries;
+
+	/** The number of FaceFX track values required by the curve entries */
+	int32 NumRequiredTrackValues;
+
+	/**
+	* Blends the FaceFX track values into the animation curves
+	* @param Output The pose to blend into
+	* @param BlendWeight The blend weight
+	*/
+	void BlendCurves(FComponentSpacePoseContext& Output, float BlendWeight);
+
+	/**
+	* Blends the FaceFX transforms into the pose one bone at a time in component space
+	* @param Pose The pose to blend into
+	* @param BlendWeight The blend weight
+	*/
+	void BlendComponentSpace(FCSPose<FCompactPose>& Pose, float BlendWeight);
+
+	/**
+	* Blends the FaceFX transforms relative to the parent bones within a single parent first pass and writes all blended bones back into the pose at once
+	* @param Pose The pose to blend into
+	* @param BlendWeight The blend weight
+	*/
+	void BlendLocalSpace(FCSPose<FCompactPose>& Pose, float BlendWeight);
 
 	/**
 	* Try to load the FaceFX character data
@@ -91,12 +190,42 @@ private:
 	*/
 	void LoadFaceFXData(FAnimInstanceProxy* AnimInstanceProxy);
 
+	/** The copy of the bone transforms last published by the FaceFX character. Kept as member to prevent reallocations per evaluation */
+	TArray<FTransform> FaceFXBoneTransforms;
+
+	/** The copy of the track values last published by the FaceFX character. Kept as member to prevent reallocations per evaluation */
+	TArray<float> FaceFXTrackValues;
+
+	/** The targets of the copies that are in flight. Only swapped with the copies above once a consistent copy got made, as failed copies may leave partial data behind */
+	TArray<FTransform> ScratchBoneTransforms;
+	TArray<float> ScratchTrackValues;
+
+	/** The FaceFX character the copies were taken from */
+	TWeakObjectPtr<const class UFaceFXCharacter> CopiedFaceFXChar;
+
+	/** The output versions of the FaceFX character the bone transforms and track values copies were taken from */
+	uint32 BoneTransformsVersion;
+	uint32 TrackValuesVersion;
+
+	/** Indicator if the copies of the bone transforms and track values are valid */
+	uint8 bIsBoneTransformsCopied : 1;
+	uint8 bIsTrackValuesCopied : 1;
+
 	/** The container where we put the current transforms into that are about to get blended. We always only use the very first entry */
 	TArray<FBoneTransform> TargetBlendTransform;
 
+	/** The component space transforms of all bones blended in local space. Kept as member to prevent reallocations per evaluation */
+	TArray<FBoneTransform> LocalBlendTransforms;
+
+	/** The index within LocalBlendTransforms per compact pose bone index. INDEX_NONE for bones that are not blended */
+	TArray<int32> LocalBlendSlots;
+
 	/** Indicator if the async loading process of the FaceFX character has completed. */
 	uint8 bFaceFXCharacterLoadingCompleted : 1;
 
+	/** Indicator if the bone mapping changed since the compact pose entries were built */
+	uint8 bIsCompactPoseEntriesDirty : 1;
+
 	EFaceFXBlendMode BlendMode;
 
 #if !UE_BUILD_SHIPPING
@@ -81,6 +81,10 @@ struct FACEFX_API FFaceFXEntry
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = FaceFX, DisplayName="Ignore Events")
 	uint8 bIsIgnoreEvents : 1;
 
+	/** The FaceFX tracks that drive custom primitive data of the skelmesh instead of material parameters. Keyed by track name, valued by custom primitive data index. Keeps the materials non-instanced */
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = FaceFX)
+	TMap<FName, int32> CustomPrimitiveDataTracks;
+
 	FORCEINLINE bool operator==(const USkeletalMeshComponent* InComp) const
 	{
 		return SkelMeshComp == InComp;
@@ -92,6 +96,57 @@ struct FACEFX_API FFaceFXEntry
 	}
 };
 
+/** A single update rate level of the FaceFX characters of a component. Selected based on the screen size of the skelmesh */
+USTRUCT(BlueprintType)
+struct FACEFX_API FFaceFXUpdateRateLevel
+{
+	GENERATED_USTRUCT_BODY()
+
+	FFaceFXUpdateRateLevel() : MinScreenSize(0.F), UpdateRate(0.F) {}
+	FFaceFXUpdateRateLevel(float InMinScreenSize, float InUpdateRate) : MinScreenSize(InMinScreenSize), UpdateRate(InUpdateRate) {}
+
+	/** The minimum screen size of the skelmesh bounds required for this level. 1.0 means the bounds cover the whole screen height */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=FaceFX, meta=(ClampMin=0.F, UIMax=1.F))
+	float MinScreenSize;
+
+	/** The number of facial animation evaluations per second. 0 freezes the facial animation while events and audio keep being processed */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=FaceFX, meta=(ClampMin=0.F))
+	float UpdateRate;
+};
+
+/** The update rate settings for the FaceFX characters of a component */
+USTRUCT(BlueprintType)
+struct FACEFX_API FFaceFXUpdateRateSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	FFaceFXUpdateRateSettings() : bIsEnabled(true), bIsInterpolate(false), FullRateScreenSize(.3F), NotRenderedUpdateRate(0.F)
+	{
+		Levels.Add(FFaceFXUpdateRateLevel(.1F, 30.F));
+		Levels.Add(FFaceFXUpdateRateLevel(.03F, 10.F));
+	}
+
+	/** Indicates whether or not the facial animation gets evaluated with a reduced rate based on screen size and visibility. Can be globally disabled via FaceFX.UpdateRate.Enable */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=FaceFX, DisplayName="Enable Update Rate Optimizations")
+	uint8 bIsEnabled : 1;
+
+	/** Indicates whether or not the bone transforms and track values of characters with a reduced update rate get interpolated between two evaluations. Delays the facial animation against the audio by one evaluation interval, hence off by default. Characters at full rate are never delayed */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=FaceFX, DisplayName="Interpolate")
+	uint8 bIsInterpolate : 1;
+
+	/** The minimum screen size of the skelmesh bounds at which the facial animation gets evaluated every frame */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=FaceFX, meta=(ClampMin=0.F, UIMax=1.F))
+	float FullRateScreenSize;
+
+	/** The update rate levels for screen sizes below FullRateScreenSize, checked in order. The first level with a MinScreenSize less or equal the current screen size is used. Screen sizes below all levels freeze the facial animation */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=FaceFX)
+	TArray<FFaceFXUpdateRateLevel> Levels;
+
+	/** The number of facial animation evaluations per second when the skelmesh was not rendered recently. 0 freezes the facial animation while events and audio keep being processed */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=FaceFX, meta=(ClampMin=0.F))
+	float NotRenderedUpdateRate;
+};
+
 /** A component that allows to setup facial animation for skelmesh components and to use the blend facial animation nodes into their animation blueprints */
 UCLASS(ClassGroup=(Rendering, Common), hidecategories=(Object, Sockets, Activation), editinlinenew, meta=(BlueprintSpawnableComponent))
 class FACEFX_API UFaceFXComponent : public UActorComponent
@@ -127,6 +182,15 @@ public:
 			   UPARAM(DisplayName="Ignore Events") bool IsIgnoreEvents, 
 			   const UObject* Caller = nullptr);
 
+	/**
+	* Sets the FaceFX tracks that drive custom primitive data of a given skel mesh component instead of material parameters
+	* @param Tracks The custom primitive data index keyed by FaceFX track name
+	* @param SkelMeshComp The skelmesh component to set the tracks for. Keep nullptr to use the first setup skelmesh component character instead
+	* @returns True if succeeded, else false
+	*/
+	UFUNCTION(BlueprintCallable, Category=FaceFX, Meta=(HidePin="Caller", DefaultToSelf="Caller"))
+	bool SetCustomPrimitiveDataTracks(const TMap<FName, int32>& Tracks, USkeletalMeshComponent* SkelMeshComp = nullptr, const UObject* Caller = nullptr);
+
 	/**
 	* Starts the playback of the given facial animation for a given skel mesh components character
 	* @param Group The animation group
@@ -181,7 +245,7 @@ public:
 	/**
 	* Jumps to a given position within the current facial animation playback or at a given animation
 	* @param Position The target position to jump to (in seconds)
-	* @param Pause Indicator if the playback shall be paused right afterwards
+	* @param Pause Indicator if the playback shall be paused right afterwards. Jumps within an already paused animation only pose the character without restarting the playback
 	* @param Animation The animation to start. Keep nullptr to jump within the currently playing facial animation
 	* @param LoopAnimation Indicator if the animation to start shall be looped when being newly started
 	* @param SkelMeshComp The skelmesh component to resume the playback for. Keep nullptr to use the first setup skelmesh component character instead
@@ -193,7 +257,7 @@ public:
 	/**
 	* Jumps to a given position within the current facial animation playback or at a given animation
 	* @param Position The target position to jump to (in seconds)
-	* @param Pause Indicator if the playback shall be paused right afterwards
+	* @param Pause Indicator if the playback shall be paused right afterwards. Jumps within an already paused animation only pose the character without restarting the playback
 	* @param Animation The animation to start. Keep nullptr to jump within the currently playing facial animation
 	* @param Group The animation group to start. Keep Group and AnimName to NAME_None to jump within the currently playing facial animation
 	* @param AnimName The animation id to start. Keep Group and AnimName to NAME_None to jump within the currently playing facial animation
@@ -237,6 +301,10 @@ public:
 	*/
 	bool IsAnimationActive(const FFaceFXAnimId& AnimId, USkeletalMeshComponent* SkelMeshComp = nullptr, const UObject* Caller = nullptr) const;
 
+	/** The update rate settings for the FaceFX characters of this component */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category=FaceFX)
+	FFaceFXUpdateRateSettings UpdateRateSettings;
+
 	/** Event that triggers whenever any of the FaceFX character instances plays a facial animation that requested the startup of audio playback */
 	UPROPERTY(BlueprintAssignable, Category=FaceFX)
 	FOnFaceFXAudioStartEventSignature OnPlaybackAudioStart;
@@ -39,6 +39,41 @@ enum class EFaceFXActorBlendMode : uint8
 	Additive UMETA(DisplayName = "Add to Existing")
 };
 
+/** Evaluator for FaceFX characters that is set per actor asset */
+UENUM()
+enum class EFaceFXActorEvaluator : uint8
+{
+	/** The evaluator set via the console variable FaceFX.PreferredEvaluator is used */
+	Global UMETA(DisplayName = "Use Global Config"),
+
+	/** The animations are evaluated by the FaceFX runtime */
+	Runtime UMETA(DisplayName = "FaceFX Runtime"),
+
+	/** The baked curves of the animations are sampled. Animations without matching baked curves are evaluated by the FaceFX runtime */
+	Baked UMETA(DisplayName = "Baked Curves")
+};
+
+/** The FaceFX bones and tracks that get skipped from a skeletal mesh LOD onwards */
+USTRUCT(BlueprintType)
+struct FFaceFXActorLODMask
+{
+	GENERATED_USTRUCT_BODY()
+
+	FFaceFXActorLODMask() : MinLOD(1) {}
+
+	/** The first skeletal mesh LOD this mask applies to. Applies until the next mask with a higher LOD */
+	UPROPERTY(EditAnywhere, Category=LOD, meta=(ClampMin=0))
+	int32 MinLOD;
+
+	/** The FaceFX bones that are not blended into the pose */
+	UPROPERTY(EditAnywhere, Category=LOD)
+	TArray<FName> ExcludedBones;
+
+	/** The FaceFX tracks that are not applied to morph targets, material parameters and animation curves */
+	UPROPERTY(EditAnywhere, Category=LOD)
+	TArray<FName> ExcludedTracks;
+};
+
 /** Asset that can be assigned to FaceFXComponents and which contain the FaceFX runtime data */
 UCLASS(BlueprintType, hideCategories=Object)
 class FACEFX_API UFaceFXActor : public UFaceFXAsset
@@ -48,7 +83,12 @@ class FACEFX_API UFaceFXActor : public UFaceFXAsset
 public:
 
 	//UObject
+	virtual void PostLoad() override;
+	virtual void BeginDestroy() override;
 	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif //WITH_EDITOR
 	//~UObject
 
 	virtual bool IsValid() const override
@@ -61,14 +101,50 @@ public:
 		return BlendMode;
 	}
 
+	inline EFaceFXActorEvaluator GetEvaluator() const
+	{
+		return Evaluator;
+	}
+
+	inline const TArray<FFaceFXActorLODMask>& GetLODMasks() const
+	{
+		return LODMasks;
+	}
+
 #if WITH_EDITORONLY_DATA
 
 	friend struct FFaceFXEditorTools;
 
 	//UObject
 	virtual void Serialize(FArchive& Ar) override;
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
 	//~UObject
 
+	/**
+	* Validates the actor and bones data with the FaceFX runtime and stores the hash of the validated data within the actor data.
+	* This allows the runtime to load the data without validation. See FACEFX_TRUST_VALIDATED_DATA
+	* @param OutErrorMessage The optional reason why the validation failed
+	* @returns True if the data is valid, else false
+	*/
+	bool ValidateData(FString* OutErrorMessage = nullptr);
+
+#if FACEFX_USEANIMATIONLINKAGE
+	/**
+	* Checks the compatibility of all linked animations with this actor and stores the results within the actor data.
+	* This allows the runtime to skip the compatibility checks for the linked animations
+	* @returns True if succeeded, else false
+	*/
+	bool BuildAnimationCompatibility();
+
+	/**
+	* Samples linked animations and stores the tracks they change within the actor data.
+	* This allows the characters to only process those tracks while playing such an animation
+	* @param Animation The animation to sample. nullptr to sample all linked animations
+	* @returns True if succeeded, else false
+	*/
+	bool BuildAnimationActiveTracks(const class UFaceFXAnim* Animation = nullptr);
+#endif //FACEFX_USEANIMATIONLINKAGE
+
 	/**
 	* Gets the details in a human readable string representation
 	* @param OutDetails The resulting details string
@@ -137,4 +213,15 @@ private:
 	/** The linked animations where this set look up the animations in */
 	UPROPERTY(EditAnywhere, Category = FaceFX)
 	EFaceFXActorBlendMode BlendMode = EFaceFXActorBlendMode::Global;
+
+	/** The evaluator the characters created from this asset use. Applies to characters loaded afterwards */
+	UPROPERTY(EditAnywhere, Category = FaceFX)
+	EFaceFXActorEvaluator Evaluator = EFaceFXActorEvaluator::Global;
+
+	/**
+	* The bones and tracks to skip at the lower skeletal mesh LODs. The mask with the highest MinLOD not above the predicted LOD applies.
+	* Bones removed by the LOD bone reduction of the skeletal mesh are skipped regardless
+	*/
+	UPROPERTY(EditAnywhere, Category = LOD)
+	TArray<FFaceFXActorLODMask> LODMasks;
 };
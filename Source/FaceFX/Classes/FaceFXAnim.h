@@ -34,6 +34,8 @@ class FACEFX_API UFaceFXAnim : public UFaceFXAsset
 public:
 
 	//UObject
+	virtual void PostLoad() override;
+	virtual void BeginDestroy() override;
 	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
 	//~UObject
 
@@ -48,8 +50,17 @@ public:
 
 	//UObject
 	virtual void Serialize(FArchive& Ar) override;
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
 	//~UObject
 
+	/**
+	* Validates the animation data with the FaceFX runtime and stores the hash of the validated data within the animation data.
+	* This allows the runtime to load the data without validation. See FACEFX_TRUST_VALIDATED_DATA
+	* @param OutErrorMessage The optional reason why the validation failed
+	* @returns True if the data is valid, else false
+	*/
+	bool ValidateData(FString* OutErrorMessage = nullptr);
+
 	/**
 	* Gets the details in a human readable string representation
 	* @param OutDetails The resulting details string
@@ -23,22 +23,29 @@
 #include "FaceFXConfig.h"
 #include "FaceFXData.h"
 #include "FaceFXAnim.h"
+#include "FaceFXCharacterOutput.h"
+#include "FaceFXActorTemplate.h"
 
-#include "Tickable.h"
 #include "FaceFXCharacter.generated.h"
 
 struct IFaceFXAudio;
+struct IFaceFXEvaluator;
 class UFaceFXActor;
 class UFaceFXComponent;
 class UFaceFXAsset;
+class UFaceFXCharacterSubsystem;
 class AActor;
+class UMaterialInstanceDynamic;
 
 /** Class that represents a FaceFX character instance */
 UCLASS()
-class FACEFX_API UFaceFXCharacter : public UObject, public FTickableGameObject
+class FACEFX_API UFaceFXCharacter : public UObject
 {
 	GENERATED_UCLASS_BODY()
 
+	friend class UFaceFXCharacterSubsystem;
+	friend struct IFaceFXEvaluator;
+
 	/** The delegate used for various FaceFX events */
 	DECLARE_MULTICAST_DELEGATE_TwoParams(FOnFaceFXCharacterEventSignature, UFaceFXCharacter* /*Character*/, const FFaceFXAnimId& /*AnimId*/);
 	DECLARE_MULTICAST_DELEGATE_FourParams(FOnFaceFXCharacterAudioStartEventSignature, UFaceFXCharacter* /*Character*/, const FFaceFXAnimId& /*AnimId*/, bool /*IsAudioStarted*/, UActorComponent* /*AudioComponentStartedOn*/);
@@ -82,8 +89,14 @@ public:
 
 private:
 
-	/** Callback for event notifications from within the FaceFX runtime. These are set within the source asset with a custom string being assigned */
-	static void OnFaceFXEvent(const FxEventFiringContext* Context, const char* Payload);
+	/**
+	* Handles an event fired by the currently playing animation. These are set within the source asset with a custom string being assigned
+	* @param ChannelIndex The index of the channel the event got fired on
+	* @param ChannelTime The channel time
+	* @param EventTime The event time
+	* @param Payload The event payload
+	*/
+	void HandleAnimationEvent(int32 ChannelIndex, float ChannelTime, float EventTime, FString&& Payload);
 
 public:
 
@@ -148,12 +161,27 @@ public:
 	}
 
 	/**
-	* Jumps to a given position within the facial animation playback
+	* Jumps to a given position within the facial animation playback.
+	* Only records the target position. The jump gets evaluated once by the next tick or FlushRequests, no matter how often it got requested in between
 	* @param Position The target position to jump to (in seconds). Ranges from 0 to animation duration
 	* @returns True if succeeded, else false
 	*/
 	bool JumpTo(float Position);
 
+	/**
+	* Evaluates a pending jump right away instead of within the next tick. Game thread only.
+	* Used by callers that need the output within the current frame, i.e. sequencer before refreshing the bone transforms
+	*/
+	void FlushRequests();
+
+	/**
+	* Poses the character at a given position within the paused facial animation. Unlike JumpTo this does not touch the playback, audio or event state.
+	* The pose gets evaluated by the stateless animation sampler. Resuming afterwards continues at the scrubbed position
+	* @param Position The target position (in seconds). Ranges from 0 to animation duration
+	* @returns True if succeeded, else false
+	*/
+	bool ScrubTo(float Position);
+
 	/** Reset the whole character setup */
 	void Reset();
 
@@ -171,10 +199,7 @@ public:
 	* Gets the indicator if this character have been loaded
 	* @returns True if loaded else false
 	*/
-	inline bool IsLoaded() const
-	{
-		return Actor != nullptr && FaceFXActor;
-	}
+	bool IsLoaded() const;
 
 	/**
 	* Gets the indicator if the character has the given facial animation active right now (playing or not)
@@ -246,7 +271,7 @@ public:
 	*/
 	inline bool IsPaused() const
 	{
-		return AnimPlaybackState == EPlaybackState::Paused && CurrentAnimation;
+		return AnimPlaybackState == EPlaybackState::Paused && CurrentAnim;
 	}
 
 	/**
@@ -295,6 +320,12 @@ public:
 	*/
 	void SetAudioComponent(UActorComponent* Component);
 
+	/**
+	* Sets the FaceFX tracks that get pushed into the custom primitive data of the owners skel mesh instead of material parameters
+	* @param Tracks The custom primitive data index keyed by FaceFX track name
+	*/
+	void SetCustomPrimitiveDataTracks(const TMap<FName, int32>& Tracks);
+
 	/** 
 	* Gets the audio player associated with this character 
 	* @returns The audio player
@@ -315,7 +346,8 @@ public:
 	*/
 	inline const TArray<FName>& GetBoneNames() const
 	{
-		return BoneNames;
+		static const TArray<FName> NoBoneNames;
+		return ActorTemplate.IsValid() ? ActorTemplate->GetBoneNames() : NoBoneNames;
 	}
 
 	/**
@@ -326,18 +358,81 @@ public:
 	int32 GetBoneNameTransformIndex(const FName& Name) const;
 
 	/**
-	* Receives the current bone transforms
-	* @param UpdateIfDirty Indicator if the transforms shall be updated if the character is dirty
-	* @return The current bone transforms
+	* Gets the indices within the transforms for a set of bone names
+	* @param Names The bone names to look for
+	* @param OutIndices The transforms indices in the order of Names, INDEX_NONE for bones not found
 	*/
-	inline const TArray<FTransform>& GetBoneTransforms(bool UpdateIfDirty = true)
+	void GetBoneNameTransformIndices(const TArray<FName>& Names, TArray<int32>& OutIndices) const;
+
+	/**
+	* Copies out the bone transforms of the latest evaluation. Safe to call from any thread. See FFaceFXCharacterOutputBuffer for the locking
+	* @param OutBoneTransforms The bone transforms target. Indices match GetBoneNameTransformIndex
+	* @returns True if the transforms were copied, else false. Keep using the previous transforms on failure
+	*/
+	inline bool GetBoneTransforms(TArray<FTransform>& OutBoneTransforms) const
 	{
-		if (bIsDirty && UpdateIfDirty)
-		{
-			UpdateTransforms();
-		}
+		return OutputBuffer.Read(&OutBoneTransforms, nullptr);
+	}
+
+	/**
+	* Copies out the track values of the latest evaluation. Safe to call from any thread. See FFaceFXCharacterOutputBuffer for the locking
+	* @param OutTrackValues The track values target
+	* @returns True if the track values were copied, else false. Keep using the previous track values on failure
+	*/
+	inline bool GetTrackValues(TArray<float>& OutTrackValues) const
+	{
+		return OutputBuffer.Read(nullptr, &OutTrackValues);
+	}
 
-		return BoneTransforms;
+	/**
+	* Gets the version of the latest published output. Only changes when the outputs changed. Safe to call from any thread
+	* @returns The output version
+	*/
+	inline uint32 GetOutputVersion() const
+	{
+		return OutputBuffer.GetVersion();
+	}
+
+	/**
+	* Gets the names of the animation curves that are driven by the FaceFX blend node instead of the game thread setters
+	* @returns The animation curve names
+	*/
+	inline const TArray<FName>& GetAnimationCurveNames() const
+	{
+		return AnimationCurveNames;
+	}
+
+	/**
+	* Gets the indexes of the animation curves in the track values. Match GetAnimationCurveNames
+	* @returns The animation curve track indexes
+	*/
+	inline const TArray<size_t>& GetAnimationCurveIndices() const
+	{
+		return AnimationCurveIndices;
+	}
+
+	/**
+	* Gets the LOD mask of the FaceFX actor asset that applies to a skeletal mesh LOD. Game thread only
+	* @param LODLevel The skeletal mesh LOD
+	* @returns The index of the LOD mask, INDEX_NONE if no mask applies
+	*/
+	int32 GetLODMaskIndex(int32 LODLevel) const;
+
+	/**
+	* Gets the bones and tracks skipped by a LOD mask. Game thread only
+	* @param MaskIdx The index of the LOD mask. See GetLODMaskIndex
+	* @param OutExcludedBones The skipped bones indexed by the bone transform index. Empty if no bone is skipped
+	* @param OutExcludedTracks The skipped tracks indexed by the track index. Empty if no track is skipped
+	*/
+	void GetLODMaskExclusions(int32 MaskIdx, TBitArray<>& OutExcludedBones, TBitArray<>& OutExcludedTracks) const;
+
+	/**
+	* Gets the version of the LOD masks. Changes whenever the LOD masks got resolved again. Game thread only
+	* @returns The LOD masks version
+	*/
+	inline uint32 GetLODMasksVersion() const
+	{
+		return LODMasksVersion;
 	}
 
 	/**
@@ -355,15 +450,27 @@ public:
 	*/
 	AActor* GetOwningActor() const;
 
-	//FTickableGameObject
-	virtual void Tick(float DeltaTime) override;
-	virtual bool IsTickable() const override;
-	virtual bool IsTickableInEditor() const override
-	{
-		return true;
-	}
-	virtual TStatId GetStatId() const override;
-	//~FTickableGameObject
+	/**
+	* Ticks the character within a single pass. Evaluates the current frame and processes all game thread outputs right away.
+	* Characters are usually ticked in batches by the UFaceFXCharacterSubsystem of their world
+	* @param DeltaTime The time passed since the last tick
+	*/
+	void Tick(float DeltaTime);
+
+	/**
+	* Gets the indicator if this character needs to get ticked
+	* @returns True if tickable, else false
+	*/
+	bool IsTickable() const;
+
+	/**
+	* Sets the rate at which the facial animation gets evaluated during ticks. Time, audio and animation end keep progressing every tick.
+	* Usually set by the UFaceFXCharacterSubsystem based on the update rate settings of the owning component
+	* @param Interval The minimum time in seconds between two evaluations. 0 evaluates every tick
+	* @param IsInterpolate Indicator if the outputs shall be interpolated between the last two evaluations
+	* @param IsFreezeOutput Indicator if evaluations shall only process events and audio while keeping the published outputs frozen
+	*/
+	void SetEvaluationRate(float Interval, bool IsInterpolate, bool IsFreezeOutput);
 
 #if FACEFX_USEANIMATIONLINKAGE
 
@@ -427,19 +534,6 @@ private:
 	*/
 	UFaceFXComponent* GetOwningFaceFXComponent() const;
 
-	/**
-	* Checks if the character FaceFX actor can play the given animation
-	* @param Animation The animation to check
-	* @returns True if it can play the animation, else false
-	*/
-	bool IsCanPlay(FxAnimation Animation) const;
-
-	/**
-	* Gets the indicator if the audio start event was triggered within the current frame state
-	* @returns True if audio was started, else false
-	*/
-	bool IsAudioStarted();
-
 	/**
 	* Gets the start and end time of the current animation
 	* @param OutStart The start time if call succeeded
@@ -455,8 +549,79 @@ private:
 	*/
 	bool Update(float DeltaTime);
 
-	/** Updates the local bone transform table */
-	void UpdateTransforms();
+	/**
+	* Computes the bone transforms of the current frame state and publishes them together with the current track values
+	* @returns True if a new output got published, false if it failed or the output did not change since the last publish
+	*/
+	bool PublishOutput();
+
+	/**
+	* Computes the bone transforms of the current frame state into the FaceFX bone transform buffer
+	* @returns True if succeeded, else false
+	*/
+	bool ComputeBoneTransforms();
+
+	/**
+	* Converts the computed FaceFX bone transforms and the current track values into an output
+	* @param Output The output to write into. Must be sized for the bones and tracks of this character
+	*/
+	void ConvertOutput(FFaceFXCharacterOutput& Output) const;
+
+	/** Stores the computed bone transforms and current track values as latest interpolation key */
+	void PushInterpolationKey();
+
+	/**
+	* Publishes the interpolated outputs for the current time and writes the interpolated track values into the current track values
+	* @returns True if a new output got published, false if the interpolation keys are equal and already got published
+	*/
+	bool PublishInterpolatedOutput();
+
+	/** Drops the evaluation history and enforces an evaluation on the next tick. Used whenever the playback time jumps */
+	void ResetEvaluationHistory();
+
+	/**
+	* Evaluates the facial animation for the current frame. Only touches the state of this character and can be called from worker threads.
+	* All work that must happen on the game thread is deferred until TickGameThread gets called
+	* @param DeltaTime The time passed since the last tick
+	*/
+	void TickEvaluate(float DeltaTime);
+
+	/**
+	* Evaluates the facial animation at the current time
+	* @param IsLastTick Indicator if this is the last tick of the current animation
+	*/
+	void EvaluateFrame(bool IsLastTick);
+
+	/**
+	* Gets the indicator if the next tick has to evaluate regardless of evaluation interval and budget
+	* @param DeltaTime The time that will pass until the next tick
+	* @returns True if enforced, else false
+	*/
+	bool IsEvaluationEnforced(float DeltaTime) const;
+
+	/**
+	* Gets the indicator if the audio start or an event of the current animation is due within the next tick.
+	* Keeps audio and events in sync while the pose evaluation is throttled
+	* @param DeltaTime The time that will pass until the next tick
+	* @returns True if due, else false
+	*/
+	bool IsTimelineEventDue(float DeltaTime) const;
+
+	/**
+	* Gets the indicator if the next tick evaluates based on the current evaluation interval
+	* @param DeltaTime The time that will pass until the next tick
+	* @returns True if due, else false
+	*/
+	bool IsEvaluationDue(float DeltaTime) const;
+
+	/** Processes the outputs of the last TickEvaluate that need to run on the game thread (events, audio, morph targets and material parameters) */
+	void TickGameThread();
+
+	/** Registers this character at the character subsystem of its world */
+	void RegisterWithSubsystem();
+
+	/** Unregisters this character from the character subsystem it is registered at */
+	void UnregisterFromSubsystem();
 
 	/**
 	* Unload the current animation
@@ -464,21 +629,31 @@ private:
 	void UnloadCurrentAnim();
 
 	/**
-	* Performs ticks from 0 to Duration in small enough timesteps to find out the location where the audio was triggered
-	* @param Duration The duration until to tick to
-	* @param OutAudioStarted True if the audio was started until the duration was reached, else false
-	* @param IgnoreEvents Indicator if we want to ignore events coming from within the FaceFX runtime while jumping to the target position
-	* @returns True if succeeded with ticking until the duration, else false
+	* Evaluates the pending jump. Restarts the evaluator at the jump position while ignoring the events up to it.
+	* Looks up the audio state and the skipped events within the animation timeline if present. Continues to the current time if it progressed since the jump got requested
+	* @param OutIsAudioStart True if the audio was started until the current time, else false
+	* @returns True if succeeded, else false
 	*/
-	bool TickUntil(float Duration, bool& OutAudioStarted, bool IgnoreEvents = true);
+	bool EvaluateJump(bool& OutIsAudioStart);
+
+	/**
+	* Retrieves the morph target and material curves of the skel mesh skeleton that get driven by the FaceFX blend node
+	* @returns True if setup succeeded, else false
+	*/
+	bool SetupAnimationCurves();
+
+	/** Resets the current animation curve data */
+	inline void ResetAnimationCurves()
+	{
+		AnimationCurveNames.Empty();
+		AnimationCurveIndices.Empty();
+	}
 
 	/**
-	* Retrieves the morph targets for a skel mesh and creates FaceFX indices for the names
-	* @param Dataset The asset to fetch the ids from
-	* @param TrackIds The FaceFX track ids
+	* Retrieves the morph targets for a skel mesh and creates FaceFX indices for the names. Skips the tracks driven as animation curves
 	* @returns True if setup succeeded, else false
 	*/
-	bool SetupMorphTargets(const UFaceFXActor* Dataset, const TArray<uint64_t>& TrackIds);
+	bool SetupMorphTargets();
 	
 	/** Processes the morph targets for the current frame state */
 	void ProcessMorphTargets();
@@ -488,30 +663,136 @@ private:
 	{
 		MorphTargetNames.Empty();
 		MorphTargetIndices.Empty();
+		MorphTargetValues.Empty();
 	}
 
 	/**
 	* Retrieves the material parameters for skel mesh materials and creates FaceFX indices for the names
-	* @param Dataset The asset to fetch the ids from
-	* @param TrackIds The FaceFX track ids
 	* @param IgnoredTracks The list of tracks to ignore
 	* @returns True if setup succeeded, else false
 	*/
-	bool SetupMaterialParameters(const UFaceFXActor* Dataset, const TArray<uint64_t>& TrackIds, const TArray<FName>& IgnoredTracks);
+	bool SetupMaterialParameters(const TArray<FName>& IgnoredTracks);
 
 	/** Processes the material parameters for the current frame state */
 	void ProcessMaterialParameters();
 
+	/**
+	* Resolves the dynamic material instances and parameter indices of the material parameter bindings. Creates dynamic material instances where needed
+	* @param SkelMeshComp The skel mesh component to resolve the material parameters for
+	*/
+	void SetupMaterialParameterTargets(USkeletalMeshComponent* SkelMeshComp);
+
+	/**
+	* Gets if the resolved material parameter targets still match the materials of a skel mesh component
+	* @param SkelMeshComp The skel mesh component to check against
+	* @returns True if the targets are still valid, else false
+	*/
+	bool IsMaterialParameterTargetsValid(const USkeletalMeshComponent* SkelMeshComp) const;
+
+	/**
+	* Writes a value into all resolved targets of a material parameter binding
+	* @param BindingIdx The index within MaterialParameterNames
+	* @param Value The value to write
+	*/
+	void WriteMaterialParameter(int32 BindingIdx, float Value);
+
+	/** Resets the resolved material parameter targets */
+	inline void ResetMaterialParameterTargets()
+	{
+		MaterialParameterSlots.Empty();
+		MaterialParameterMIDs.Empty();
+		MaterialParameterTargets.Empty();
+		MaterialParameterTargetOffsets.Empty();
+		MaterialParameterValues.Empty();
+		MaterialParameterDefaults.Empty();
+	}
+
 	/** Resets the current material parameter data */
 	inline void ResetMaterialParameters()
 	{
 		MaterialParameterNames.Empty();
 		MaterialParameterIndices.Empty();
+		ResetMaterialParameterTargets();
 	}
 
 	/** Sets the material parameters of the owners skel mesh to their defaults */
 	void ResetMaterialParametersToDefaults();
 
+	/**
+	* Resolves the FaceFX track indices for the custom primitive data tracks
+	* @returns True if setup succeeded, else false
+	*/
+	bool SetupCustomPrimitiveData();
+
+	/** Processes the custom primitive data for the current frame state */
+	void ProcessCustomPrimitiveData();
+
+	/** Resets the current custom primitive data bindings */
+	inline void ResetCustomPrimitiveData()
+	{
+		CustomPrimitiveDataNames.Empty();
+		CustomPrimitiveDataSlots.Empty();
+		CustomPrimitiveDataIndices.Empty();
+		CustomPrimitiveDataValues.Empty();
+	}
+
+	/** Processes the morph targets, material parameters and custom primitive data for the current frame state */
+	void ProcessTrackOutputs();
+
+	/**
+	* Sets the tracks that get processed while playing an animation. The tracks of the previous animation keep getting processed until they settled
+	* @param TrackIndices The sorted indices of the tracks changed by the animation. nullptr to process all tracks
+	*/
+	void SetActiveTracks(const TArray<int32>* TrackIndices);
+
+	/** Rebuilds the active morph target and material parameter lists from the active tracks and the LOD mask. Must be called whenever the bindings change */
+	void UpdateActiveOutputs();
+
+	/** Resets the active tracks so all tracks get processed */
+	inline void ResetActiveTracks()
+	{
+		ActiveTracks.Empty();
+		PendingActiveTracks.Empty();
+		bIsActiveTracksPending = false;
+		UpdateActiveOutputs();
+	}
+
+	/**
+	* Resolves the bone and track names of the LOD masks of the FaceFX actor asset
+	* @returns True if setup succeeded, else false
+	*/
+	bool SetupLODMasks();
+
+	/**
+	* Applies a LOD mask to the game thread setters. Tracks skipped by the mask get set to their rest values
+	* @param MaskIdx The index of the LOD mask to apply. INDEX_NONE to apply no mask
+	*/
+	void ApplyLODMask(int32 MaskIdx);
+
+	/** Applies the LOD mask of the predicted skeletal mesh LOD in case it changed. Called each frame independent of output changes */
+	void UpdateLODMask();
+
+	/** Resets the resolved LOD masks */
+	inline void ResetLODMasks()
+	{
+		LODMasks.Empty();
+		CurrentLODMaskIdx = INDEX_NONE;
+		++LODMasksVersion;
+		UpdateActiveOutputs();
+	}
+
+	/**
+	* Counts the write of a track output that is not part of the pending active tracks
+	* @param TrackIdx The index of the written track
+	*/
+	inline void CountPendingResetWrite(int32 TrackIdx)
+	{
+		if (bIsActiveTracksPending && PendingActiveTracks.Num() > 0 && !PendingActiveTracks[TrackIdx])
+		{
+			++NumPendingResetWrites;
+		}
+	}
+
 	/** The data set from where this character was loaded from */
 	UPROPERTY(Transient)
 	const UFaceFXActor* FaceFXActor;
@@ -519,29 +800,17 @@ private:
 	/** The audio player for this character */
 	TSharedPtr<IFaceFXAudio> AudioPlayer;
 
-	/** The associated actor handle */
-	FxActor Actor;
+	/** The evaluator for this character. Processes the frames and computes the track values and bone transforms */
+	TSharedPtr<IFaceFXEvaluator> Evaluator;
 
-	/** The current frame state */
-	FxFrameState FrameState;
+	/** The shared immutable data of the actor asset. Holds the bone set handle, the track and bone ids */
+	FFaceFXActorTemplatePtr ActorTemplate;
 
-	/** The bone set handle */
-	FxBoneSet BoneSet;
-
-	/** The handle of the currently playing animation */
-	FxAnimation CurrentAnimation;
-
-	/** The current FaceFX bone transforms */
+	/** The current FaceFX bone transforms. Only used as scratch buffer during PublishOutput */
 	TArray<FxBoneTransform> FaceFXBoneTransforms;
 
-	/** The current bone transforms */
-	TArray<FTransform> BoneTransforms;
-
-	/** The list of bone names defined within the FaceFX data used by this character */
-	TArray<FName> BoneNames;
-
-	/** The bone ids coming from the facefx asset */
-	TArray<uint64_t> BoneIds;
+	/** The published bone transforms and track values of the latest evaluations. Read by the anim graph on any thread */
+	FFaceFXCharacterOutputBuffer OutputBuffer;
 
 	/** The list of morph target names retrieved from the skel mesh during asset loading. The indices match the morph target track values: MorphTargetTrackValues */
 	TArray<FName> MorphTargetNames;
@@ -549,15 +818,172 @@ private:
 	/** The indexes of the morph targets in the FaceFX track values array */
 	TArray<size_t> MorphTargetIndices;
 
+	/** The last values written into the morph targets. Match MorphTargetNames */
+	TArray<float> MorphTargetValues;
+
 	/** The list of material parameter names retrieved from the skel mesh during asset loading. The indices match the material parameter track values: MaterialParameterTrackValues */
 	TArray<FName> MaterialParameterNames;
 
 	/** The indexes of the material parameters in the FaceFX track values array */
 	TArray<size_t> MaterialParameterIndices;
 
-	/** The FaceFX track values */
+	/** A driven parameter of a dynamic material instance */
+	struct FMaterialParameterTarget
+	{
+		FMaterialParameterTarget(int32 InMIDIdx, int32 InParameterIdx, int32 InBindingIdx) : MIDIdx(InMIDIdx), ParameterIdx(InParameterIdx), BindingIdx(InBindingIdx) {}
+
+		/** The index within MaterialParameterMIDs */
+		int32 MIDIdx;
+
+		/** The scalar parameter index within the dynamic material instance */
+		int32 ParameterIdx;
+
+		/** The index within MaterialParameterNames */
+		int32 BindingIdx;
+	};
+
+	/** The material slots of the skel mesh component that hold driven material parameters */
+	TArray<int32> MaterialParameterSlots;
+
+	/** The dynamic material instances of the material slots. Match MaterialParameterSlots */
+	TArray<TWeakObjectPtr<UMaterialInstanceDynamic>> MaterialParameterMIDs;
+
+	/** The resolved material parameter targets ordered by binding */
+	TArray<FMaterialParameterTarget> MaterialParameterTargets;
+
+	/** The first index within MaterialParameterTargets per binding. Holds one more entry than MaterialParameterNames to close the last range */
+	TArray<int32> MaterialParameterTargetOffsets;
+
+	/** The last values written into the material parameters. Match MaterialParameterNames */
+	TArray<float> MaterialParameterValues;
+
+	/** The default values of the material parameters. Match MaterialParameterNames */
+	TArray<float> MaterialParameterDefaults;
+
+	/** The custom primitive data index keyed by FaceFX track name. Kept across reloads */
+	TMap<FName, int32> CustomPrimitiveDataTracks;
+
+	/** The names of the tracks that drive custom primitive data. Ordered by custom primitive data index */
+	TArray<FName> CustomPrimitiveDataNames;
+
+	/** The custom primitive data indices in ascending order */
+	TArray<int32> CustomPrimitiveDataSlots;
+
+	/** The indexes of the custom primitive data tracks in the FaceFX track values array. Match CustomPrimitiveDataSlots */
+	TArray<size_t> CustomPrimitiveDataIndices;
+
+	/** The last values written into the custom primitive data. Match CustomPrimitiveDataSlots */
+	TArray<float> CustomPrimitiveDataValues;
+
+	/** The list of morph target and material curve names of the skeleton that are output by the FaceFX blend node */
+	TArray<FName> AnimationCurveNames;
+
+	/** The indexes of the animation curves in the FaceFX track values array */
+	TArray<size_t> AnimationCurveIndices;
+
+	/** The FaceFX track values of the current frame state. Only accessed by the evaluating thread and the game thread */
 	TArray<float> TrackValues;
 
+	/** The tracks processed by the game thread setters. Empty to process all tracks */
+	TBitArray<> ActiveTracks;
+
+	/** The tracks of the current animation that replace ActiveTracks once the tracks of the previous animation settled. Empty for all tracks */
+	TBitArray<> PendingActiveTracks;
+
+	/** The indices within MorphTargetNames of the active tracks */
+	TArray<int32> ActiveMorphTargets;
+
+	/** The indices within MaterialParameterNames of the active tracks */
+	TArray<int32> ActiveMaterialParameters;
+
+	/** The output version at the time PendingActiveTracks got set */
+	uint32 PendingActiveTracksVersion;
+
+	/** The number of writes of tracks outside of PendingActiveTracks during the current processing pass */
+	int32 NumPendingResetWrites;
+
+	/** A LOD mask of the FaceFX actor asset resolved to bone transform and track indices */
+	struct FLODMask
+	{
+		/** The first skeletal mesh LOD the mask applies to */
+		int32 MinLOD;
+
+		/** The skipped bones indexed by the bone transform index. Empty if no bone is skipped */
+		TBitArray<> ExcludedBones;
+
+		/** The skipped tracks indexed by the track index. Empty if no track is skipped */
+		TBitArray<> ExcludedTracks;
+	};
+
+	/** The resolved LOD masks ordered by MinLOD */
+	TArray<FLODMask> LODMasks;
+
+	/** The index of the LOD mask applied to the game thread setters. INDEX_NONE if none */
+	int32 CurrentLODMaskIdx;
+
+	/** The version of the resolved LOD masks. See GetLODMasksVersion */
+	uint32 LODMasksVersion;
+
+	/** An animation event received from the FaceFX runtime during TickEvaluate that awaits its broadcast on the game thread */
+	struct FPendingAnimationEvent
+	{
+		FPendingAnimationEvent(int32 InChannelIndex, float InChannelTime, float InEventTime, FString&& InPayload) :
+			ChannelIndex(InChannelIndex), ChannelTime(InChannelTime), EventTime(InEventTime), Payload(MoveTemp(InPayload)) {}
+
+		int32 ChannelIndex;
+		float ChannelTime;
+		float EventTime;
+		FString Payload;
+	};
+
+	/** The animation events received during the last TickEvaluate */
+	TArray<FPendingAnimationEvent> PendingAnimationEvents;
+
+	/** The position of the pending jump requested by JumpTo */
+	float PendingJumpPosition;
+
+	/** The animation position the pending jump started from. Forward jumps may fire the events in between, see FaceFX.Jump.CatchUpEvents */
+	float PendingJumpOrigin;
+
+	/** The frame the pending jump got requested in */
+	uint64 PendingJumpFrame;
+
+	/** The frame of the last evaluation. Used to evaluate at most once per frame */
+	uint64 LastEvaluationFrame;
+
+	/** The character subsystem this character is registered at */
+	TWeakObjectPtr<UFaceFXCharacterSubsystem> Subsystem;
+
+	/** The index of this character within the character list of the subsystem */
+	int32 SubsystemIndex;
+
+	/** The outputs of the last two evaluations used for interpolation. The latest one is at index 1 */
+	FFaceFXCharacterOutput InterpolationKeys[2];
+
+	/** The character times of the interpolation keys */
+	float InterpolationKeyTimes[2];
+
+	/** The number of valid interpolation keys */
+	int32 NumInterpolationKeys;
+
+	/** The raw FaceFX bone transforms of the last published output. Used to detect unchanged outputs */
+	TArray<FxBoneTransform> PublishedBoneTransforms;
+
+	/** The track values of the last published output. Used to detect unchanged outputs */
+	TArray<float> PublishedTrackValues;
+
+	/** The minimum time between two evaluations. 0 evaluates every tick */
+	float EvaluationInterval;
+
+	/** The time passed since the last evaluation */
+	float TimeSinceEvaluation;
+
+	/** The smoothed cost of a single evaluation in milliseconds. Used by the budget of the character subsystem */
+	float EvaluationCost;
+
+	/** The number of consecutive ticks the evaluation got deferred by the budget of the character subsystem */
+	int32 NumDeferredTicks;
+
 	/** The overall time progression */
 	float CurrentTime;
 
@@ -580,9 +1006,6 @@ private:
 	/** Used blend mode. Either defined by global config or overriden via FaceFXActor */
 	EFaceFXBlendMode BlendMode;
 
-	/** Dirty indicator */
-	uint8 bIsDirty : 1;
-
 	/** Looping indicator for the currently playing animation */
 	uint8 bIsLooping : 1;
 
@@ -601,9 +1024,58 @@ private:
 	/** Indicator if we ignore the events coming from the FaceFX runtime */
 	uint8 bIgnoreEvents : 1;
 
-#if WITH_EDITOR
-	uint32 LastFrameNumber;
+	/** Indicator if the events coming from the FaceFX runtime are queued up instead of being broadcasted right away */
+	uint8 bDeferEvents : 1;
+
+	/** Indicator if the last TickEvaluate produced outputs that still need to get processed by TickGameThread */
+	uint8 bIsGameThreadWorkPending : 1;
+
+	/** Indicator if the last TickEvaluate requested the start of the audio playback */
+	uint8 bIsAudioStartPending : 1;
+
+	/** Indicator if the audio start of the current playback got found by an evaluation. Animations without timeline get evaluated each tick until then */
+	uint8 bIsAudioStartDetected : 1;
 
+	/** Indicator if the last TickEvaluate reached the end of the current animation */
+	uint8 bIsAnimEndPending : 1;
+
+	/** Indicator if the last TickEvaluate produced new track values that need to get written to morph targets and material parameters */
+	uint8 bIsOutputPending : 1;
+
+	/** Indicator if the outputs get interpolated between two evaluations */
+	uint8 bInterpolateOutput : 1;
+
+	/** Indicator if evaluations only process events and audio while the published outputs stay frozen */
+	uint8 bFreezeOutput : 1;
+
+	/** Indicator if both interpolation keys are equal so any interpolation between them yields the same output */
+	uint8 bIsInterpolationKeysEqual : 1;
+
+	/** Indicator if the output of the equal interpolation keys got published already */
+	uint8 bIsInterpolatedOutputSettled : 1;
+
+	/** Indicator if the next tick must evaluate regardless of the evaluation interval */
+	uint8 bForceEvaluation : 1;
+
+	/** Indicator if the next tick shall skip its evaluation unless enforced. Set by the budget of the character subsystem */
+	uint8 bDeferEvaluation : 1;
+
+	/** Indicator if PendingActiveTracks awaits to replace ActiveTracks */
+	uint8 bIsActiveTracksPending : 1;
+
+	/** Indicator if neither the active tracks nor the LOD mask skip any morph target or material parameter */
+	uint8 bIsAllOutputsActive : 1;
+
+	/** Indicator if the published output got scrubbed by ScrubTo since the last playback change, leaving the evaluator behind the current position */
+	uint8 bIsScrubbed : 1;
+
+	/** Indicator if a jump got requested by JumpTo that is not evaluated yet */
+	uint8 bIsJumpPending : 1;
+
+	/** Indicator if the last TickEvaluate evaluated a jump whose audio needs to get updated by TickGameThread */
+	uint8 bIsJumpEvaluatedPending : 1;
+
+#if WITH_EDITOR
 	/** The event callback handle for OnFaceFXAnimChanged */
 	FDelegateHandle OnFaceFXAnimChangedHandle;
 
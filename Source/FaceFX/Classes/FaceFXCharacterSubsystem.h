@@ -0,0 +1,177 @@
+/*******************************************************************************
+  The MIT License (MIT)
+  Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "FaceFXCharacterSubsystem.generated.h"
+
+class UFaceFXCharacter;
+struct FFaceFXUpdateRateSettings;
+
+/** World subsystem that owns all live FaceFX characters of a world and ticks them within one batch */
+UCLASS()
+class FACEFX_API UFaceFXCharacterSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	/**
+	* Gets the character subsystem for the world of a given object
+	* @param WorldContextObject The object to get the world from
+	* @returns The subsystem or nullptr if the object is not part of a world
+	*/
+	static UFaceFXCharacterSubsystem* Get(const UObject* WorldContextObject);
+
+	//USubsystem
+	virtual void Deinitialize() override;
+	//~USubsystem
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual bool IsTickableInEditor() const override
+	{
+		return true;
+	}
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+	//~FTickableGameObject
+
+	/**
+	* Registers a character to be ticked by this subsystem
+	* @param Character The character to register
+	*/
+	void RegisterCharacter(UFaceFXCharacter* Character);
+
+	/**
+	* Unregisters a character from this subsystem
+	* @param Character The character to unregister
+	*/
+	void UnregisterCharacter(UFaceFXCharacter* Character);
+
+	/**
+	* Gets the number of characters registered at this subsystem
+	* @returns The character count
+	*/
+	inline int32 GetNumCharacters() const
+	{
+		return Characters.Num();
+	}
+
+private:
+
+	/** A view point from which the screen sizes of the characters get computed */
+	struct FViewPoint
+	{
+		FViewPoint(const FVector& InLocation, const FVector& InDirection, float InScreenScale) : Location(InLocation), Direction(InDirection), ScreenScale(InScreenScale) {}
+
+		/** The view location */
+		FVector Location;
+
+		/** The normalized view direction */
+		FVector Direction;
+
+		/** The screen size of a unit sized sphere at unit distance. Based on the field of view */
+		float ScreenScale;
+	};
+
+	/** The metrics of a character relative to the current view points */
+	struct FViewMetrics
+	{
+		FViewMetrics() : UpdateRateSettings(nullptr), ScreenSize(0.F), Distance(BIG_NUMBER), bWasRecentlyRendered(false), bIsFocused(false) {}
+
+		/** The update rate settings of the owning component. nullptr if the character has no skelmesh */
+		const FFaceFXUpdateRateSettings* UpdateRateSettings;
+
+		/** The largest screen size over all views */
+		float ScreenSize;
+
+		/** The distance to the closest view */
+		float Distance;
+
+		/** Indicator if the skelmesh was rendered recently */
+		uint8 bWasRecentlyRendered : 1;
+
+		/** Indicator if any view looks at the character */
+		uint8 bIsFocused : 1;
+	};
+
+	/** A character with its significance for the evaluation budget */
+	struct FScheduleEntry
+	{
+		FScheduleEntry(UFaceFXCharacter* InCharacter, float InSignificance) : Character(InCharacter), Significance(InSignificance) {}
+
+		UFaceFXCharacter* Character;
+		float Significance;
+	};
+
+	/** Collects the view points of all local players */
+	void GatherViewPoints();
+
+	/**
+	* Computes the metrics of a character relative to the current view points
+	* @param Character The character to compute the metrics for
+	* @returns The metrics
+	*/
+	FViewMetrics ComputeViewMetrics(const UFaceFXCharacter* Character) const;
+
+	/**
+	* Updates the evaluation rate of a character based on the update rate settings of its component, its screen size and visibility
+	* @param Character The character to update
+	* @param Metrics The view metrics of the character
+	*/
+	void UpdateEvaluationRate(UFaceFXCharacter* Character, const FViewMetrics& Metrics) const;
+
+	/**
+	* Computes the significance of a character for the evaluation budget. Speaking, audible, screen size and player focus increase the significance
+	* @param Character The character to compute the significance for
+	* @param Metrics The view metrics of the character
+	* @returns The significance
+	*/
+	static float ComputeSignificance(const UFaceFXCharacter* Character, const FViewMetrics& Metrics);
+
+	/**
+	* Gets the evaluation budget per frame from the console variable or the project settings
+	* @returns The budget in milliseconds. 0 if unlimited
+	*/
+	static float GetEvaluationBudget();
+
+	/**
+	* Defers the evaluations of the least significant characters that exceed the evaluation budget
+	* @param DeltaTime The time passed since the last tick
+	*/
+	void ScheduleEvaluations(float DeltaTime);
+
+	/** The view points of the current frame */
+	TArray<FViewPoint> ViewPoints;
+
+	/** All registered characters. Each character knows its own index within this list */
+	TArray<UFaceFXCharacter*> Characters;
+
+	/** The characters that get ticked within the current frame. Kept as member to prevent reallocations per frame. Only filled during the tick, unregistered characters get nulled out */
+	TArray<UFaceFXCharacter*> TickBatch;
+
+	/** The characters ranked for the evaluation budget within the current frame. Kept as member to prevent reallocations per frame */
+	TArray<FScheduleEntry> Schedule;
+};
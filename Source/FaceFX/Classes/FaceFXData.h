@@ -23,6 +23,7 @@
 #include "FaceFXConfig.h"
 #include "CoreMinimal.h"
 #include "UObject/ObjectMacros.h"
+#include "Algo/BinarySearch.h"
 #include "FaceFXData.generated.h"
 
 /** The different playback states */
@@ -110,24 +111,293 @@ struct FFaceFXAnimId
 	}
 };
 
+/** An event of the timeline of an animation. Fired by the FaceFX runtime while the animation got sampled during import */
+USTRUCT()
+struct FFaceFXTimelineEvent
+{
+	GENERATED_USTRUCT_BODY()
+
+	FFaceFXTimelineEvent() : Time(0.f), ChannelIndex(0), ChannelTime(0.f), EventTime(0.f) {}
+
+	/** The animation time in seconds at which the event got fired */
+	UPROPERTY()
+	float Time;
+
+	/** The firing context of the FaceFX runtime */
+	UPROPERTY()
+	int32 ChannelIndex;
+
+	UPROPERTY()
+	float ChannelTime;
+
+	UPROPERTY()
+	float EventTime;
+
+	/** The event payload */
+	UPROPERTY()
+	FString Payload;
+};
+
+/** The value range of a baked output channel */
+USTRUCT()
+struct FFaceFXBakedChannel
+{
+	GENERATED_USTRUCT_BODY()
+
+	FFaceFXBakedChannel() : Min(0.f), Range(0.f) {}
+	FFaceFXBakedChannel(float InMin, float InRange) : Min(InMin), Range(InRange) {}
+
+	/** The smallest value of the channel */
+	UPROPERTY()
+	float Min;
+
+	/** The difference between the largest and the smallest value. 0 for constant channels */
+	UPROPERTY()
+	float Range;
+};
+
+/**
+* The track values and bone transforms of an animation sampled against an actor at a fixed rate.
+* The channels hold all track values followed by the floats of all FaceFX bone transforms. The non constant channels are quantized to 16 bit.
+* The audio start and the events are taken from the timeline of the animation data
+*/
+USTRUCT()
+struct FFaceFXBakedAnimData
+{
+	GENERATED_USTRUCT_BODY()
+
+	FFaceFXBakedAnimData() : AnimDataHash(0), ActorDataHash(0), BoneSetFlags(0), SampleRate(0.f), NumFrames(0), LastFrameTime(0.f), NumTracks(0), NumBoneValues(0)
+#if WITH_EDITORONLY_DATA
+		, MaxTrackError(0.f), MaxTranslationError(0.f), MaxRotationError(0.f), MaxScaleError(0.f)
+#endif
+	{}
+
+	/** The hash of the animation data that got baked */
+	UPROPERTY()
+	uint32 AnimDataHash;
+
+	/** The hash of the actor data the animation got baked with */
+	UPROPERTY()
+	uint32 ActorDataHash;
+
+	/** The creation flags of the bone set the bone transforms got computed with */
+	UPROPERTY()
+	uint32 BoneSetFlags;
+
+	/** The number of frames per second */
+	UPROPERTY(VisibleInstanceOnly, Category=FaceFX)
+	float SampleRate;
+
+	/** The number of baked frames */
+	UPROPERTY(VisibleInstanceOnly, Category=FaceFX)
+	int32 NumFrames;
+
+	/** The animation time in seconds of the last frame. All other frames lie on multiples of 1 / SampleRate while the last one lies at the end of the animation */
+	UPROPERTY()
+	float LastFrameTime;
+
+	/** The number of track value channels */
+	UPROPERTY()
+	int32 NumTracks;
+
+	/** The number of bone transform channels */
+	UPROPERTY()
+	int32 NumBoneValues;
+
+	/** The value ranges of all channels */
+	UPROPERTY()
+	TArray<FFaceFXBakedChannel> Channels;
+
+	/** The indices of the non constant channels in ascending order */
+	UPROPERTY()
+	TArray<int32> AnimatedChannels;
+
+	/** The quantized values of the non constant channels. Frame major */
+	UPROPERTY()
+	TArray<uint16> Samples;
+
+#if WITH_EDITORONLY_DATA
+	/** The largest differences between the baked and the live output. Measured in between the frames during baking */
+	UPROPERTY(VisibleInstanceOnly, Category=FaceFX)
+	float MaxTrackError;
+
+	UPROPERTY(VisibleInstanceOnly, Category=FaceFX)
+	float MaxTranslationError;
+
+	UPROPERTY(VisibleInstanceOnly, Category=FaceFX)
+	float MaxRotationError;
+
+	UPROPERTY(VisibleInstanceOnly, Category=FaceFX)
+	float MaxScaleError;
+#endif //WITH_EDITORONLY_DATA
+
+	inline bool IsValid() const
+	{
+		return NumFrames > 0 && SampleRate > 0.f && Channels.Num() == NumTracks + NumBoneValues && Samples.Num() == NumFrames * AnimatedChannels.Num();
+	}
+
+	/**
+	* Gets the size of the baked data
+	* @returns The size in bytes
+	*/
+	inline int32 GetDataSize() const
+	{
+		return Channels.Num() * Channels.GetTypeSize() + AnimatedChannels.Num() * AnimatedChannels.GetTypeSize() + Samples.Num() * Samples.GetTypeSize();
+	}
+
+	inline void Reset()
+	{
+		*this = FFaceFXBakedAnimData();
+	}
+};
+
+/**
+* The audio start and the events of an animation in the order of their time. Extracted once during import.
+* Allows jumps to look up the audio state and the skipped events instead of processing the frames in between
+*/
+USTRUCT()
+struct FFaceFXAnimTimeline
+{
+	GENERATED_USTRUCT_BODY()
+
+	FFaceFXAnimTimeline() : AnimDataHash(0), AudioStartTime(-1.f) {}
+
+	/** The hash of the animation data the timeline got extracted from */
+	UPROPERTY()
+	uint32 AnimDataHash;
+
+	/** The animation time in seconds at which the audio starts. <0 if the animation does not start any audio */
+	UPROPERTY(VisibleInstanceOnly, Category=FaceFX)
+	float AudioStartTime;
+
+	/** The events fired by the animation in the order of their time */
+	UPROPERTY()
+	TArray<FFaceFXTimelineEvent> Events;
+
+	/**
+	* Gets if the audio playback is due at a given animation time
+	* @param Time The animation time in seconds
+	* @returns True if the audio started at or before the time, else false
+	*/
+	inline bool IsAudioStarted(float Time) const
+	{
+		return AudioStartTime >= 0.f && Time >= AudioStartTime;
+	}
+
+	/**
+	* Gets the index of the first event fired after a given animation time
+	* @param InEvents The events in the order of their time
+	* @param Time The animation time in seconds
+	* @returns The index of the event or the number of events if none gets fired after the time
+	*/
+	static inline int32 FindNextEvent(const TArray<FFaceFXTimelineEvent>& InEvents, float Time)
+	{
+		return Algo::UpperBoundBy(InEvents, Time, [](const FFaceFXTimelineEvent& Event) { return Event.Time; });
+	}
+
+	inline void Reset()
+	{
+		*this = FFaceFXAnimTimeline();
+	}
+};
+
 /** The struct that holds the data for a single FaceFX animation */
 USTRUCT()
 struct FFaceFXAnimData
 {
 	GENERATED_USTRUCT_BODY()
 
+	FFaceFXAnimData() : StartTime(0.f), EndTime(0.f), bIsBoundsSet(false), DataHash(0), ValidatedDataHash(0) {}
+
 	/** The asset file binary data for the .ffxanim file */
 	UPROPERTY()
 	TArray<uint8> RawData;
 
+	/** The start time of the animation in seconds. Computed once from the raw data during import */
+	UPROPERTY(VisibleInstanceOnly, Category=FaceFX)
+	float StartTime;
+
+	/** The end time of the animation in seconds. Computed once from the raw data during import */
+	UPROPERTY(VisibleInstanceOnly, Category=FaceFX)
+	float EndTime;
+
+	/** Indicator if the start and end time were computed from the current raw data */
+	UPROPERTY()
+	bool bIsBoundsSet;
+
+	/** The hash of the raw data. Used to look up precomputed actor compatibility results */
+	UPROPERTY()
+	uint32 DataHash;
+
+	/** The hash of the raw data that passed the data validation of the FaceFX runtime during cook. 0 if not validated */
+	UPROPERTY()
+	uint32 ValidatedDataHash;
+
+	/** The animation baked against the actor it got imported with. Empty if not baked */
+	UPROPERTY(VisibleInstanceOnly, Category=FaceFX)
+	FFaceFXBakedAnimData BakedData;
+
+	/** The audio start and the events of the animation. Empty if not extracted yet */
+	UPROPERTY(VisibleInstanceOnly, Category=FaceFX)
+	FFaceFXAnimTimeline Timeline;
+
 	inline bool IsValid() const
 	{
 		return RawData.Num() > 0;
 	}
 
+	/**
+	* Gets if the baked data matches the current raw data
+	* @returns True if baked, else false
+	*/
+	inline bool IsBaked() const
+	{
+		return DataHash != 0 && BakedData.AnimDataHash == DataHash && BakedData.IsValid();
+	}
+
+	/**
+	* Gets if the timeline matches the current raw data
+	* @returns True if the timeline can be used, else false
+	*/
+	inline bool HasTimeline() const
+	{
+		return DataHash != 0 && Timeline.AnimDataHash == DataHash;
+	}
+
+	/** Updates the hash of the current raw data */
+	inline void UpdateDataHash()
+	{
+		DataHash = RawData.Num() > 0 ? FCrc::MemCrc32(RawData.GetData(), RawData.Num()) : 0;
+	}
+
+	/**
+	* Gets if the current raw data passed the data validation during cook. The data hash gets recomputed from the raw data on load for this check
+	* @returns True if validated, else false
+	*/
+	inline bool IsDataValidated() const
+	{
+		return ValidatedDataHash != 0 && ValidatedDataHash == DataHash;
+	}
+
+	/**
+	* Gets the duration of the animation
+	* @returns The duration in seconds
+	*/
+	inline float GetDuration() const
+	{
+		return EndTime - StartTime;
+	}
+
 	inline void Reset()
 	{
 		RawData.Empty();
+		StartTime = 0.f;
+		EndTime = 0.f;
+		bIsBoundsSet = false;
+		DataHash = 0;
+		ValidatedDataHash = 0;
+		BakedData.Reset();
+		Timeline.Reset();
 	}
 };
 
@@ -174,12 +444,31 @@ struct FFaceFXAnimSetData
 	TArray<FFaceFXAnimData> Animations;
 };
 
+/** The tracks of an actor that are changed by a single FaceFX animation */
+USTRUCT()
+struct FFaceFXAnimActiveTracks
+{
+	GENERATED_USTRUCT_BODY()
+
+	FFaceFXAnimActiveTracks() : ActorDataHash(0) {}
+
+	/** The sorted indices of the changed tracks within the track list of the actor */
+	UPROPERTY()
+	TArray<int32> TrackIndices;
+
+	/** The hash of the actor data the tracks were sampled with */
+	UPROPERTY()
+	uint32 ActorDataHash;
+};
+
 /** A single FaceFX actor data entry used to differentiate per platform */
 USTRUCT()
 struct FFaceFXActorData
 {
 	GENERATED_USTRUCT_BODY()
 
+	FFaceFXActorData() : DataHash(0), ValidatedDataHash(0), NumIndexedIds(INDEX_NONE) {}
+
 	/** The asset file binary data for the .ffxactor file */
 	UPROPERTY()
 	TArray<uint8> ActorRawData;
@@ -192,6 +481,31 @@ struct FFaceFXActorData
 	UPROPERTY(EditInstanceOnly, Category=FaceFX)
 	TArray<FFaceFXIdData> Ids;
 
+	/** The compatibility of the linked animations with this actor keyed by the animation data hash. Computed during cook */
+	UPROPERTY()
+	TMap<uint32, bool> AnimationCompatibility;
+
+	/** The tracks changed by the linked animations keyed by the animation data hash. Computed during import and cook */
+	UPROPERTY()
+	TMap<uint32, FFaceFXAnimActiveTracks> AnimationActiveTracks;
+
+	/** The hash of the actor and bones raw data */
+	UPROPERTY()
+	uint32 DataHash;
+
+	/** The hash of the actor and bones raw data that passed the data validation of the FaceFX runtime during cook. 0 if not validated */
+	UPROPERTY()
+	uint32 ValidatedDataHash;
+
+	/** The indices within Ids keyed by the numeric id. Built on load and import */
+	TMap<uint64, int32> IdIndices;
+
+	/** The indices within Ids keyed by the name. Built on load and import */
+	TMap<FName, int32> NameIndices;
+
+	/** The number of ids the lookup tables were built for. INDEX_NONE if not built */
+	int32 NumIndexedIds;
+
 	inline bool IsValid() const
 	{
 		// Note: for a morph-only character there may not be any bones data, but there
@@ -199,11 +513,135 @@ struct FFaceFXActorData
 		return ActorRawData.Num() > 0 && Ids.Num() > 0;
 	}
 
+	/** Updates the hash of the current actor and bones raw data */
+	inline void UpdateDataHash()
+	{
+		DataHash = ActorRawData.Num() > 0 ? FCrc::MemCrc32(BonesRawData.GetData(), BonesRawData.Num(), FCrc::MemCrc32(ActorRawData.GetData(), ActorRawData.Num())) : 0;
+	}
+
+	/**
+	* Gets if the current raw data passed the data validation during cook. The data hash gets recomputed from the raw data on load for this check
+	* @returns True if validated, else false
+	*/
+	inline bool IsDataValidated() const
+	{
+		return ValidatedDataHash != 0 && ValidatedDataHash == DataHash;
+	}
+
+	/** Rebuilds the id lookup tables. Must be called whenever Ids changes */
+	inline void UpdateIdLookup()
+	{
+		IdIndices.Empty(Ids.Num());
+		NameIndices.Empty(Ids.Num());
+
+		//keep the first entry of duplicates to match a linear search
+		for (int32 Idx = 0; Idx < Ids.Num(); ++Idx)
+		{
+			if (!IdIndices.Contains(Ids[Idx].Id))
+			{
+				IdIndices.Add(Ids[Idx].Id, Idx);
+			}
+			if (!NameIndices.Contains(Ids[Idx].Name))
+			{
+				NameIndices.Add(Ids[Idx].Name, Idx);
+			}
+		}
+
+		NumIndexedIds = Ids.Num();
+	}
+
+	/**
+	* Gets if the id lookup tables match the current ids
+	* @returns True if built, else false
+	*/
+	inline bool IsIdLookupBuilt() const
+	{
+		return NumIndexedIds == Ids.Num();
+	}
+
+	/**
+	* Gets the id data for a numeric id
+	* @param Id The numeric id to look up
+	* @returns The id data or nullptr if not found
+	*/
+	inline const FFaceFXIdData* FindId(uint64 Id) const
+	{
+		if (!IsIdLookupBuilt())
+		{
+			//lookup not built yet
+			return Ids.FindByKey(Id);
+		}
+
+		const int32* Idx = IdIndices.Find(Id);
+		return Idx ? &Ids[*Idx] : nullptr;
+	}
+
+	/**
+	* Gets the id data for a name
+	* @param Name The name to look up
+	* @returns The id data or nullptr if not found
+	*/
+	inline const FFaceFXIdData* FindId(const FName& Name) const
+	{
+		if (!IsIdLookupBuilt())
+		{
+			//lookup not built yet
+			return Ids.FindByKey(Name);
+		}
+
+		const int32* Idx = NameIndices.Find(Name);
+		return Idx ? &Ids[*Idx] : nullptr;
+	}
+
+	/**
+	* Resolves the names of a set of numeric ids
+	* @param InIds The numeric ids to resolve
+	* @param OutNames The names in the order of InIds. NAME_None for unknown ids
+	*/
+	inline void ResolveNames(const TArray<uint64_t>& InIds, TArray<FName>& OutNames) const
+	{
+		OutNames.Reset(InIds.Num());
+
+		for (const uint64_t Id : InIds)
+		{
+			const FFaceFXIdData* IdData = FindId((uint64)Id);
+			OutNames.Add(IdData ? IdData->Name : NAME_None);
+		}
+	}
+
+	/**
+	* Gets the precomputed compatibility of a set of animation data with this actor
+	* @param AnimData The animation data to look up
+	* @returns The compatibility if it was computed for that exact data, else nullptr
+	*/
+	inline const bool* FindAnimationCompatibility(const FFaceFXAnimData& AnimData) const
+	{
+		return AnimData.DataHash != 0 ? AnimationCompatibility.Find(AnimData.DataHash) : nullptr;
+	}
+
+	/**
+	* Gets the precomputed tracks a set of animation data changes on this actor
+	* @param AnimData The animation data to look up
+	* @returns The sorted track indices if they were sampled for that exact animation and actor data, else nullptr
+	*/
+	inline const TArray<int32>* FindAnimationActiveTracks(const FFaceFXAnimData& AnimData) const
+	{
+		const FFaceFXAnimActiveTracks* ActiveTracks = AnimData.DataHash != 0 && DataHash != 0 ? AnimationActiveTracks.Find(AnimData.DataHash) : nullptr;
+		return ActiveTracks && ActiveTracks->ActorDataHash == DataHash ? &ActiveTracks->TrackIndices : nullptr;
+	}
+
 	inline void Reset()
 	{
 		ActorRawData.Empty();
 		BonesRawData.Empty();
 		Ids.Empty();
+		IdIndices.Empty();
+		NameIndices.Empty();
+		NumIndexedIds = INDEX_NONE;
+		AnimationCompatibility.Empty();
+		AnimationActiveTracks.Empty();
+		DataHash = 0;
+		ValidatedDataHash = 0;
 	}
 };
 
@@ -21,23 +21,74 @@
 #include "Animation/AnimNode_BlendFaceFXAnimation.h"
 #include "FaceFX.h"
 #include "Animation/FaceFXComponent.h"
+#include "Animation/AnimInstance.h"
 #include "Animation/AnimInstanceProxy.h"
 #include "AnimationRuntime.h"
+#include "Animation/Skeleton.h"
+#include "Misc/ScopeLock.h"
+#include "UObject/ObjectKey.h"
 
 DECLARE_CYCLE_STAT(TEXT("Blend FaceFX Animation"), STAT_FaceFXBlend, STATGROUP_FACEFX);
 DECLARE_CYCLE_STAT(TEXT("Blend FaceFX Animation - Load"), STAT_FaceFXBlendLoad, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Blend FaceFX Animation - Bones"), STAT_FaceFXBlendBones, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Blend FaceFX Animation - Curves"), STAT_FaceFXBlendCurves, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Blend FaceFX Animation - Unchanged Copies"), STAT_FaceFXBlendUnchangedCopies, STATGROUP_FACEFX);
 
 FAnimNode_BlendFaceFXAnimation::FAnimNode_BlendFaceFXAnimation() :
 	Alpha(1.F),
 	bSkipBoneMappingWithoutNS(false),
 	LODThreshold(INDEX_NONE),
-	bFaceFXCharacterLoadingCompleted(false)
+	bBlendInLocalSpace(false),
+	NumRequiredTransforms(0),
+	BoneMappingGeneration(0),
+	LODMasksVersion(0),
+	LODMaskIdx(INDEX_NONE),
+	NumRequiredTrackValues(0),
+	BoneTransformsVersion(0),
+	TrackValuesVersion(0),
+	bIsBoneTransformsCopied(false),
+	bIsTrackValuesCopied(false),
+	bFaceFXCharacterLoadingCompleted(false),
+	bIsCompactPoseEntriesDirty(true)
 {
 #if !UE_BUILD_SHIPPING
 	bIsDebugLocalSpaceBlendShown = false;
 #endif
 }
 
+void FAnimNode_BlendFaceFXAnimation::PreUpdate(const UAnimInstance* InAnimInstance)
+{
+	//the LOD masks of the FaceFX character are only accessible on the game thread. Take a snapshot of the exclusions for the evaluation on worker threads
+	const USkeletalMeshComponent* Component = InAnimInstance ? InAnimInstance->GetSkelMeshComponent() : nullptr;
+	const AActor* Owner = Component ? Component->GetOwner() : nullptr;
+	const UFaceFXComponent* FaceFXComp = Owner ? Owner->FindComponentByClass<UFaceFXComponent>() : nullptr;
+	const UFaceFXCharacter* FaceFXChar = FaceFXComp ? FaceFXComp->GetCharacter(Component) : nullptr;
+
+	//pick the LOD mask of the predicted skeletal mesh LOD
+	const int32 NewLODMaskIdx = FaceFXChar ? FaceFXChar->GetLODMaskIndex(Component->GetPredictedLODLevel()) : INDEX_NONE;
+	const uint32 NewLODMasksVersion = FaceFXChar ? FaceFXChar->GetLODMasksVersion() : 0;
+
+	if (LODMaskFaceFXChar != FaceFXChar || LODMasksVersion != NewLODMasksVersion || LODMaskIdx != NewLODMaskIdx)
+	{
+		LODMaskFaceFXChar = FaceFXChar;
+		LODMasksVersion = NewLODMasksVersion;
+		LODMaskIdx = NewLODMaskIdx;
+
+		if (FaceFXChar)
+		{
+			FaceFXChar->GetLODMaskExclusions(LODMaskIdx, ExcludedBones, ExcludedTracks);
+		}
+		else
+		{
+			ExcludedBones.Empty();
+			ExcludedTracks.Empty();
+		}
+
+		//the skipped bones changed
+		bIsCompactPoseEntriesDirty = true;
+	}
+}
+
 void FAnimNode_BlendFaceFXAnimation::Initialize_AnyThread(const FAnimationInitializeContext& Context)
 {
 	ComponentPose.Initialize(Context);
@@ -56,13 +107,195 @@ void FAnimNode_BlendFaceFXAnimation::Initialize_AnyThread(const FAnimationInitia
 void FAnimNode_BlendFaceFXAnimation::CacheBones_AnyThread(const FAnimationCacheBonesContext & Context)
 {
 	ComponentPose.CacheBones(Context);
+
+	//the required bones changed (i.e. LOD switch) -> translate the bone mapping once instead of per evaluation
+	CacheCompactPoseEntries(Context.AnimInstanceProxy->GetRequiredBones());
+}
+
+void FAnimNode_BlendFaceFXAnimation::CacheCompactPoseEntries(const FBoneContainer& RequiredBones)
+{
+	CompactPoseEntries.Reset();
+	NumRequiredTransforms = 0;
+	bIsCompactPoseEntriesDirty = false;
+
+	if (!BoneIndices.IsValid() || !RequiredBones.IsValid())
+	{
+		return;
+	}
+
+	CompactPoseEntries.Reserve(BoneIndices->Num());
+
+	for (const FBlendFacialAnimationEntry& Entry : *BoneIndices)
+	{
+		const FCompactPoseBoneIndex CompactPoseBoneIndex = RequiredBones.MakeCompactPoseIndex(FMeshPoseBoneIndex(Entry.BoneIdx));
+
+		//skip bones that don't exist at the current LOD level or are excluded by the LOD mask
+		if (CompactPoseBoneIndex.GetInt() != INDEX_NONE && !(ExcludedBones.IsValidIndex(Entry.TransformIdx) && ExcludedBones[Entry.TransformIdx]))
+		{
+			CompactPoseEntries.Add(FCompactPoseEntry(CompactPoseBoneIndex, Entry.TransformIdx));
+			NumRequiredTransforms = FMath::Max(NumRequiredTransforms, Entry.TransformIdx + 1);
+		}
+	}
 }
 
+/** Process wide cache of the bone mappings keyed by actor asset, skeletal mesh and the namespace skipping flag. Thread safe */
+class FFaceFXBoneMappingCache
+{
+public:
+
+	typedef FAnimNode_BlendFaceFXAnimation::FBoneMappingPtr FBoneMappingPtr;
+
+	/**
+	* Gets the global bone mapping cache
+	* @returns The cache
+	*/
+	static FFaceFXBoneMappingCache& Get()
+	{
+		static FFaceFXBoneMappingCache Instance;
+		return Instance;
+	}
+
+	/**
+	* Gets the bone mapping of a FaceFX character onto a skeletal mesh. Builds the mapping on first use
+	* @param FaceFXChar The character to map the bones of
+	* @param Component The skeletal mesh component to map the bones onto
+	* @param IsSkipBoneMappingWithoutNS Indicator if stripped name space bone mapping shall be skipped
+	* @returns The bone mapping
+	*/
+	FBoneMappingPtr FindOrBuild(const UFaceFXCharacter* FaceFXChar, const USkeletalMeshComponent* Component, bool IsSkipBoneMappingWithoutNS)
+	{
+		check(FaceFXChar && Component);
+
+		const FKey Key(FObjectKey(FaceFXChar->GetFaceFXActor()), FObjectKey(Component->SkeletalMesh), IsSkipBoneMappingWithoutNS);
+
+		{
+			FScopeLock Lock(&CriticalSection);
+
+			if (const FBoneMappingPtr* Mapping = Mappings.Find(Key))
+			{
+				return *Mapping;
+			}
+		}
+
+		//build outside the lock. Concurrent builds of the same key produce identical mappings
+		FBoneMappingPtr Mapping = FAnimNode_BlendFaceFXAnimation::BuildBoneMapping(FaceFXChar, Component, IsSkipBoneMappingWithoutNS);
+
+		FScopeLock Lock(&CriticalSection);
+
+		//drop the mappings of unloaded assets
+		for (auto It = Mappings.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().Get<0>().ResolveObjectPtr() || !It.Key().Get<1>().ResolveObjectPtr())
+			{
+				It.RemoveCurrent();
+			}
+		}
+
+		Mappings.Add(Key, Mapping);
+		return Mapping;
+	}
+
+	/**
+	* Drops all mappings of an asset. Nodes keep their current mapping until reloaded
+	* @param Asset The actor asset or skeletal mesh to drop the mappings for
+	*/
+	void Purge(const UObject* Asset)
+	{
+		const FObjectKey AssetKey(Asset);
+
+		FScopeLock Lock(&CriticalSection);
+
+		bool IsPurged = false;
+
+		for (auto It = Mappings.CreateIterator(); It; ++It)
+		{
+			if (It.Key().Get<0>() == AssetKey || It.Key().Get<1>() == AssetKey)
+			{
+				It.RemoveCurrent();
+				IsPurged = true;
+			}
+		}
+
+		if (IsPurged)
+		{
+			//let the nodes using a purged mapping fetch a new one
+			Generation.IncrementExchange();
+		}
+	}
+
+	/**
+	* Gets the generation of the cache. Changes whenever mappings got purged. Can be called from any thread
+	* @returns The generation
+	*/
+	inline uint32 GetGeneration() const
+	{
+		return Generation;
+	}
+
+	~FFaceFXBoneMappingCache()
+	{
+#if WITH_EDITOR
+		UFaceFXCharacter::OnAssetChanged.Remove(OnAssetChangedHandle);
+		FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(OnObjectPropertyChangedHandle);
+#endif //WITH_EDITOR
+	}
+
+private:
+
+	typedef TTuple<FObjectKey, FObjectKey, bool> FKey;
+
+	FFaceFXBoneMappingCache() : Generation(0)
+	{
+#if WITH_EDITOR
+		//reimported actor assets and modified skeletal meshes invalidate their mappings
+		OnAssetChangedHandle = UFaceFXCharacter::OnAssetChanged.AddRaw(this, &FFaceFXBoneMappingCache::OnAssetChanged);
+		OnObjectPropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddRaw(this, &FFaceFXBoneMappingCache::OnObjectPropertyChanged);
+#endif //WITH_EDITOR
+	}
+
+#if WITH_EDITOR
+	void OnAssetChanged(UFaceFXAsset* Asset)
+	{
+		if (Cast<UFaceFXActor>(Asset))
+		{
+			Purge(Asset);
+		}
+	}
+
+	void OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& Event)
+	{
+		if (Cast<USkeletalMesh>(Object))
+		{
+			Purge(Object);
+		}
+	}
+#endif //WITH_EDITOR
+
+#if WITH_EDITOR
+	/** The handles of the asset change delegates */
+	FDelegateHandle OnAssetChangedHandle;
+	FDelegateHandle OnObjectPropertyChangedHandle;
+#endif //WITH_EDITOR
+
+	/** The cached mappings */
+	TMap<FKey, FBoneMappingPtr> Mappings;
+
+	/** Increases with each purge */
+	TAtomic<uint32> Generation;
+
+	/** Guards the mappings */
+	FCriticalSection CriticalSection;
+};
+
 void FAnimNode_BlendFaceFXAnimation::LoadFaceFXData(FAnimInstanceProxy* AnimInstanceProxy)
 {
 	SCOPE_CYCLE_COUNTER(STAT_FaceFXBlendLoad);
 
-	BoneIndices.Empty();
+	BoneIndices.Reset();
+	BoneMappingGeneration = FFaceFXBoneMappingCache::Get().GetGeneration();
+	bIsCompactPoseEntriesDirty = true;
+	CurveEntries.Reset();
+	NumRequiredTrackValues = 0;
 
 	if (!AnimInstanceProxy)
 	{
@@ -91,58 +324,29 @@ void FAnimNode_BlendFaceFXAnimation::LoadFaceFXData(FAnimInstanceProxy* AnimInst
 			{
 				BlendMode = FaceFXChar->GetBlendMode();
 
-				const TArray<FName>& BoneNames = FaceFXChar->GetBoneNames();
-				const TArray<FTransform>& BoneRefPoses = Component->SkeletalMesh->GetRefSkeleton().GetRefBonePose();
+				//the mapping only depends on the actor asset and the skeletal mesh -> share it with all other nodes using the same rig
+				BoneIndices = FFaceFXBoneMappingCache::Get().FindOrBuild(FaceFXChar, Component, bSkipBoneMappingWithoutNS);
 
-				for (const FName& BoneName : BoneNames)
-				{
-					//find index where the transforms of this
-					const int32 BoneTransformIdx = FaceFXChar->GetBoneNameTransformIndex(BoneName);
-					if (BoneTransformIdx != INDEX_NONE)
-					{
-						//find skeleton bone index
-						int32 BoneIdx = Component->GetBoneIndex(BoneName);
+				//resolve the skeleton curves the character expects us to drive
+				const TArray<FName>& CurveNames = FaceFXChar->GetAnimationCurveNames();
+				const TArray<size_t>& CurveIndices = FaceFXChar->GetAnimationCurveIndices();
 
-						if (BoneIdx == INDEX_NONE && !bSkipBoneMappingWithoutNS)
-						{
-							//strip any existing namespace from the bone name and try matching against it
-							FString BoneNameWithOutNS = BoneName.ToString();
-							int32 LastNSLocation;
-							if (BoneNameWithOutNS.FindLastChar(':', LastNSLocation) && BoneNameWithOutNS.Len() > LastNSLocation)
-							{
-								BoneNameWithOutNS = BoneNameWithOutNS.RightChop(LastNSLocation + 1);
-								BoneIdx = Component->GetBoneIndex(*BoneNameWithOutNS);
-							}
-						}
+				if (const USkeleton* Skeleton = CurveNames.Num() > 0 ? AnimInstanceProxy->GetSkeleton() : nullptr)
+				{
+					CurveEntries.Reserve(CurveNames.Num());
 
-						if (BoneIdx != INDEX_NONE)
-						{
-							const FTransform& BoneRefPose = BoneRefPoses[BoneIdx];
+					for (int32 Idx = 0; Idx < CurveNames.Num(); ++Idx)
+					{
+						const SmartName::UID_Type CurveUID = Skeleton->GetUIDByName(USkeleton::AnimCurveMappingName, CurveNames[Idx]);
 
-							BoneIndices.Add(FBlendFacialAnimationEntry(BoneIdx, BoneTransformIdx, BoneRefPose));
-						}
-						else
+						if (CurveUID != SmartName::MaxUID)
 						{
-							UE_LOG(LogFaceFX, Warning, TEXT("BlendFacialAnimation: Unable to find FaceFX bone within skeletal mesh. Bone: %s. SkelMesh: %s. Actor: %s"),
-								*BoneName.GetPlainNameString(), *GetNameSafe(Component->SkeletalMesh), *GetNameSafe(Component->GetOwner()));
+							const int32 TrackIdx = (int32)CurveIndices[Idx];
+							CurveEntries.Add(FCurveEntry(CurveUID, TrackIdx));
+							NumRequiredTrackValues = FMath::Max(NumRequiredTrackValues, TrackIdx + 1);
 						}
 					}
-					else
-					{
-						UE_LOG(LogFaceFX, Warning, TEXT("BlendFacialAnimation: Unable to find FaceFX bone transformation index. Bone: %i. Actor: %s"),
-							*BoneName.GetPlainNameString(), *GetNameSafe(Component->GetOwner()));
-					}
 				}
-
-				//sort in parents before children order
-				struct BlendFacialAnimationSort
-				{
-					FORCEINLINE bool operator()(const FBlendFacialAnimationEntry& A, const FBlendFacialAnimationEntry& B) const
-					{
-						return A.BoneIdx < B.BoneIdx;
-					}
-				};
-				BoneIndices.Sort(BlendFacialAnimationSort());
 			}
 			else
 			{
@@ -157,6 +361,77 @@ void FAnimNode_BlendFaceFXAnimation::LoadFaceFXData(FAnimInstanceProxy* AnimInst
 	}
 }
 
+FAnimNode_BlendFaceFXAnimation::FBoneMappingPtr FAnimNode_BlendFaceFXAnimation::BuildBoneMapping(const UFaceFXCharacter* FaceFXChar, const USkeletalMeshComponent* Component, bool IsSkipBoneMappingWithoutNS)
+{
+	TSharedPtr<TArray<FBlendFacialAnimationEntry>, ESPMode::ThreadSafe> Result = MakeShareable(new TArray<FBlendFacialAnimationEntry>());
+
+	if (!Component->SkeletalMesh)
+	{
+		return Result;
+	}
+
+	const TArray<FName>& BoneNames = FaceFXChar->GetBoneNames();
+	const TArray<FTransform>& BoneRefPoses = Component->SkeletalMesh->GetRefSkeleton().GetRefBonePose();
+
+	//find the indices where the transforms of the bones are located
+	TArray<int32> BoneTransformIndices;
+	FaceFXChar->GetBoneNameTransformIndices(BoneNames, BoneTransformIndices);
+
+	Result->Reserve(BoneNames.Num());
+
+	for (int32 Idx = 0; Idx < BoneNames.Num(); ++Idx)
+	{
+		const FName& BoneName = BoneNames[Idx];
+		const int32 BoneTransformIdx = BoneTransformIndices[Idx];
+		if (BoneTransformIdx != INDEX_NONE)
+		{
+			//find skeleton bone index
+			int32 BoneIdx = Component->GetBoneIndex(BoneName);
+
+			if (BoneIdx == INDEX_NONE && !IsSkipBoneMappingWithoutNS)
+			{
+				//strip any existing namespace from the bone name and try matching against it
+				FString BoneNameWithOutNS = BoneName.ToString();
+				int32 LastNSLocation;
+				if (BoneNameWithOutNS.FindLastChar(':', LastNSLocation) && BoneNameWithOutNS.Len() > LastNSLocation)
+				{
+					BoneNameWithOutNS = BoneNameWithOutNS.RightChop(LastNSLocation + 1);
+					BoneIdx = Component->GetBoneIndex(*BoneNameWithOutNS);
+				}
+			}
+
+			if (BoneIdx != INDEX_NONE)
+			{
+				const FTransform& BoneRefPose = BoneRefPoses[BoneIdx];
+
+				Result->Add(FBlendFacialAnimationEntry(BoneIdx, BoneTransformIdx, BoneRefPose));
+			}
+			else
+			{
+				UE_LOG(LogFaceFX, Warning, TEXT("BlendFacialAnimation: Unable to find FaceFX bone within skeletal mesh. Bone: %s. SkelMesh: %s. Actor: %s"),
+					*BoneName.GetPlainNameString(), *GetNameSafe(Component->SkeletalMesh), *GetNameSafe(Component->GetOwner()));
+			}
+		}
+		else
+		{
+			UE_LOG(LogFaceFX, Warning, TEXT("BlendFacialAnimation: Unable to find FaceFX bone transformation index. Bone: %i. Actor: %s"),
+				*BoneName.GetPlainNameString(), *GetNameSafe(Component->GetOwner()));
+		}
+	}
+
+	//sort in parents before children order
+	struct BlendFacialAnimationSort
+	{
+		FORCEINLINE bool operator()(const FBlendFacialAnimationEntry& A, const FBlendFacialAnimationEntry& B) const
+		{
+			return A.BoneIdx < B.BoneIdx;
+		}
+	};
+	Result->Sort(BlendFacialAnimationSort());
+
+	return Result;
+}
+
 void FAnimNode_BlendFaceFXAnimation::Update_AnyThread(const FAnimationUpdateContext& Context)
 {
 	ComponentPose.Update(Context);
@@ -215,8 +490,19 @@ void FAnimNode_BlendFaceFXAnimation::EvaluateComponentSpace_AnyThread(FComponent
 		//character not done loading yet -> try to retrieve again
 		LoadFaceFXData(Output.AnimInstanceProxy);
 	}
+	else if (BoneMappingGeneration != FFaceFXBoneMappingCache::Get().GetGeneration())
+	{
+		//cached mappings got purged (i.e. reimported actor asset or modified skeletal mesh) -> fetch the current one
+		LoadFaceFXData(Output.AnimInstanceProxy);
+	}
+
+	if (bIsCompactPoseEntriesDirty)
+	{
+		//the bone mapping got loaded after the bones were cached
+		CacheCompactPoseEntries(Output.Pose.GetPose().GetBoneContainer());
+	}
 
-	if (BoneIndices.Num() <= 0)
+	if ((!BoneIndices.IsValid() || BoneIndices->Num() <= 0) && CurveEntries.Num() <= 0)
 	{
 		//nothing to blend in
 		return;
@@ -237,54 +523,207 @@ void FAnimNode_BlendFaceFXAnimation::EvaluateComponentSpace_AnyThread(FComponent
 		{
 			if (UFaceFXCharacter* FaceFXChar = FaceFXComp->GetCharacter(Component))
 			{
-				const TArray<FTransform>& FaceFXBoneTransforms = FaceFXChar->GetBoneTransforms();
-
-				for (const FBlendFacialAnimationEntry& Entry : BoneIndices)
+				if (CopiedFaceFXChar != FaceFXChar)
 				{
-					const FTransform& FaceFXBoneTM = FaceFXBoneTransforms[Entry.TransformIdx];
-					const int32 BoneIdx = Entry.BoneIdx;
-					FCompactPoseBoneIndex CompactPoseBoneIndex = Output.Pose.GetPose().GetBoneContainer().MakeCompactPoseIndex(FMeshPoseBoneIndex(BoneIdx));
-
-					// Skip this bone if it doesn't exist at the current LOD level.
-					if (CompactPoseBoneIndex.GetInt() == INDEX_NONE)
-					{
-						continue;
-					}
-
-					//fill target transform
-					TargetBlendTransform[0].BoneIndex = CompactPoseBoneIndex;
+					//the output versions are per character
+					CopiedFaceFXChar = FaceFXChar;
+					bIsBoneTransformsCopied = false;
+					bIsTrackValuesCopied = false;
+					FaceFXBoneTransforms.Reset();
+					FaceFXTrackValues.Reset();
+				}
 
-					//convenience alias
-					FTransform& BoneTM = TargetBlendTransform[0].Transform;
+				//the output only changes when the FaceFX character published a changed output
+				const uint32 OutputVersion = FaceFXChar->GetOutputVersion();
 
-					//apply transformations in bone space
-					if (BlendMode == EFaceFXBlendMode::Replace)
+				if (CurveEntries.Num() > 0)
+				{
+					if (bIsTrackValuesCopied && TrackValuesVersion == OutputVersion)
 					{
-						BoneTM = FaceFXBoneTM;
+						INC_DWORD_STAT(STAT_FaceFXBlendUnchangedCopies);
 					}
 					else
 					{
-						//additive mode
-						BoneTM = Output.Pose.GetComponentSpaceTransform(CompactPoseBoneIndex);
+						//take a copy of the latest published track values. In the rare case no consistent copy can be made we stick to the previous values
+						if (FaceFXChar->GetTrackValues(ScratchTrackValues))
+						{
+							Swap(FaceFXTrackValues, ScratchTrackValues);
+							bIsTrackValuesCopied = true;
+							TrackValuesVersion = OutputVersion;
+						}
+					}
 
-						//convert to Bone Space
-						FAnimationRuntime::ConvertCSTransformToBoneSpace(FTransform::Identity, Output.Pose, BoneTM, CompactPoseBoneIndex, EBoneControlSpace::BCS_ParentBoneSpace);
+					if (FaceFXTrackValues.Num() >= NumRequiredTrackValues)
+					{
+						BlendCurves(Output, BlendWeight);
+					}
+				}
 
-						BoneTM.SetScale3D(BoneTM.GetScale3D() + FaceFXBoneTM.GetScale3D());
-						BoneTM.SetRotation(FaceFXBoneTM.GetRotation() * BoneTM.GetRotation());
-						BoneTM.AddToTranslation(FaceFXBoneTM.GetTranslation());
+				if (CompactPoseEntries.Num() <= 0)
+				{
+					return;
+				}
+
+				if (bIsBoneTransformsCopied && BoneTransformsVersion == OutputVersion)
+				{
+					INC_DWORD_STAT(STAT_FaceFXBlendUnchangedCopies);
+				}
+				else
+				{
+					//take a copy of the latest published transforms. In the rare case no consistent copy can be made we stick to the previous transforms
+					if (FaceFXChar->GetBoneTransforms(ScratchBoneTransforms))
+					{
+						Swap(FaceFXBoneTransforms, ScratchBoneTransforms);
+						bIsBoneTransformsCopied = true;
+						BoneTransformsVersion = OutputVersion;
 					}
+				}
 
-					//convert back to Component Space
-					FAnimationRuntime::ConvertBoneSpaceTransformToCS(FTransform::Identity, Output.Pose, BoneTM, CompactPoseBoneIndex, EBoneControlSpace::BCS_ParentBoneSpace);
+				if (FaceFXBoneTransforms.Num() < NumRequiredTransforms)
+				{
+					//nothing published yet
+					return;
+				}
 
-					//sanity check
-					checkSlow(!FaceFXContainsNaN(TargetBlendTransform));
+				INC_DWORD_STAT_BY(STAT_FaceFXBlendBones, CompactPoseEntries.Num());
 
-					//apply to pose after each bone transform update in order to have proper parent transforms when update childs
-					Output.Pose.LocalBlendCSBoneTransforms(TargetBlendTransform, BlendWeight);
+				if (bBlendInLocalSpace)
+				{
+					BlendLocalSpace(Output.Pose, BlendWeight);
+				}
+				else
+				{
+					BlendComponentSpace(Output.Pose, BlendWeight);
 				}
 			}
 		}
 	}
 }
+
+void FAnimNode_BlendFaceFXAnimation::BlendCurves(FComponentSpacePoseContext& Output, float BlendWeight)
+{
+	INC_DWORD_STAT_BY(STAT_FaceFXBlendCurves, CurveEntries.Num());
+
+	//curves that are not required at the current LOD get skipped by the curve itself
+	for (const FCurveEntry& Entry : CurveEntries)
+	{
+		if (ExcludedTracks.IsValidIndex(Entry.TrackIdx) && ExcludedTracks[Entry.TrackIdx])
+		{
+			//skipped by the LOD mask
+			continue;
+		}
+
+		const float TrackValue = FaceFXTrackValues[Entry.TrackIdx];
+
+		if (BlendWeight >= 1.f - ZERO_ANIMWEIGHT_THRESH)
+		{
+			Output.Curve.Set(Entry.CurveUID, TrackValue);
+		}
+		else
+		{
+			Output.Curve.Set(Entry.CurveUID, FMath::Lerp(Output.Curve.Get(Entry.CurveUID), TrackValue, BlendWeight));
+		}
+	}
+}
+
+void FAnimNode_BlendFaceFXAnimation::BlendComponentSpace(FCSPose<FCompactPose>& Pose, float BlendWeight)
+{
+	for (const FCompactPoseEntry& Entry : CompactPoseEntries)
+	{
+		const FTransform& FaceFXBoneTM = FaceFXBoneTransforms[Entry.TransformIdx];
+		const FCompactPoseBoneIndex& CompactPoseBoneIndex = Entry.CompactPoseBoneIndex;
+
+		//fill target transform
+		TargetBlendTransform[0].BoneIndex = CompactPoseBoneIndex;
+
+		//convenience alias
+		FTransform& BoneTM = TargetBlendTransform[0].Transform;
+
+		//apply transformations in bone space
+		if (BlendMode == EFaceFXBlendMode::Replace)
+		{
+			BoneTM = FaceFXBoneTM;
+		}
+		else
+		{
+			//additive mode
+			BoneTM = Pose.GetComponentSpaceTransform(CompactPoseBoneIndex);
+
+			//convert to Bone Space
+			FAnimationRuntime::ConvertCSTransformToBoneSpace(FTransform::Identity, Pose, BoneTM, CompactPoseBoneIndex, EBoneControlSpace::BCS_ParentBoneSpace);
+
+			BoneTM.SetScale3D(BoneTM.GetScale3D() + FaceFXBoneTM.GetScale3D());
+			BoneTM.SetRotation(FaceFXBoneTM.GetRotation() * BoneTM.GetRotation());
+			BoneTM.AddToTranslation(FaceFXBoneTM.GetTranslation());
+		}
+
+		//convert back to Component Space
+		FAnimationRuntime::ConvertBoneSpaceTransformToCS(FTransform::Identity, Pose, BoneTM, CompactPoseBoneIndex, EBoneControlSpace::BCS_ParentBoneSpace);
+
+		//sanity check
+		checkSlow(!FaceFXContainsNaN(TargetBlendTransform));
+
+		//apply to pose after each bone transform update in order to have proper parent transforms when update childs
+		Pose.LocalBlendCSBoneTransforms(TargetBlendTransform, BlendWeight);
+	}
+}
+
+void FAnimNode_BlendFaceFXAnimation::BlendLocalSpace(FCSPose<FCompactPose>& Pose, float BlendWeight)
+{
+	//the pose is only read until all bones got blended, so each component space transform gets computed at most once
+	LocalBlendTransforms.Reset(CompactPoseEntries.Num());
+	LocalBlendSlots.Init(INDEX_NONE, Pose.GetPose().GetNumBones());
+
+	for (const FCompactPoseEntry& Entry : CompactPoseEntries)
+	{
+		const FTransform& FaceFXBoneTM = FaceFXBoneTransforms[Entry.TransformIdx];
+		const FCompactPoseBoneIndex& CompactPoseBoneIndex = Entry.CompactPoseBoneIndex;
+		const FCompactPoseBoneIndex ParentIndex = Pose.GetPose().GetParentBoneIndex(CompactPoseBoneIndex);
+
+		//the parent transform before and after blending. The entries are in parents before children order so blended parents are already known
+		FTransform ParentTM = FTransform::Identity;
+		FTransform BlendedParentTM = FTransform::Identity;
+
+		if (ParentIndex.IsValid())
+		{
+			ParentTM = Pose.GetComponentSpaceTransform(ParentIndex);
+
+			const int32 ParentSlot = LocalBlendSlots[ParentIndex.GetInt()];
+			BlendedParentTM = ParentSlot != INDEX_NONE ? LocalBlendTransforms[ParentSlot].Transform : ParentTM;
+		}
+
+		//the current transform relative to the parent. Includes the changes upstream nodes made in component space
+		FTransform LocalTM = Pose.GetComponentSpaceTransform(CompactPoseBoneIndex).GetRelativeTransform(ParentTM);
+
+		FTransform BoneTM;
+
+		if (BlendMode == EFaceFXBlendMode::Replace)
+		{
+			BoneTM = FaceFXBoneTM;
+		}
+		else
+		{
+			//additive mode
+			BoneTM = LocalTM;
+			BoneTM.SetScale3D(BoneTM.GetScale3D() + FaceFXBoneTM.GetScale3D());
+			BoneTM.SetRotation(FaceFXBoneTM.GetRotation() * BoneTM.GetRotation());
+			BoneTM.AddToTranslation(FaceFXBoneTM.GetTranslation());
+		}
+
+		//sanity check
+		checkSlow(!BoneTM.ContainsNaN());
+
+		if (BlendWeight < 1.f - ZERO_ANIMWEIGHT_THRESH)
+		{
+			LocalTM.BlendWith(BoneTM, BlendWeight);
+			BoneTM = LocalTM;
+		}
+
+		LocalBlendSlots[CompactPoseBoneIndex.GetInt()] = LocalBlendTransforms.Num();
+		LocalBlendTransforms.Add(FBoneTransform(CompactPoseBoneIndex, BoneTM * BlendedParentTM));
+	}
+
+	//write all blended bones back at once. The pose requires them in bone index order and recomputes the children of the blended bones from their local transforms
+	LocalBlendTransforms.Sort(FCompareBoneTransformIndex());
+	Pose.LocalBlendCSBoneTransforms(LocalBlendTransforms, 1.f);
+}
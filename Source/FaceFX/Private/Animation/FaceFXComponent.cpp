@@ -66,6 +66,26 @@ bool UFaceFXComponent::Setup(USkeletalMeshComponent* SkelMeshComp, UActorCompone
 	return false;
 }
 
+bool UFaceFXComponent::SetCustomPrimitiveDataTracks(const TMap<FName, int32>& Tracks, USkeletalMeshComponent* SkelMeshComp, const UObject* Caller)
+{
+	FFaceFXEntry* Entry = SkelMeshComp ? Entries.FindByKey(SkelMeshComp) : (Entries.Num() > 0 ? &Entries[0] : nullptr);
+
+	if (!Entry)
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXComponent::SetCustomPrimitiveDataTracks. FaceFX entry does not exist for given SkelMeshComp <%s>. Caller: %s"), *GetNameSafe(SkelMeshComp), *GetNameSafe(Caller));
+		return false;
+	}
+
+	Entry->CustomPrimitiveDataTracks = Tracks;
+
+	if (Entry->Character)
+	{
+		Entry->Character->SetCustomPrimitiveDataTracks(Tracks);
+	}
+
+	return true;
+}
+
 bool UFaceFXComponent::PlayById(FName Group, FName AnimName, USkeletalMeshComponent* SkelMeshComp, bool Loop, const UObject* Caller)
 {
 #if FACEFX_USEANIMATIONLINKAGE
@@ -142,6 +162,12 @@ bool UFaceFXComponent::JumpTo(float Position, bool Pause, UFaceFXAnim* Animation
 {
 	if (UFaceFXCharacter* Character = GetCharacter(SkelMeshComp))
 	{
+		if (Pause && Character->IsPaused() && Character->IsPlayingOrPaused(Animation))
+		{
+			//scrubbing within the paused animation only poses the character
+			return Character->ScrubTo(Position);
+		}
+
 		if (!Character->IsPlayingOrPaused(Animation))
 		{
 			Character->Play(Animation, LoopAnimation);
@@ -161,6 +187,12 @@ bool UFaceFXComponent::JumpToById(float Position, bool Pause, FName Group, FName
 	{
 		const FFaceFXAnimId AnimId(Group, AnimName);
 
+		if (Pause && Character->IsPaused() && Character->IsPlayingOrPaused(AnimId))
+		{
+			//scrubbing within the paused animation only poses the character
+			return Character->ScrubTo(Position);
+		}
+
 		if (!Character->IsPlayingOrPaused(AnimId) && !Character->Play(AnimId, LoopAnimation))
 		{
 			//new animation can't be started (most likely not found)
@@ -358,6 +390,9 @@ void UFaceFXComponent::CreateCharacter(FFaceFXEntry& Entry)
 			Entry.Character = NewObject<UFaceFXCharacter>(this);
 			checkf(Entry.Character, TEXT("Unable to instantiate a FaceFX character. Possibly Out of Memory."));
 
+			//applied during Load
+			Entry.Character->SetCustomPrimitiveDataTracks(Entry.CustomPrimitiveDataTracks);
+
 			if (!Entry.Character->Load(FaceFXActor, Entry.bIsCompensateForForceFrontXAxis, Entry.bIsDisableMorphTargets, Entry.bIsDisableMaterialParameters))
 			{
 				UE_LOG(LogFaceFX, Error, TEXT("SkeletalMesh Component FaceFX failed to get initialized. Loading failed. Component=%s. Asset=%s"), *GetName(), *Entry.Asset.ToSoftObjectPath().ToString());
@@ -0,0 +1,404 @@
+/*******************************************************************************
+The MIT License (MIT)
+Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#include "FaceFXAnimationSampler.h"
+#include "FaceFX.h"
+#include "FaceFXActor.h"
+#include "FaceFXAnim.h"
+#include "FaceFXActorTemplate.h"
+#include "FaceFXAnimationCache.h"
+#include "FaceFXEvaluatorBaked.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+DECLARE_CYCLE_STAT(TEXT("Sampler Evaluate"), STAT_FaceFXSamplerEvaluate, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sampler Cache Hits"), STAT_FaceFXSamplerCacheHits, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sampler Cache Misses"), STAT_FaceFXSamplerCacheMisses, STATGROUP_FACEFX);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Sampler Contexts"), STAT_FaceFXSamplerContexts, STATGROUP_FACEFX);
+
+//The maximum number of cached sampler results
+static int32 FaceFXSamplerCacheSize = 256;
+FAutoConsoleVariableRef CVarFaceFXSamplerCacheSize(TEXT("FaceFX.Sampler.CacheSize"), FaceFXSamplerCacheSize, TEXT("Sets the maximum number of FaceFX animation evaluations at quantized times kept cached by the stateless sampler. 0 to disable. Default: 256"));
+
+/** Event handler for the scratch actor handles. Stateless evaluations do not fire events */
+static void OnSamplerActorEvent(const FxEventFiringContext* Context, const char* Payload)
+{
+}
+
+FFaceFXAnimationSampler& FFaceFXAnimationSampler::Get()
+{
+	static FFaceFXAnimationSampler Instance;
+	return Instance;
+}
+
+bool FFaceFXAnimationSampler::Evaluate(const UFaceFXActor* Dataset, const UFaceFXAnim* Animation, float Time, bool IsCompensateForForceFrontXAxis, FFaceFXCharacterOutput& OutOutput)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FaceFXSamplerEvaluate);
+
+	if (!Dataset || !Dataset->IsValid())
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXAnimationSampler::Evaluate. Missing or invalid FaceFXActor asset. Asset: %s"), *GetNameSafe(Dataset));
+		return false;
+	}
+
+	if (!Animation || !Animation->IsValid())
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXAnimationSampler::Evaluate. Missing or invalid FaceFX animation asset. Asset: %s"), *GetNameSafe(Animation));
+		return false;
+	}
+
+	float AnimStart = 0.f;
+	float AnimEnd = 0.f;
+
+	if (!FaceFX::GetAnimationBounds(Animation, AnimStart, AnimEnd))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXAnimationSampler::Evaluate. Unable to retrieve the animation bounds. Actor: %s. Animation: %s"), *GetNameSafe(Dataset), *GetNameSafe(Animation));
+		return false;
+	}
+
+	const float AnimDuration = FMath::Max(AnimEnd - AnimStart, 0.f);
+
+	//the same quantized time always produces the same output, no matter if it got cached or not
+	const int32 Step = FMath::RoundToInt(FMath::Clamp(Time, 0.f, AnimDuration) / FACEFX_SAMPLER_TIME_STEP);
+	const float SampleTime = FMath::Min(Step * FACEFX_SAMPLER_TIME_STEP, AnimDuration);
+
+	const FxBoneSetFlags BoneSetFlags = FaceFX::GetBoneSetCreationFlags(FaceFX::GetBlendMode(Dataset), IsCompensateForForceFrontXAxis);
+	const FResultKey Key(Dataset, Animation, BoneSetFlags, Step);
+
+	uint32 EvaluatePurgeCounter = 0;
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		if (const FFaceFXCharacterOutput* Result = Results.Find(Key))
+		{
+			INC_DWORD_STAT(STAT_FaceFXSamplerCacheHits);
+			OutOutput = *Result;
+			return true;
+		}
+
+		EvaluatePurgeCounter = ResultPurgeCounter;
+	}
+
+	INC_DWORD_STAT(STAT_FaceFXSamplerCacheMisses);
+
+	//the parsed actor data is shared with the characters created from the same asset
+	const FFaceFXActorTemplatePtr ActorTemplate = FFaceFXActorTemplateCache::Get().Acquire(Dataset, BoneSetFlags);
+
+	if (!ActorTemplate.IsValid())
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXAnimationSampler::Evaluate. Unable to load FaceFX actor data. Asset: %s"), *GetNameSafe(Dataset));
+		return false;
+	}
+
+	TArray<float>& TrackValues = OutOutput.TrackValues;
+	TrackValues.SetNumUninitialized(ActorTemplate->GetTrackIds().Num(), false);
+
+	TArray<FxBoneTransform> FaceFXBoneTransforms;
+	FaceFXBoneTransforms.AddUninitialized(ActorTemplate->GetBoneIds().Num());
+
+	const FFaceFXAnimData& AnimData = Animation->GetData();
+
+	if (AnimData.IsBaked() && FFaceFXEvaluatorBaked::IsCanPlayBaked(AnimData.BakedData, Dataset, ActorTemplate))
+	{
+		FaceFX::SampleBakedAnimation(AnimData.BakedData, SampleTime, TrackValues.GetData(), FaceFXBoneTransforms.GetData());
+	}
+	else if (!EvaluateRuntime(Dataset, *ActorTemplate, Animation, SampleTime, TrackValues, FaceFXBoneTransforms))
+	{
+		return false;
+	}
+
+	OutOutput.BoneTransforms.SetNumUninitialized(FaceFXBoneTransforms.Num(), false);
+	FaceFX::ConvertBoneTransforms(FaceFXBoneTransforms.GetData(), OutOutput.BoneTransforms.GetData(), FaceFXBoneTransforms.Num());
+
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		//results of assets that got purged in the meantime may be outdated
+		if (EvaluatePurgeCounter == ResultPurgeCounter)
+		{
+			AddResult(Key, OutOutput);
+		}
+	}
+
+	return true;
+}
+
+bool FFaceFXAnimationSampler::EvaluateRuntime(const UFaceFXActor* Dataset, const FFaceFXActorTemplate& ActorTemplate, const UFaceFXAnim* Animation, float Time, TArray<float>& OutTrackValues, TArray<FxBoneTransform>& OutBoneTransforms)
+{
+	uint32 AcquirePurgeCounter = 0;
+	{
+		FScopeLock Lock(&CriticalSection);
+		AcquirePurgeCounter = ContextPurgeCounter;
+	}
+
+	FContext Context;
+
+	if (!AcquireContext(Dataset, ActorTemplate.IsDataValidated(), Context))
+	{
+		return false;
+	}
+
+	FxAnimation AnimHandle = FFaceFXAnimationCache::Get().Acquire(Animation);
+
+	bool IsSucceeded = false;
+	bool IsPlaying = false;
+
+	FxResult Result = FX_SUCCESS;
+
+	if (!AnimHandle)
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXAnimationSampler::EvaluateRuntime. Unable to load the animation. Actor: %s. Animation: %s"), *GetNameSafe(Dataset), *GetNameSafe(Animation));
+	}
+	else if (!ActorTemplate.IsCompatible(Animation, Context.Actor))
+	{
+		UE_LOG(LogFaceFX, Warning, TEXT("FFaceFXAnimationSampler::EvaluateRuntime. Animation is not compatible with FaceFX actor. Actor: %s. Animation: %s"), *GetNameSafe(Dataset), *GetNameSafe(Animation));
+	}
+	else if (!FX_SUCCEEDED(Result = fxActorPlayAnimation(Context.Actor, AnimHandle, nullptr)))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXAnimationSampler::EvaluateRuntime. FaceFX call <fxActorPlayAnimation> failed. %s. Actor: %s. Animation: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset), *GetNameSafe(Animation));
+	}
+	else
+	{
+		IsPlaying = true;
+
+		//the first processed frame anchors the animation. Same as jumping to a position on a character
+		if (!FX_SUCCEEDED(Result = fxActorProcessFrame(Context.Actor, Context.FrameState, 0.f)) || !FX_SUCCEEDED(Result = fxActorProcessFrame(Context.Actor, Context.FrameState, Time)))
+		{
+			UE_LOG(LogFaceFX, Error, TEXT("FFaceFXAnimationSampler::EvaluateRuntime. FaceFX call <fxActorProcessFrame> failed. %s. Actor: %s. Animation: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset), *GetNameSafe(Animation));
+		}
+		else if (OutTrackValues.Num() > 0 && !FX_SUCCEEDED(Result = fxFrameStateGetTrackValues(Context.FrameState, OutTrackValues.GetData(), (size_t)OutTrackValues.Num())))
+		{
+			UE_LOG(LogFaceFX, Error, TEXT("FFaceFXAnimationSampler::EvaluateRuntime. FaceFX call <fxFrameStateGetTrackValues> failed. %s. Actor: %s. Animation: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset), *GetNameSafe(Animation));
+		}
+		else if (!FX_SUCCEEDED(Result = ActorTemplate.ComputeBoneTransforms(Context.FrameState, OutBoneTransforms.GetData(), OutBoneTransforms.Num())))
+		{
+			UE_LOG(LogFaceFX, Error, TEXT("FFaceFXAnimationSampler::EvaluateRuntime. Calculating bone transforms failed. %s. Actor: %s. Animation: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset), *GetNameSafe(Animation));
+		}
+		else
+		{
+			IsSucceeded = true;
+		}
+	}
+
+	//leave the scratch actor without an animation so the handle can be given back
+	if (IsPlaying && !FX_SUCCEEDED(Result = fxActorStopAnimation(Context.Actor, FX_CHANNEL_ANY)))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXAnimationSampler::EvaluateRuntime. FaceFX call <fxActorStopAnimation> failed. %s. Actor: %s. Animation: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset), *GetNameSafe(Animation));
+		DestroyContext(Context);
+	}
+	else
+	{
+		ReleaseContext(Dataset, Context, AcquirePurgeCounter);
+	}
+
+	FFaceFXAnimationCache::Get().Release(AnimHandle);
+
+	return IsSucceeded;
+}
+
+bool FFaceFXAnimationSampler::AcquireContext(const UFaceFXActor* Dataset, bool IsDataValidated, FContext& OutContext)
+{
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		if (TArray<FContext>* Contexts = FreeContexts.Find(Dataset))
+		{
+			if (Contexts->Num() > 0)
+			{
+				OutContext = Contexts->Pop(false);
+				return true;
+			}
+		}
+	}
+
+	//create the handles outside of the lock so other threads can keep evaluating
+	FxEventCallbacks EventHandler;
+	EventHandler.pfnEventFired = OnSamplerActorEvent;
+	EventHandler.pUserData = nullptr;
+
+	const FxResult Result = FFaceFXActorTemplate::CreateActor(Dataset->GetData(), IsDataValidated, EventHandler, OutContext.Actor, &OutContext.FrameState);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXAnimationSampler::AcquireContext. Unable to create FaceFX actor handle. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_FaceFXSamplerContexts);
+
+	return true;
+}
+
+void FFaceFXAnimationSampler::ReleaseContext(const UFaceFXActor* Dataset, FContext& Context, uint32 AcquirePurgeCounter)
+{
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		//contexts created from data that got purged in the meantime may be outdated
+		if (AcquirePurgeCounter == ContextPurgeCounter)
+		{
+			FreeContexts.FindOrAdd(Dataset).Add(Context);
+			Context = FContext();
+			return;
+		}
+	}
+
+	DestroyContext(Context);
+}
+
+void FFaceFXAnimationSampler::DestroyContext(FContext& Context)
+{
+	if (Context.FrameState)
+	{
+		FxResult Result = fxFrameStateDestroy(&Context.FrameState);
+
+		if (!FX_SUCCEEDED(Result))
+		{
+			UE_LOG(LogFaceFX, Error, TEXT("FFaceFXAnimationSampler::DestroyContext. FaceFX call <fxFrameStateDestroy> failed. %s"), *FaceFX::GetFaceFXResultString(Result));
+		}
+	}
+
+	if (Context.Actor)
+	{
+		FxResult Result = fxActorDestroy(&Context.Actor, nullptr, nullptr);
+
+		if (!FX_SUCCEEDED(Result))
+		{
+			UE_LOG(LogFaceFX, Error, TEXT("FFaceFXAnimationSampler::DestroyContext. FaceFX call <fxActorDestroy> failed. %s"), *FaceFX::GetFaceFXResultString(Result));
+		}
+
+		DEC_DWORD_STAT(STAT_FaceFXSamplerContexts);
+	}
+
+	Context = FContext();
+}
+
+void FFaceFXAnimationSampler::AddResult(const FResultKey& Key, const FFaceFXCharacterOutput& Output)
+{
+	const int32 MaxResults = FMath::Max(FaceFXSamplerCacheSize, 0);
+
+	if (ResultOrder.Num() > MaxResults || (ResultOrder.Num() < MaxResults && NextResultIdx != 0))
+	{
+		//the cache size changed. Restart the ring oldest first and keep only the newest results that still fit
+		int32 NumToDrop = ResultOrder.Num() - MaxResults;
+		RemoveResults([&NumToDrop](const FResultKey&) { return NumToDrop-- > 0; });
+	}
+
+	if (MaxResults == 0 || Results.Contains(Key))
+	{
+		return;
+	}
+
+	if (ResultOrder.Num() < MaxResults)
+	{
+		ResultOrder.Add(Key);
+	}
+	else
+	{
+		//evict the oldest result
+		Results.Remove(ResultOrder[NextResultIdx]);
+		ResultOrder[NextResultIdx] = Key;
+		NextResultIdx = (NextResultIdx + 1) % MaxResults;
+	}
+
+	Results.Add(Key, Output);
+}
+
+void FFaceFXAnimationSampler::EmptyResults()
+{
+	Results.Empty();
+	ResultOrder.Empty();
+	NextResultIdx = 0;
+}
+
+void FFaceFXAnimationSampler::RemoveResults(TFunctionRef<bool(const FResultKey&)> Predicate)
+{
+	const int32 NumResults = ResultOrder.Num();
+
+	//rebuild the order oldest first without the dropped keys. Stale keys would evict fresh results of the same key later on
+	TArray<FResultKey> NewResultOrder;
+	NewResultOrder.Reserve(NumResults);
+
+	for (int32 Idx = 0; Idx < NumResults; ++Idx)
+	{
+		const FResultKey& Key = ResultOrder[(NextResultIdx + Idx) % NumResults];
+
+		if (Predicate(Key))
+		{
+			Results.Remove(Key);
+		}
+		else
+		{
+			NewResultOrder.Add(Key);
+		}
+	}
+
+	ResultOrder = MoveTemp(NewResultOrder);
+	NextResultIdx = 0;
+}
+
+void FFaceFXAnimationSampler::Purge(const UFaceFXActor* Dataset)
+{
+	TArray<FContext> Contexts;
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		++ContextPurgeCounter;
+		++ResultPurgeCounter;
+		FreeContexts.RemoveAndCopyValue(Dataset, Contexts);
+
+		RemoveResults([Dataset](const FResultKey& Key) { return Key.Dataset == Dataset; });
+	}
+
+	for (FContext& Context : Contexts)
+	{
+		DestroyContext(Context);
+	}
+}
+
+void FFaceFXAnimationSampler::Purge(const UFaceFXAnim* Animation)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	++ResultPurgeCounter;
+
+	RemoveResults([Animation](const FResultKey& Key) { return Key.Animation == Animation; });
+}
+
+void FFaceFXAnimationSampler::Empty()
+{
+	TMap<const UFaceFXActor*, TArray<FContext>> Contexts;
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		++ContextPurgeCounter;
+		++ResultPurgeCounter;
+		Swap(Contexts, FreeContexts);
+		EmptyResults();
+	}
+
+	for (auto& Entry : Contexts)
+	{
+		for (FContext& Context : Entry.Value)
+		{
+			DestroyContext(Context);
+		}
+	}
+}
@@ -0,0 +1,63 @@
+/*******************************************************************************
+The MIT License (MIT)
+Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#include "FaceFXEvaluator.h"
+#include "FaceFXCharacter.h"
+#include "FaceFXActor.h"
+
+#include "FaceFXEvaluatorRuntime.h"
+#include "FaceFXEvaluatorBaked.h"
+
+#include "HAL/IConsoleManager.h"
+
+//Evaluator to use for FaceFX characters whose actor asset does not override it. Only affects characters loaded afterwards.
+// Supported values :
+//	0 = FaceFX runtime
+//	1 = Baked curves with the FaceFX runtime as fallback for animations without matching baked curves (Default)
+static int32 PreferredEvaluator = 1;
+FAutoConsoleVariableRef CVarFaceFXPreferredEvaluator(TEXT("FaceFX.PreferredEvaluator"), PreferredEvaluator, TEXT("Sets the preferred evaluator of FaceFX characters loaded afterwards. 0=FaceFX runtime, 1=Baked curves with FaceFX runtime fallback (Default)"));
+
+void IFaceFXEvaluator::FireAnimationEvent(int32 ChannelIndex, float ChannelTime, float EventTime, FString&& Payload)
+{
+	if (Owner)
+	{
+		Owner->HandleAnimationEvent(ChannelIndex, ChannelTime, EventTime, MoveTemp(Payload));
+	}
+}
+
+TSharedPtr<IFaceFXEvaluator> FFaceFXEvaluator::Create(UFaceFXCharacter* Owner, const UFaceFXActor* Dataset)
+{
+	check(Dataset);
+
+	bool IsBaked = PreferredEvaluator == 1;
+	switch (Dataset->GetEvaluator())
+	{
+	case EFaceFXActorEvaluator::Runtime: IsBaked = false; break;
+	case EFaceFXActorEvaluator::Baked: IsBaked = true; break;
+	default: break;
+	}
+
+	if (IsBaked)
+	{
+		return MakeShareable(new FFaceFXEvaluatorBaked(Owner));
+	}
+
+	return MakeShareable(new FFaceFXEvaluatorRuntime(Owner));
+}
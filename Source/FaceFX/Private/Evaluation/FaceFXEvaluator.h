@@ -0,0 +1,180 @@
+/*******************************************************************************
+The MIT License (MIT)
+Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#pragma once
+
+#include "FaceFXActorTemplate.h"
+
+class UFaceFXCharacter;
+class UFaceFXActor;
+class UFaceFXAnim;
+
+/**
+* Interface for a backend that evaluates the facial animations of a FaceFX character.
+* Abstracts the actor creation, the frame processing, the track value readback and the bone transform computation
+*/
+struct IFaceFXEvaluator
+{
+	virtual ~IFaceFXEvaluator(){}
+
+	/**
+	* Gets the name of the evaluator
+	* @returns The name
+	*/
+	virtual const TCHAR* GetName() const = 0;
+
+	/**
+	* Creates the evaluation state for an actor asset
+	* @param Dataset The actor asset
+	* @param InActorTemplate The shared template of the actor asset
+	* @returns True if succeeded, else false
+	*/
+	virtual bool Load(const UFaceFXActor* Dataset, const FFaceFXActorTemplatePtr& InActorTemplate) = 0;
+
+	/** Releases the evaluation state including the loaded animation */
+	virtual void Unload() = 0;
+
+	/**
+	* Gets the indicator if the evaluation state got created
+	* @returns True if loaded, else false
+	*/
+	virtual bool IsLoaded() const = 0;
+
+	/**
+	* Gets the indicator if an animation can be played with the loaded actor
+	* @param Animation The animation to check
+	* @returns True if it can play the animation, else false
+	*/
+	virtual bool IsCanPlay(const UFaceFXAnim* Animation) const = 0;
+
+	/**
+	* Loads an animation for playback. Replaces the previously loaded animation on success
+	* @param Animation The animation to load
+	* @returns True if succeeded, false if the animation is not compatible with the loaded actor
+	*/
+	virtual bool LoadAnimation(const UFaceFXAnim* Animation) = 0;
+
+	/** Releases the loaded animation */
+	virtual void UnloadAnimation() = 0;
+
+	/**
+	* Gets the indicator if an animation is loaded
+	* @returns True if loaded, else false
+	*/
+	virtual bool IsAnimationLoaded() const = 0;
+
+	/**
+	* Starts the playback of the loaded animation. The animation gets anchored at the time of the next processed frame
+	* @returns True if succeeded, else false
+	*/
+	virtual bool Play() = 0;
+
+	/**
+	* Starts the playback of the loaded animation at a position. The animation gets anchored at the character time 0 and the frame at the position gets processed
+	* @param Position The animation position in seconds
+	* @param OutIsAudioStart Indicator if the animation requested the start of the audio playback up to the position
+	* @returns True if succeeded, else false
+	*/
+	virtual bool PlayAt(float Position, bool& OutIsAudioStart) = 0;
+
+	/**
+	* Stops the playback of the loaded animation
+	* @returns True if succeeded, else false
+	*/
+	virtual bool Stop() = 0;
+
+	/**
+	* Pauses the playback of the loaded animation
+	* @param Time The character time to pause at
+	* @returns True if succeeded, else false
+	*/
+	virtual bool Pause(float Time) = 0;
+
+	/**
+	* Resumes the playback of the loaded animation
+	* @param Time The character time to resume at
+	* @returns True if succeeded, else false
+	*/
+	virtual bool Resume(float Time) = 0;
+
+	/**
+	* Processes the frame at the given character time. Events fired by the animation get reported to the owning character
+	* @param Time The character time
+	* @param OutIsAudioStart Indicator if the animation requested the start of the audio playback within this frame
+	* @returns True if succeeded, else false
+	*/
+	virtual bool ProcessFrame(float Time, bool& OutIsAudioStart) = 0;
+
+	/**
+	* Reads the track values of the last processed frame
+	* @param OutTrackValues The track values. Must hold Num entries
+	* @param Num The number of track values
+	* @returns True if succeeded, else false
+	*/
+	virtual bool GetTrackValues(float* OutTrackValues, int32 Num) = 0;
+
+	/**
+	* Computes the bone transforms of the last processed frame
+	* @param OutBoneTransforms The bone transforms. Must hold Num entries
+	* @param Num The number of bone transforms
+	* @returns True if succeeded, else false
+	*/
+	virtual bool ComputeBoneTransforms(FxBoneTransform* OutBoneTransforms, int32 Num) = 0;
+
+	/**
+	* Gets the owning character of this evaluator
+	* @returns The owning character
+	*/
+	inline UFaceFXCharacter* GetOwner() const
+	{
+		return Owner;
+	}
+
+protected:
+
+	IFaceFXEvaluator(UFaceFXCharacter* InOwner) : Owner(InOwner) {}
+
+	/**
+	* Reports an event fired by the playing animation to the owning character
+	* @param ChannelIndex The index of the channel the event got fired on
+	* @param ChannelTime The channel time
+	* @param EventTime The event time
+	* @param Payload The event payload
+	*/
+	void FireAnimationEvent(int32 ChannelIndex, float ChannelTime, float EventTime, FString&& Payload);
+
+	/** The owning character. The character owns the evaluator and evaluations may run on worker threads, hence no weak pointer */
+	UFaceFXCharacter* Owner;
+};
+
+/** Main evaluation layer */
+struct FFaceFXEvaluator
+{
+	/**
+	* Creates the evaluator to be used. The evaluator set on the actor asset overrides the preferred one
+	* @param Owner The owning character to create the evaluator for
+	* @param Dataset The actor asset the character gets loaded with
+	*/
+	static TSharedPtr<IFaceFXEvaluator> Create(UFaceFXCharacter* Owner, const UFaceFXActor* Dataset);
+
+private:
+
+	FFaceFXEvaluator(){}
+};
@@ -0,0 +1,248 @@
+/*******************************************************************************
+The MIT License (MIT)
+Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#include "FaceFXEvaluatorBaked.h"
+#include "FaceFX.h"
+#include "FaceFXActor.h"
+#include "FaceFXAnim.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Baked Evaluations"), STAT_FaceFXBakedEvaluations, STATGROUP_FACEFX);
+
+FFaceFXEvaluatorBaked::~FFaceFXEvaluatorBaked()
+{
+	Unload();
+}
+
+bool FFaceFXEvaluatorBaked::Load(const UFaceFXActor* InDataset, const FFaceFXActorTemplatePtr& InActorTemplate)
+{
+	check(InDataset);
+	check(InActorTemplate.IsValid());
+
+	Unload();
+
+	Dataset = InDataset;
+	ActorTemplate = InActorTemplate;
+
+	return true;
+}
+
+void FFaceFXEvaluatorBaked::Unload()
+{
+	UnloadAnimation();
+
+	//destroys the FaceFX actor handle if one got created
+	Runtime.Reset();
+
+	ActorTemplate.Reset();
+	Dataset = nullptr;
+
+	TrackValues.Empty();
+	BoneTransforms.Empty();
+}
+
+FFaceFXEvaluatorRuntime* FFaceFXEvaluatorBaked::GetRuntime() const
+{
+	if (!Runtime.IsValid() && Dataset)
+	{
+		TUniquePtr<FFaceFXEvaluatorRuntime> NewRuntime = MakeUnique<FFaceFXEvaluatorRuntime>(GetOwner());
+
+		if (!NewRuntime->Load(Dataset, ActorTemplate))
+		{
+			UE_LOG(LogFaceFX, Error, TEXT("FFaceFXEvaluatorBaked::GetRuntime. Unable to load the runtime evaluator. Asset: %s"), *GetNameSafe(Dataset));
+			return nullptr;
+		}
+
+		Runtime = MoveTemp(NewRuntime);
+	}
+
+	return Runtime.Get();
+}
+
+bool FFaceFXEvaluatorBaked::IsCanPlay(const UFaceFXAnim* Animation) const
+{
+	if (!Animation || !Dataset)
+	{
+		return false;
+	}
+
+	const FFaceFXAnimData& AnimData = Animation->GetData();
+
+	if (AnimData.IsBaked() && AnimData.HasTimeline() && IsCanPlayBaked(AnimData.BakedData, Dataset, ActorTemplate))
+	{
+		return true;
+	}
+
+	//checking does not need the runtime evaluator to be created
+	return Runtime.IsValid() ? Runtime->IsCanPlay(Animation) : ActorTemplate.IsValid() && ActorTemplate->IsCompatible(Animation);
+}
+
+bool FFaceFXEvaluatorBaked::IsCanPlayBaked(const FFaceFXBakedAnimData& BakedData, const UFaceFXActor* Dataset, const FFaceFXActorTemplatePtr& ActorTemplate)
+{
+	return BakedData.IsValid() && Dataset && ActorTemplate.IsValid() && BakedData.ActorDataHash == Dataset->GetData().DataHash &&
+		BakedData.BoneSetFlags == ActorTemplate->GetBoneSetFlags() && BakedData.NumTracks == ActorTemplate->GetTrackIds().Num() &&
+		BakedData.NumBoneValues == ActorTemplate->GetBoneIds().Num() * int32(sizeof(FxBoneTransform) / sizeof(float));
+}
+
+bool FFaceFXEvaluatorBaked::LoadAnimation(const UFaceFXAnim* Animation)
+{
+	check(Animation);
+
+	const FFaceFXAnimData& AnimData = Animation->GetData();
+
+	if (AnimData.IsBaked() && AnimData.HasTimeline() && IsCanPlayBaked(AnimData.BakedData, Dataset, ActorTemplate))
+	{
+		UnloadAnimation();
+
+		CurrentBakedAnim = &AnimData.BakedData;
+		CurrentTimeline = &AnimData.Timeline;
+
+		TrackValues.SetNumUninitialized(CurrentBakedAnim->NumTracks);
+		BoneTransforms.SetNumUninitialized(CurrentBakedAnim->NumBoneValues / (sizeof(FxBoneTransform) / sizeof(float)));
+		return true;
+	}
+
+	//the runtime evaluator replaces its previously loaded animation only on success
+	FFaceFXEvaluatorRuntime* RuntimeEvaluator = GetRuntime();
+
+	if (!RuntimeEvaluator || !RuntimeEvaluator->LoadAnimation(Animation))
+	{
+		return false;
+	}
+
+	CurrentBakedAnim = nullptr;
+	CurrentTimeline = nullptr;
+	return true;
+}
+
+void FFaceFXEvaluatorBaked::UnloadAnimation()
+{
+	//the runtime evaluator is kept so the next animation without matching baked curves reuses its FaceFX actor
+	if (Runtime.IsValid())
+	{
+		Runtime->UnloadAnimation();
+	}
+
+	CurrentBakedAnim = nullptr;
+	CurrentTimeline = nullptr;
+}
+
+bool FFaceFXEvaluatorBaked::Play()
+{
+	StartTime = -1.f;
+	NextEventIdx = 0;
+	bIsAudioStarted = false;
+
+	return CurrentBakedAnim || (Runtime.IsValid() && Runtime->Play());
+}
+
+bool FFaceFXEvaluatorBaked::PlayAt(float Position, bool& OutIsAudioStart)
+{
+	if (!CurrentBakedAnim)
+	{
+		return Runtime.IsValid() && Runtime->PlayAt(Position, OutIsAudioStart);
+	}
+
+	INC_DWORD_STAT(STAT_FaceFXBakedEvaluations);
+
+	//anchor right away and look up the event and audio state at the position instead of processing the frames up to it
+	StartTime = 0.f;
+	NextEventIdx = FFaceFXAnimTimeline::FindNextEvent(CurrentTimeline->Events, Position);
+
+	OutIsAudioStart = CurrentTimeline->IsAudioStarted(Position);
+	bIsAudioStarted = OutIsAudioStart;
+
+	FaceFX::SampleBakedAnimation(*CurrentBakedAnim, Position, TrackValues.GetData(), BoneTransforms.GetData());
+
+	return true;
+}
+
+bool FFaceFXEvaluatorBaked::Stop()
+{
+	return CurrentBakedAnim || (Runtime.IsValid() && Runtime->Stop());
+}
+
+bool FFaceFXEvaluatorBaked::Pause(float Time)
+{
+	//the character time does not progress while paused so the baked curves continue where they stopped
+	return CurrentBakedAnim || (Runtime.IsValid() && Runtime->Pause(Time));
+}
+
+bool FFaceFXEvaluatorBaked::Resume(float Time)
+{
+	return CurrentBakedAnim || (Runtime.IsValid() && Runtime->Resume(Time));
+}
+
+bool FFaceFXEvaluatorBaked::ProcessFrame(float Time, bool& OutIsAudioStart)
+{
+	if (!CurrentBakedAnim)
+	{
+		return Runtime.IsValid() && Runtime->ProcessFrame(Time, OutIsAudioStart);
+	}
+
+	INC_DWORD_STAT(STAT_FaceFXBakedEvaluations);
+
+	//the first processed frame anchors the baked curves the same way the FaceFX runtime anchors an animation
+	if (StartTime < 0.f)
+	{
+		StartTime = Time;
+	}
+
+	const float AnimTime = Time - StartTime;
+
+	//fire the events passed since the last processed frame
+	const TArray<FFaceFXTimelineEvent>& Events = CurrentTimeline->Events;
+
+	for (; NextEventIdx < Events.Num() && Events[NextEventIdx].Time <= AnimTime; ++NextEventIdx)
+	{
+		const FFaceFXTimelineEvent& Event = Events[NextEventIdx];
+		FireAnimationEvent(Event.ChannelIndex, Event.ChannelTime, Event.EventTime, CopyTemp(Event.Payload));
+	}
+
+	OutIsAudioStart = !bIsAudioStarted && CurrentTimeline->IsAudioStarted(AnimTime);
+	bIsAudioStarted |= OutIsAudioStart;
+
+	FaceFX::SampleBakedAnimation(*CurrentBakedAnim, AnimTime, TrackValues.GetData(), BoneTransforms.GetData());
+
+	return true;
+}
+
+bool FFaceFXEvaluatorBaked::GetTrackValues(float* OutTrackValues, int32 Num)
+{
+	if (!CurrentBakedAnim)
+	{
+		return Runtime.IsValid() && Runtime->GetTrackValues(OutTrackValues, Num);
+	}
+
+	check(Num == TrackValues.Num());
+	FMemory::Memcpy(OutTrackValues, TrackValues.GetData(), Num * sizeof(float));
+	return true;
+}
+
+bool FFaceFXEvaluatorBaked::ComputeBoneTransforms(FxBoneTransform* OutBoneTransforms, int32 Num)
+{
+	if (!CurrentBakedAnim)
+	{
+		return Runtime.IsValid() && Runtime->ComputeBoneTransforms(OutBoneTransforms, Num);
+	}
+
+	check(Num == BoneTransforms.Num());
+	FMemory::Memcpy(OutBoneTransforms, BoneTransforms.GetData(), Num * sizeof(FxBoneTransform));
+	return true;
+}
@@ -0,0 +1,143 @@
+/*******************************************************************************
+The MIT License (MIT)
+Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#pragma once
+
+#include "FaceFXEvaluatorRuntime.h"
+
+struct FFaceFXBakedAnimData;
+struct FFaceFXAnimTimeline;
+
+/**
+* Evaluator that samples the baked curves of animations instead of evaluating them.
+* Animations without baked curves matching the loaded actor get evaluated by a FaceFX runtime evaluator that is only created for those
+*/
+struct FFaceFXEvaluatorBaked : public IFaceFXEvaluator
+{
+	FFaceFXEvaluatorBaked(UFaceFXCharacter* InOwner) : IFaceFXEvaluator(InOwner), Dataset(nullptr), CurrentBakedAnim(nullptr), CurrentTimeline(nullptr), StartTime(-1.f), NextEventIdx(0), bIsAudioStarted(false) {}
+
+	virtual ~FFaceFXEvaluatorBaked();
+
+	virtual const TCHAR* GetName() const override
+	{
+		return TEXT("Baked");
+	}
+
+	/**
+	* Keeps the actor asset. The FaceFX actor handle only gets created once an animation without matching baked curves gets loaded
+	* @param InDataset The actor asset
+	* @param InActorTemplate The shared template of the actor asset
+	* @returns True if succeeded, else false
+	*/
+	virtual bool Load(const UFaceFXActor* InDataset, const FFaceFXActorTemplatePtr& InActorTemplate) override;
+
+	/** Releases the baked curves and the runtime evaluator */
+	virtual void Unload() override;
+
+	virtual bool IsLoaded() const override
+	{
+		return Dataset != nullptr;
+	}
+
+	/**
+	* Gets the indicator if an animation can be played with the loaded actor. Animations without matching baked curves are checked by the runtime evaluator
+	* @param Animation The animation to check
+	* @returns True if it can play the animation, else false
+	*/
+	virtual bool IsCanPlay(const UFaceFXAnim* Animation) const override;
+
+	/**
+	* Loads the baked curves of an animation. Animations without matching baked curves get loaded into the runtime evaluator
+	* @param Animation The animation to load
+	* @returns True if succeeded, false if the animation is not compatible with the loaded actor
+	*/
+	virtual bool LoadAnimation(const UFaceFXAnim* Animation) override;
+	virtual void UnloadAnimation() override;
+
+	virtual bool IsAnimationLoaded() const override
+	{
+		return CurrentBakedAnim || (Runtime.IsValid() && Runtime->IsAnimationLoaded());
+	}
+
+	virtual bool Play() override;
+	virtual bool PlayAt(float Position, bool& OutIsAudioStart) override;
+	virtual bool Stop() override;
+	virtual bool Pause(float Time) override;
+	virtual bool Resume(float Time) override;
+	virtual bool ProcessFrame(float Time, bool& OutIsAudioStart) override;
+	virtual bool GetTrackValues(float* OutTrackValues, int32 Num) override;
+	virtual bool ComputeBoneTransforms(FxBoneTransform* OutBoneTransforms, int32 Num) override;
+
+	/**
+	* Gets the indicator if the loaded animation plays its baked curves
+	* @returns True if baked, else false
+	*/
+	inline bool IsPlayingBaked() const
+	{
+		return CurrentBakedAnim != nullptr;
+	}
+
+	/**
+	* Gets if the baked curves of an animation can be played with an actor
+	* @param BakedData The baked curves
+	* @param Dataset The actor asset
+	* @param ActorTemplate The template of the actor asset
+	* @returns True if the curves got baked against the actor data and bone set, else false
+	*/
+	static bool IsCanPlayBaked(const FFaceFXBakedAnimData& BakedData, const UFaceFXActor* Dataset, const FFaceFXActorTemplatePtr& ActorTemplate);
+
+private:
+
+	/**
+	* Gets the runtime evaluator for animations without matching baked curves. Creates and loads it on first use
+	* @returns The runtime evaluator if succeeded, else nullptr
+	*/
+	FFaceFXEvaluatorRuntime* GetRuntime() const;
+
+	/** The loaded actor asset */
+	const UFaceFXActor* Dataset;
+
+	/** The shared template of the loaded actor asset */
+	FFaceFXActorTemplatePtr ActorTemplate;
+
+	/** The evaluator of the animations without matching baked curves. Created on demand, so characters that only play baked curves never create a FaceFX actor */
+	mutable TUniquePtr<FFaceFXEvaluatorRuntime> Runtime;
+
+	/** The baked curves of the loaded animation. nullptr if the animation gets evaluated by the FaceFX runtime */
+	const FFaceFXBakedAnimData* CurrentBakedAnim;
+
+	/** The timeline of the loaded animation that provides the audio start and the events of the baked curves. Set along with CurrentBakedAnim */
+	const FFaceFXAnimTimeline* CurrentTimeline;
+
+	/** The character time the baked curves started at. Negative until the first processed frame */
+	float StartTime;
+
+	/** The index of the next timeline event to fire */
+	int32 NextEventIdx;
+
+	/** The track values sampled by the last processed frame */
+	TArray<float> TrackValues;
+
+	/** The bone transforms sampled by the last processed frame */
+	TArray<FxBoneTransform> BoneTransforms;
+
+	/** Indicator if the baked curves passed the start of the audio */
+	bool bIsAudioStarted;
+};
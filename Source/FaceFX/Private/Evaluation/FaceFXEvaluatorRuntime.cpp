@@ -0,0 +1,269 @@
+/*******************************************************************************
+The MIT License (MIT)
+Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#include "FaceFXEvaluatorRuntime.h"
+#include "FaceFX.h"
+#include "FaceFXActor.h"
+#include "FaceFXAnim.h"
+#include "FaceFXActorTemplate.h"
+#include "FaceFXAnimationCache.h"
+
+FFaceFXEvaluatorRuntime::~FFaceFXEvaluatorRuntime()
+{
+	Unload();
+}
+
+bool FFaceFXEvaluatorRuntime::Load(const UFaceFXActor* InDataset, const FFaceFXActorTemplatePtr& InActorTemplate)
+{
+	check(InDataset);
+	check(InActorTemplate.IsValid());
+
+	Unload();
+
+	Dataset = InDataset;
+	ActorTemplate = InActorTemplate;
+
+	FxEventCallbacks EventHandler;
+	EventHandler.pfnEventFired = FFaceFXEvaluatorRuntime::OnFaceFXEvent;
+	EventHandler.pUserData = this;
+
+	const FxResult Result = FFaceFXActorTemplate::CreateActor(Dataset->GetData(), ActorTemplate->IsDataValidated(), EventHandler, Actor, &FrameState);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXEvaluatorRuntime::Load. Unable to create FaceFX actor handle. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+		Unload();
+		return false;
+	}
+
+	return true;
+}
+
+void FFaceFXEvaluatorRuntime::Unload()
+{
+	UnloadAnimation();
+
+	if (Actor)
+	{
+		FxResult Result = fxActorDestroy(&Actor, nullptr, nullptr);
+
+		if (!FX_SUCCEEDED(Result))
+		{
+			UE_LOG(LogFaceFX, Error, TEXT("FFaceFXEvaluatorRuntime::Unload. FaceFX call <fxActorDestroy> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+		}
+	}
+
+	if (FrameState)
+	{
+		FxResult Result = fxFrameStateDestroy(&FrameState);
+
+		if (!FX_SUCCEEDED(Result))
+		{
+			UE_LOG(LogFaceFX, Error, TEXT("FFaceFXEvaluatorRuntime::Unload. FaceFX call <fxFrameStateDestroy> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+		}
+	}
+
+	Actor = FX_INVALID_ACTOR;
+	FrameState = FX_INVALID_FRAMESTATE;
+
+	//the bone set is owned by the shared template
+	ActorTemplate.Reset();
+	Dataset = nullptr;
+}
+
+bool FFaceFXEvaluatorRuntime::IsCanPlay(const UFaceFXAnim* Animation) const
+{
+	return Animation && Actor && ActorTemplate.IsValid() && ActorTemplate->IsCompatible(Animation, Actor);
+}
+
+bool FFaceFXEvaluatorRuntime::LoadAnimation(const UFaceFXAnim* Animation)
+{
+	check(Animation);
+
+	//check if we actually can play this animation. Linked animations got checked during cook already
+	if (!IsCanPlay(Animation))
+	{
+		return false;
+	}
+
+	FxAnimation NewAnimation = FFaceFXAnimationCache::Get().Acquire(Animation);
+
+	if (!NewAnimation)
+	{
+		return false;
+	}
+
+	//unload previous animation
+	UnloadAnimation();
+
+	CurrentAnimation = NewAnimation;
+
+	return true;
+}
+
+void FFaceFXEvaluatorRuntime::UnloadAnimation()
+{
+	//the handle is shared with other characters. Give it back to the cache instead of destroying it
+	FFaceFXAnimationCache::Get().Release(CurrentAnimation);
+	CurrentAnimation = FX_INVALID_ANIMATION;
+}
+
+bool FFaceFXEvaluatorRuntime::Play()
+{
+	FxResult Result = fxActorPlayAnimation(Actor, CurrentAnimation, nullptr);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXEvaluatorRuntime::Play. FaceFX call <fxActorPlayAnimation> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+		return false;
+	}
+
+	return true;
+}
+
+bool FFaceFXEvaluatorRuntime::PlayAt(float Position, bool& OutIsAudioStart)
+{
+	//the FaceFX runtime anchors the animation at the first processed frame
+	bool IsAudioStartedAtZero = false;
+	bool IsAudioStartedAtPosition = false;
+
+	const bool IsProcessed = Play() && ProcessFrame(0.f, IsAudioStartedAtZero) && (Position <= 0.f || ProcessFrame(Position, IsAudioStartedAtPosition));
+
+	OutIsAudioStart = IsAudioStartedAtZero || IsAudioStartedAtPosition;
+	return IsProcessed;
+}
+
+bool FFaceFXEvaluatorRuntime::Stop()
+{
+	FxResult Result = fxActorStopAnimation(Actor, FX_CHANNEL_ANY);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXEvaluatorRuntime::Stop. FaceFX call <fxActorStopAnimation> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+		return false;
+	}
+
+	return true;
+}
+
+bool FFaceFXEvaluatorRuntime::Pause(float Time)
+{
+	FxResult Result = fxActorPauseAnimation(Actor, Time);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXEvaluatorRuntime::Pause. FaceFX call <fxActorPauseAnimation> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+		return false;
+	}
+
+	return true;
+}
+
+bool FFaceFXEvaluatorRuntime::Resume(float Time)
+{
+	FxResult Result = fxActorResumeAnimation(Actor, Time);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXEvaluatorRuntime::Resume. FaceFX call <fxActorResumeAnimation> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+		return false;
+	}
+
+	return true;
+}
+
+bool FFaceFXEvaluatorRuntime::ProcessFrame(float Time, bool& OutIsAudioStart)
+{
+	FxResult Result = fxActorProcessFrame(Actor, FrameState, Time);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXEvaluatorRuntime::ProcessFrame. FaceFX call <fxActorProcessFrame> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+		return false;
+	}
+
+	FxChannelFlags ChannelFlags[FACEFX_CHANNELS];
+
+	Result = fxFrameStateGetChannelFlags(FrameState, ChannelFlags, FACEFX_CHANNELS);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXEvaluatorRuntime::ProcessFrame. FaceFX call <fxFrameStateGetChannelFlags> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+		return false;
+	}
+
+	const FxChannelFlags EventStoppedCurrentAnimationFlags = FX_CHANNEL_ACTIVE_BIT | FX_CHANNEL_EVENT_FIRED_BIT | FX_CHANNEL_FINISHED_BIT;
+
+	if (EventStoppedCurrentAnimationFlags == ChannelFlags[0])
+	{
+		UE_LOG(LogFaceFX, Warning, TEXT("FFaceFXEvaluatorRuntime::ProcessFrame. The FaceFX event handler stopped the currently playing animation."));
+		return false;
+	}
+
+	OutIsAudioStart = (ChannelFlags[0] & FX_CHANNEL_START_AUDIO_BIT) != 0;
+
+	return true;
+}
+
+bool FFaceFXEvaluatorRuntime::GetTrackValues(float* OutTrackValues, int32 Num)
+{
+	if (Num <= 0)
+	{
+		return true;
+	}
+
+	FxResult Result = fxFrameStateGetTrackValues(FrameState, OutTrackValues, (size_t)Num);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXEvaluatorRuntime::GetTrackValues. FaceFX call <fxFrameStateGetTrackValues> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+		return false;
+	}
+
+	return true;
+}
+
+bool FFaceFXEvaluatorRuntime::ComputeBoneTransforms(FxBoneTransform* OutBoneTransforms, int32 Num)
+{
+	if (ActorTemplate.IsValid())
+	{
+		FxResult Result = ActorTemplate->ComputeBoneTransforms(FrameState, OutBoneTransforms, Num);
+
+		if (!FX_SUCCEEDED(Result))
+		{
+			UE_LOG(LogFaceFX, Error, TEXT("FFaceFXEvaluatorRuntime::ComputeBoneTransforms. Calculating bone transforms failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+			return false;
+		}
+	}
+	return true;
+}
+
+void FFaceFXEvaluatorRuntime::OnFaceFXEvent(const FxEventFiringContext* Context, const char* Payload)
+{
+	UE_LOG(LogFaceFX, Verbose, TEXT("FFaceFXEvaluatorRuntime::OnFaceFXEvent. FaceFX event received: %s."), ANSI_TO_TCHAR(Payload));
+
+	if (FFaceFXEvaluatorRuntime* Evaluator = static_cast<FFaceFXEvaluatorRuntime*>(Context->pUserData))
+	{
+		if (Context->actor == Evaluator->Actor && Context->animation == Evaluator->CurrentAnimation)
+		{
+			Evaluator->FireAnimationEvent((int32)Context->channelIndex, Context->channelTime, Context->eventTime, FString(ANSI_TO_TCHAR(Payload)));
+		}
+	}
+}
@@ -0,0 +1,111 @@
+/*******************************************************************************
+The MIT License (MIT)
+Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#pragma once
+
+#include "FaceFXEvaluator.h"
+
+/** Evaluator that evaluates the animations with the FaceFX runtime */
+struct FFaceFXEvaluatorRuntime : public IFaceFXEvaluator
+{
+	FFaceFXEvaluatorRuntime(UFaceFXCharacter* InOwner) : IFaceFXEvaluator(InOwner), Dataset(nullptr), Actor(FX_INVALID_ACTOR), FrameState(FX_INVALID_FRAMESTATE), CurrentAnimation(FX_INVALID_ANIMATION) {}
+
+	virtual ~FFaceFXEvaluatorRuntime();
+
+	virtual const TCHAR* GetName() const override
+	{
+		return TEXT("Runtime");
+	}
+
+	/**
+	* Creates the FaceFX actor handle and frame state for an actor asset
+	* @param InDataset The actor asset
+	* @param InActorTemplate The shared template of the actor asset
+	* @returns True if succeeded, else false
+	*/
+	virtual bool Load(const UFaceFXActor* InDataset, const FFaceFXActorTemplatePtr& InActorTemplate) override;
+
+	/** Destroys the FaceFX handles */
+	virtual void Unload() override;
+
+	virtual bool IsLoaded() const override
+	{
+		return Actor != FX_INVALID_ACTOR;
+	}
+
+	/**
+	* Gets the indicator if an animation can be played with the loaded actor. Uses the compatibility computed during cook if available
+	* @param Animation The animation to check
+	* @returns True if it can play the animation, else false
+	*/
+	virtual bool IsCanPlay(const UFaceFXAnim* Animation) const override;
+
+	/**
+	* Acquires the FaceFX animation handle from the animation cache
+	* @param Animation The animation to load
+	* @returns True if succeeded, false if the animation is not compatible with the loaded actor
+	*/
+	virtual bool LoadAnimation(const UFaceFXAnim* Animation) override;
+
+	/** Gives the animation handle back to the animation cache */
+	virtual void UnloadAnimation() override;
+
+	virtual bool IsAnimationLoaded() const override
+	{
+		return CurrentAnimation != FX_INVALID_ANIMATION;
+	}
+
+	virtual bool Play() override;
+
+	/**
+	* Starts the playback at a position. The FaceFX runtime anchors an animation at the first processed frame and offers no way to anchor it at another time.
+	* Hence a seek always processes two frames, the anchoring one at 0 and the one at the position
+	* @param Position The animation position in seconds
+	* @param OutIsAudioStart Indicator if the animation requested the start of the audio playback within the processed frames
+	* @returns True if succeeded, else false
+	*/
+	virtual bool PlayAt(float Position, bool& OutIsAudioStart) override;
+	virtual bool Stop() override;
+	virtual bool Pause(float Time) override;
+	virtual bool Resume(float Time) override;
+	virtual bool ProcessFrame(float Time, bool& OutIsAudioStart) override;
+	virtual bool GetTrackValues(float* OutTrackValues, int32 Num) override;
+	virtual bool ComputeBoneTransforms(FxBoneTransform* OutBoneTransforms, int32 Num) override;
+
+private:
+
+	/** The loaded actor asset */
+	const UFaceFXActor* Dataset;
+
+	/** The shared template of the loaded actor asset. Holds the bone set */
+	FFaceFXActorTemplatePtr ActorTemplate;
+
+	/** Callback for event notifications from within the FaceFX runtime. These are set within the source asset with a custom string being assigned */
+	static void OnFaceFXEvent(const FxEventFiringContext* Context, const char* Payload);
+
+	/** The FaceFX actor handle */
+	FxActor Actor;
+
+	/** The FaceFX frame state */
+	FxFrameState FrameState;
+
+	/** The handle of the loaded animation. Shared with other characters through the animation cache */
+	FxAnimation CurrentAnimation;
+};
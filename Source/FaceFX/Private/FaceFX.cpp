@@ -20,6 +20,10 @@
 
 #include "FaceFX.h"
 #include "FaceFXAllocator.h"
+#include "FaceFXAnimationCache.h"
+#include "FaceFXActorTemplate.h"
+#include "FaceFXAnimationSampler.h"
+#include "FaceFXCaptureActor.h"
 #include "FaceFXConfig.h"
 #include "FaceFXAnim.h"
 #include "Modules/ModuleManager.h"
@@ -88,7 +92,7 @@ FxAnimation FaceFX::LoadAnimation(const FFaceFXAnimData& AnimData)
 
 	FxAnimation Animation = FX_INVALID_ANIMATION;
 
-	FxResult Result = fxAnimationCreate(&AnimData.RawData[0], AnimData.RawData.Num(), FX_DATA_VALIDATION_ON, &Animation, &Allocator);
+	FxResult Result = fxAnimationCreate(&AnimData.RawData[0], AnimData.RawData.Num(), IsTrustedData(AnimData) ? FX_DATA_VALIDATION_OFF : FX_DATA_VALIDATION_ON, &Animation, &Allocator);
 
 	if (!FX_SUCCEEDED(Result))
 	{
@@ -102,32 +106,451 @@ FxAnimation FaceFX::LoadAnimation(const FFaceFXAnimData& AnimData)
 	return Animation;
 }
 
-bool FaceFX::GetAnimationBounds(const UFaceFXAnim* pAnimation, float& Start, float& End)
+bool FaceFX::IsTrustedData(const FFaceFXAnimData& AnimData)
+{
+	return FACEFX_TRUST_VALIDATED_DATA && AnimData.IsDataValidated();
+}
+
+bool FaceFX::IsTrustedData(const FFaceFXActorData& ActorData)
+{
+	return FACEFX_TRUST_VALIDATED_DATA && ActorData.IsDataValidated();
+}
+
+bool FaceFX::ComputeAnimationBounds(FFaceFXAnimData& AnimData)
 {
-	FxAnimation Animation = FaceFX::LoadAnimation(pAnimation->GetData());
+	AnimData.StartTime = 0.f;
+	AnimData.EndTime = 0.f;
+	AnimData.bIsBoundsSet = false;
+
+	FxAnimation Animation = LoadAnimation(AnimData);
 
 	if (Animation == FX_INVALID_ANIMATION)
 	{
 		return false;
 	}
 
-	FxResult BoundsResult = fxAnimationGetBounds(Animation, &Start, &End);
+	FxResult BoundsResult = fxAnimationGetBounds(Animation, &AnimData.StartTime, &AnimData.EndTime);
 
 	if (!FX_SUCCEEDED(BoundsResult))
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("FaceFX::GetAnimationBounds. FaceFX call <fxAnimationGetBounds> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(BoundsResult), *GetNameSafe(pAnimation));
+		UE_LOG(LogFaceFX, Error, TEXT("FaceFX::ComputeAnimationBounds. FaceFX call <fxAnimationGetBounds> failed. %s"), *FaceFX::GetFaceFXResultString(BoundsResult));
+		AnimData.StartTime = 0.f;
+		AnimData.EndTime = 0.f;
 	}
 
 	FxResult DestroyResult = fxAnimationDestroy(&Animation, nullptr, nullptr);
 
 	if (!FX_SUCCEEDED(DestroyResult))
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("FaceFX::GetAnimationBounds. FaceFX call <fxAnimationDestroy> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(DestroyResult), *GetNameSafe(pAnimation));
+		UE_LOG(LogFaceFX, Error, TEXT("FaceFX::ComputeAnimationBounds. FaceFX call <fxAnimationDestroy> failed. %s"), *FaceFX::GetFaceFXResultString(DestroyResult));
 	}
 
-	return (FX_SUCCEEDED(BoundsResult) && FX_SUCCEEDED(DestroyResult));
+	AnimData.bIsBoundsSet = FX_SUCCEEDED(BoundsResult);
+	return AnimData.bIsBoundsSet;
+}
+
+bool FaceFX::GetAnimationBounds(const UFaceFXAnim* pAnimation, float& Start, float& End)
+{
+	if (!pAnimation)
+	{
+		return false;
+	}
+
+	const FFaceFXAnimData& AnimData = pAnimation->GetData();
+
+	if (!AnimData.bIsBoundsSet)
+	{
+		UE_LOG(LogFaceFX, Warning, TEXT("FaceFX::GetAnimationBounds. Animation bounds missing. Please reimport the asset. Asset: %s"), *GetNameSafe(pAnimation));
+		return false;
+	}
+
+	Start = AnimData.StartTime;
+	End = AnimData.EndTime;
+	return true;
+}
+
+//the vectorized conversion loads the components directly out of the FaceFX structs
+typedef decltype(FxBoneTransform::rotation) FxBoneRotation;
+typedef decltype(FxBoneTransform::translation) FxBoneVector;
+static_assert(STRUCT_OFFSET(FxBoneRotation, y) == STRUCT_OFFSET(FxBoneRotation, x) + sizeof(float) && STRUCT_OFFSET(FxBoneRotation, z) == STRUCT_OFFSET(FxBoneRotation, x) + 2 * sizeof(float) && STRUCT_OFFSET(FxBoneRotation, w) == STRUCT_OFFSET(FxBoneRotation, x) + 3 * sizeof(float), "Unexpected FaceFX rotation layout");
+static_assert(STRUCT_OFFSET(FxBoneVector, y) == STRUCT_OFFSET(FxBoneVector, x) + sizeof(float) && STRUCT_OFFSET(FxBoneVector, z) == STRUCT_OFFSET(FxBoneVector, x) + 2 * sizeof(float), "Unexpected FaceFX vector layout");
+
+void FaceFX::ConvertBoneTransforms(const FxBoneTransform* RESTRICT Source, FTransform* RESTRICT Target, int32 Num)
+{
+#if ENABLE_VECTORIZED_TRANSFORM
+	// Revert rotation.y and translation.y to convert from FaceFX to UE4 coordinates.
+	const VectorRegister FlipY = MakeVectorRegister(1.f, -1.f, 1.f, 1.f);
+
+	for (int32 i=0; i<Num; ++i)
+	{
+		const FxBoneTransform& XForm = Source[i];
+
+		const VectorRegister Rotation = VectorMultiply(VectorLoad(&XForm.rotation.x), FlipY);
+		const VectorRegister Translation = VectorMultiply(VectorLoadFloat3_W0(&XForm.translation.x), FlipY);
+		const VectorRegister Scale = VectorLoadFloat3_W0(&XForm.scale.x);
+
+		Target[i] = FTransform(Rotation, Translation, Scale);
+	}
+#else
+	for (int32 i=0; i<Num; ++i)
+	{
+		const FxBoneTransform& XForm = Source[i];
+
+		// Revert rotation.y and translation.y to convert from FaceFX to UE4 coordinates.
+		Target[i].SetComponents(
+			FQuat(XForm.rotation.x, -XForm.rotation.y, XForm.rotation.z, XForm.rotation.w),
+			FVector(XForm.translation.x, -XForm.translation.y, XForm.translation.z),
+			FVector(XForm.scale.x, XForm.scale.y, XForm.scale.z));
+	}
+#endif //ENABLE_VECTORIZED_TRANSFORM
+}
+
+EFaceFXBlendMode FaceFX::GetBlendMode(const UFaceFXActor* Dataset)
+{
+	check(Dataset);
+	EFaceFXBlendMode BlendMode = EFaceFXBlendMode::Replace;
+	switch (Dataset->GetBlendMode())
+	{
+	case EFaceFXActorBlendMode::Global: BlendMode = UFaceFXConfig::Get().GetDefaultBlendMode(); break;
+	case EFaceFXActorBlendMode::Additive: BlendMode = EFaceFXBlendMode::Additive; break;
+	default: break;
+	}
+
+	return BlendMode;
+}
+
+FxBoneSetFlags FaceFX::GetBoneSetCreationFlags(EFaceFXBlendMode BlendMode, bool IsCompensateForForceFrontXAxis)
+{
+	FxBoneSetFlags BoneSetCreationFlags = BlendMode == EFaceFXBlendMode::Additive ? FX_BONESET_OFFSET_XFORMS_BIT : FX_BONESET_FULL_XFORMS;
+
+	if (IsCompensateForForceFrontXAxis)
+	{
+		BoneSetCreationFlags |= 0x80000000;
+	}
+
+	return BoneSetCreationFlags;
+}
+
+//the baked bone transforms are stored as plain floats
+static_assert(sizeof(FxBoneTransform) % sizeof(float) == 0, "FaceFX bone transforms are expected to consist of floats only");
+static constexpr int32 FloatsPerBoneTransform = sizeof(FxBoneTransform) / sizeof(float);
+
+void FaceFX::SampleBakedAnimation(const FFaceFXBakedAnimData& BakedData, float Time, float* RESTRICT OutTrackValues, FxBoneTransform* RESTRICT OutBoneTransforms)
+{
+	checkSlow(BakedData.IsValid());
+
+	const int32 NumTracks = BakedData.NumTracks;
+	const int32 NumChannels = BakedData.Channels.Num();
+	float* OutBoneValues = reinterpret_cast<float*>(OutBoneTransforms);
+
+	//constant channels only hold their value range
+	for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+	{
+		const float Value = BakedData.Channels[Channel].Min;
+
+		if (Channel < NumTracks)
+		{
+			OutTrackValues[Channel] = Value;
+		}
+		else
+		{
+			OutBoneValues[Channel - NumTracks] = Value;
+		}
+	}
+
+	//the last frame lies at the end of the animation and may be closer to its previous frame than the frame time
+	const int32 LastFrame = BakedData.NumFrames - 1;
+	const float LastIntervalStart = float(LastFrame - 1) / BakedData.SampleRate;
+	float FramePos = 0.f;
+
+	if (LastFrame > 0 && Time > LastIntervalStart)
+	{
+		const float LastInterval = BakedData.LastFrameTime - LastIntervalStart;
+		FramePos = LastInterval > 0.f ? FMath::Min(float(LastFrame - 1) + (Time - LastIntervalStart) / LastInterval, float(LastFrame)) : float(LastFrame);
+	}
+	else
+	{
+		FramePos = FMath::Max(Time * BakedData.SampleRate, 0.f);
+	}
+
+	const int32 Frame0 = FMath::FloorToInt(FramePos);
+	const int32 Frame1 = FMath::Min(Frame0 + 1, BakedData.NumFrames - 1);
+	const float Alpha = FramePos - Frame0;
+
+	const int32 NumAnimated = BakedData.AnimatedChannels.Num();
+	const uint16* Samples0 = BakedData.Samples.GetData() + Frame0 * NumAnimated;
+	const uint16* Samples1 = BakedData.Samples.GetData() + Frame1 * NumAnimated;
+
+	static const float Dequantize = 1.f / float(MAX_uint16);
+
+	for (int32 Idx = 0; Idx < NumAnimated; ++Idx)
+	{
+		const int32 Channel = BakedData.AnimatedChannels[Idx];
+		const FFaceFXBakedChannel& Range = BakedData.Channels[Channel];
+		const float Value = Range.Min + Range.Range * FMath::Lerp(float(Samples0[Idx]), float(Samples1[Idx]), Alpha) * Dequantize;
+
+		if (Channel < NumTracks)
+		{
+			OutTrackValues[Channel] = Value;
+		}
+		else
+		{
+			OutBoneValues[Channel - NumTracks] = Value;
+		}
+	}
+
+	//the interpolated and quantized rotations are not normalized anymore
+	const int32 NumBones = BakedData.NumBoneValues / FloatsPerBoneTransform;
+
+	for (int32 Idx = 0; Idx < NumBones; ++Idx)
+	{
+		FxBoneRotation& Rotation = OutBoneTransforms[Idx].rotation;
+		const float SizeSquared = Rotation.x * Rotation.x + Rotation.y * Rotation.y + Rotation.z * Rotation.z + Rotation.w * Rotation.w;
+
+		if (SizeSquared > SMALL_NUMBER)
+		{
+			const float Scale = FMath::InvSqrt(SizeSquared);
+			Rotation.x *= Scale;
+			Rotation.y *= Scale;
+			Rotation.z *= Scale;
+			Rotation.w *= Scale;
+		}
+	}
 }
 
+#if WITH_EDITOR
+
+bool FaceFX::BakeAnimation(const UFaceFXActor* Dataset, const FFaceFXAnimData& AnimData, float SampleRate, bool IsCompensateForForceFrontXAxis, FFaceFXBakedAnimData& OutBakedData)
+{
+	OutBakedData.Reset();
+
+	//the baked playback takes the audio start and the events from the timeline
+	if (!Dataset || !Dataset->IsValid() || !AnimData.IsValid() || !AnimData.bIsBoundsSet || !AnimData.HasTimeline() || Dataset->GetData().DataHash == 0 || SampleRate <= 0.f)
+	{
+		return false;
+	}
+
+	const FxBoneSetFlags BoneSetFlags = GetBoneSetCreationFlags(GetBlendMode(Dataset), IsCompensateForForceFrontXAxis);
+
+	//the template holds the bone set the characters play with
+	FFaceFXActorTemplatePtr ActorTemplate = FFaceFXActorTemplateCache::Get().Acquire(Dataset, BoneSetFlags);
+
+	if (!ActorTemplate.IsValid())
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FaceFX::BakeAnimation. Unable to load FaceFX actor data. Asset: %s"), *GetNameSafe(Dataset));
+		return false;
+	}
+
+	const FFaceFXActorData& ActorData = Dataset->GetData();
+	const int32 NumTracks = ActorTemplate->GetTrackIds().Num();
+	const int32 NumBones = ActorTemplate->HasBoneSet() ? ActorTemplate->GetBoneIds().Num() : 0;
+	const int32 NumBoneValues = NumBones * FloatsPerBoneTransform;
+	const int32 NumChannels = NumTracks + NumBoneValues;
+
+	FFaceFXCaptureActor CaptureActor;
+	FxResult Result = CaptureActor.Create(ActorData, AnimData);
+
+	//sample the frames and the midpoints in between them. The midpoints measure the error of the interpolation
+	const float Duration = AnimData.GetDuration();
+	const int32 NumFrames = FMath::CeilToInt(Duration * SampleRate) + 1;
+	const int32 NumSteps = (NumFrames - 1) * 2 + 1;
+
+	//frames lie on multiples of the frame time except for the last one which lies at the end of the animation
+	auto GetFrameTime = [SampleRate, Duration](int32 Frame)
+	{
+		return FMath::Min(float(Frame) / SampleRate, Duration);
+	};
+
+	auto GetStepTime = [&GetFrameTime](int32 Step)
+	{
+		const int32 Frame = Step / 2;
+		return Step % 2 == 0 ? GetFrameTime(Frame) : (GetFrameTime(Frame) + GetFrameTime(Frame + 1)) * .5f;
+	};
+
+	TArray<float> LiveValues;
+	LiveValues.SetNumUninitialized(NumSteps * NumChannels);
+
+	TArray<FxBoneTransform> BoneTransforms;
+	BoneTransforms.SetNumUninitialized(NumBones);
+
+	for (int32 Step = 0; Step < NumSteps && FX_SUCCEEDED(Result); ++Step)
+	{
+		//the first processed frame anchors the animation
+		const float Time = GetStepTime(Step);
+
+		bool IsAudioStart = false;
+		Result = CaptureActor.ProcessFrame(Time, IsAudioStart);
+
+		float* StepValues = LiveValues.GetData() + Step * NumChannels;
+
+		if (FX_SUCCEEDED(Result) && NumTracks > 0)
+		{
+			Result = fxFrameStateGetTrackValues(CaptureActor.FrameState, StepValues, (size_t)NumTracks);
+		}
+
+		if (FX_SUCCEEDED(Result) && NumBones > 0)
+		{
+			Result = ActorTemplate->ComputeBoneTransforms(CaptureActor.FrameState, BoneTransforms.GetData(), NumBones);
+
+			if (FX_SUCCEEDED(Result))
+			{
+				FMemory::Memcpy(StepValues + NumTracks, BoneTransforms.GetData(), NumBoneValues * sizeof(float));
+			}
+		}
+	}
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FaceFX::BakeAnimation. Unable to sample the animation. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+		return false;
+	}
+
+	OutBakedData.AnimDataHash = AnimData.DataHash;
+	OutBakedData.ActorDataHash = ActorData.DataHash;
+	OutBakedData.BoneSetFlags = BoneSetFlags;
+	OutBakedData.SampleRate = SampleRate;
+	OutBakedData.NumFrames = NumFrames;
+	OutBakedData.LastFrameTime = GetFrameTime(NumFrames - 1);
+	OutBakedData.NumTracks = NumTracks;
+	OutBakedData.NumBoneValues = NumBoneValues;
+
+	//the value range of each channel across the frames. Channels that barely change are stored as constants
+	OutBakedData.Channels.Reserve(NumChannels);
+
+	for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+	{
+		float Min = LiveValues[Channel];
+		float Max = Min;
+
+		for (int32 Frame = 1; Frame < NumFrames; ++Frame)
+		{
+			const float Value = LiveValues[Frame * 2 * NumChannels + Channel];
+			Min = FMath::Min(Min, Value);
+			Max = FMath::Max(Max, Value);
+		}
+
+		const bool IsConstant = Max - Min <= KINDA_SMALL_NUMBER * .01f;
+		OutBakedData.Channels.Add(FFaceFXBakedChannel(Min, IsConstant ? 0.f : Max - Min));
+
+		if (!IsConstant)
+		{
+			OutBakedData.AnimatedChannels.Add(Channel);
+		}
+	}
+
+	const int32 NumAnimated = OutBakedData.AnimatedChannels.Num();
+	OutBakedData.Samples.SetNumUninitialized(NumFrames * NumAnimated);
+
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		const float* FrameValues = LiveValues.GetData() + Frame * 2 * NumChannels;
+
+		for (int32 Idx = 0; Idx < NumAnimated; ++Idx)
+		{
+			const int32 Channel = OutBakedData.AnimatedChannels[Idx];
+			const FFaceFXBakedChannel& Range = OutBakedData.Channels[Channel];
+			const float Normalized = (FrameValues[Channel] - Range.Min) / Range.Range;
+
+			OutBakedData.Samples[Frame * NumAnimated + Idx] = (uint16)FMath::Clamp(FMath::RoundToInt(Normalized * MAX_uint16), 0, (int32)MAX_uint16);
+		}
+	}
+
+	//compare the baked against the live output at all sampled times
+	static const int32 RotationOffset = STRUCT_OFFSET(FxBoneTransform, rotation) / sizeof(float);
+	static const int32 TranslationOffset = STRUCT_OFFSET(FxBoneTransform, translation) / sizeof(float);
+	static const int32 ScaleOffset = STRUCT_OFFSET(FxBoneTransform, scale) / sizeof(float);
+
+	TArray<float> BakedValues;
+	BakedValues.SetNumUninitialized(NumChannels);
+
+	for (int32 Step = 0; Step < NumSteps; ++Step)
+	{
+		SampleBakedAnimation(OutBakedData, GetStepTime(Step), BakedValues.GetData(), reinterpret_cast<FxBoneTransform*>(BakedValues.GetData() + NumTracks));
+
+		const float* StepValues = LiveValues.GetData() + Step * NumChannels;
+
+		for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+		{
+			const float Error = FMath::Abs(BakedValues[Channel] - StepValues[Channel]);
+
+			if (Channel < NumTracks)
+			{
+				OutBakedData.MaxTrackError = FMath::Max(OutBakedData.MaxTrackError, Error);
+				continue;
+			}
+
+			const int32 BoneValueIdx = (Channel - NumTracks) % FloatsPerBoneTransform;
+
+			if (BoneValueIdx >= RotationOffset && BoneValueIdx < RotationOffset + 4)
+			{
+				OutBakedData.MaxRotationError = FMath::Max(OutBakedData.MaxRotationError, Error);
+			}
+			else if (BoneValueIdx >= TranslationOffset && BoneValueIdx < TranslationOffset + 3)
+			{
+				OutBakedData.MaxTranslationError = FMath::Max(OutBakedData.MaxTranslationError, Error);
+			}
+			else if (BoneValueIdx >= ScaleOffset && BoneValueIdx < ScaleOffset + 3)
+			{
+				OutBakedData.MaxScaleError = FMath::Max(OutBakedData.MaxScaleError, Error);
+			}
+		}
+	}
+
+	UE_LOG(LogFaceFX, Verbose, TEXT("FaceFX::BakeAnimation. Baked %i frames, %i of %i channels animated. Size: %i bytes (raw: %i bytes). Asset: %s"),
+		NumFrames, NumAnimated, NumChannels, OutBakedData.GetDataSize(), AnimData.RawData.Num(), *GetNameSafe(Dataset));
+
+	return true;
+}
+
+bool FaceFX::ComputeAnimationTimeline(const UFaceFXActor* Dataset, FFaceFXAnimData& AnimData)
+{
+	AnimData.Timeline.Reset();
+
+	if (!Dataset || !Dataset->IsValid() || !AnimData.IsValid() || !AnimData.bIsBoundsSet || AnimData.DataHash == 0)
+	{
+		return false;
+	}
+
+	FFaceFXCaptureActor CaptureActor;
+	FxResult Result = CaptureActor.Create(Dataset->GetData(), AnimData);
+
+	const float Duration = AnimData.GetDuration();
+	const int32 NumSteps = FMath::CeilToInt(Duration * FACEFX_TIMELINE_SAMPLE_RATE) + 1;
+	const float StepTime = 1.f / FACEFX_TIMELINE_SAMPLE_RATE;
+
+	float AudioStartTime = -1.f;
+
+	for (int32 Step = 0; Step < NumSteps && FX_SUCCEEDED(Result); ++Step)
+	{
+		//the first processed frame anchors the animation
+		const float Time = FMath::Min(Step * StepTime, Duration);
+
+		bool IsAudioStart = false;
+		Result = CaptureActor.ProcessFrame(Time, IsAudioStart);
+
+		if (IsAudioStart && AudioStartTime < 0.f)
+		{
+			AudioStartTime = Time;
+		}
+	}
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FaceFX::ComputeAnimationTimeline. Unable to sample the animation. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+		return false;
+	}
+
+	AnimData.Timeline.AnimDataHash = AnimData.DataHash;
+	AnimData.Timeline.AudioStartTime = AudioStartTime;
+	AnimData.Timeline.Events = MoveTemp(CaptureActor.EventCapture.Events);
+
+	UE_LOG(LogFaceFX, Verbose, TEXT("FaceFX::ComputeAnimationTimeline. Extracted %i events. Audio start: %.3f. Asset: %s"), AnimData.Timeline.Events.Num(), AudioStartTime, *GetNameSafe(Dataset));
+
+	return true;
+}
+
+#endif //WITH_EDITOR
+
 #if WITH_EDITOR
 void RegisterSettings()
 {
@@ -147,11 +570,13 @@ void UnregisterSettings()
 		SettingsModule->UnregisterSettings("Project", "Plugins", "FaceFX - Game");
 	}
 }
+#endif //WITH_EDITOR
 
 class FFaceFXModule : public FDefaultModuleImpl
 {
 	virtual void StartupModule() override
 	{
+#if WITH_EDITOR
 		if (!GIsEditor)
 		{
 			//Workaround for the circumstance that we have the anim graph node inside an editor only plugin and we can't load the plugin for editor AND uncooked but not during cooked
@@ -161,16 +586,21 @@ class FFaceFXModule : public FDefaultModuleImpl
 		}
 
 		RegisterSettings();
+#endif //WITH_EDITOR
 	}
 
 	virtual void ShutdownModule() override
 	{
+#if WITH_EDITOR
 		UnregisterSettings();
+#endif //WITH_EDITOR
+
+		//release the shared FaceFX handles while the FaceFX runtime is still around instead of during static destruction
+		FFaceFXAnimationSampler::Get().Empty();
+		FFaceFXAnimationCache::Get().Empty();
+		FFaceFXActorTemplateCache::Get().Empty();
 	}
 };
 IMPLEMENT_MODULE(FFaceFXModule, FaceFX);
-#else
-IMPLEMENT_MODULE(FDefaultModuleImpl, FaceFX);
-#endif
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
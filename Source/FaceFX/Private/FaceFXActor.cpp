@@ -20,6 +20,11 @@
 
 #include "FaceFXActor.h"
 #include "FaceFX.h"
+#include "FaceFXAllocator.h"
+#include "FaceFXActorTemplate.h"
+#include "FaceFXAnimationSampler.h"
+#include "FaceFXCaptureActor.h"
+#include "Interfaces/ITargetPlatform.h"
 
 #define LOCTEXT_NAMESPACE "FaceFX"
 
@@ -27,6 +32,36 @@ UFaceFXActor::UFaceFXActor(const class FObjectInitializer& PCIP) : Super(PCIP)
 {
 }
 
+void UFaceFXActor::PostLoad()
+{
+	Super::PostLoad();
+
+	//the hash is recomputed from the loaded bytes so the data validation is only skipped for data that did not change since it got validated.
+	//This also upgrades assets that were imported before the data hash got stored
+	ActorData.UpdateDataHash();
+	ActorData.UpdateIdLookup();
+}
+
+void UFaceFXActor::BeginDestroy()
+{
+	Super::BeginDestroy();
+
+	//the template cache is keyed by this asset. Drop the templates before the address can get reused
+	FFaceFXActorTemplateCache::Get().Purge(this);
+	FFaceFXAnimationSampler::Get().Purge(this);
+}
+
+#if WITH_EDITOR
+void UFaceFXActor::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	//renamed or reordered ids invalidate the lookup tables and the track names resolved by the templates
+	ActorData.UpdateIdLookup();
+	FFaceFXActorTemplateCache::Get().Purge(this);
+}
+#endif //WITH_EDITOR
+
 void UFaceFXActor::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
 {
 	Super::GetResourceSizeEx(CumulativeResourceSize);
@@ -177,10 +212,323 @@ void UFaceFXActor::GetDetails(FString& OutDetails) const
 	}
 }
 
+void UFaceFXActor::PreSave(const ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+
+	if (!IsTemplate() && TargetPlatform)
+	{
+		//cooking -> validate the data once so the runtime can skip the validation
+		ValidateData();
+
+#if FACEFX_USEANIMATIONLINKAGE
+		//precompute the compatibility with the linked animations
+		BuildAnimationCompatibility();
+
+		//precompute the tracks changed by the linked animations
+		BuildAnimationActiveTracks();
+#endif //FACEFX_USEANIMATIONLINKAGE
+	}
+	else
+	{
+		//the data may still change within the editor -> always perform the live validation and checks
+		ActorData.ValidatedDataHash = 0;
+		ActorData.AnimationCompatibility.Empty();
+	}
+}
+
+bool UFaceFXActor::ValidateData(FString* OutErrorMessage)
+{
+	ActorData.ValidatedDataHash = 0;
+
+	if (!ActorData.IsValid())
+	{
+		if (OutErrorMessage)
+		{
+			*OutErrorMessage = TEXT("No FaceFX actor data present");
+		}
+		return false;
+	}
+
+	ActorData.UpdateDataHash();
+
+	FxAllocationCallbacks Allocator = FFaceFXAllocator::CreateAllocator();
+
+	if (ActorData.BonesRawData.Num() > 0)
+	{
+		FxBoneSet BoneSet = FX_INVALID_BONESET;
+
+		FxResult Result = fxBoneSetCreate(&ActorData.BonesRawData[0], ActorData.BonesRawData.Num(), FX_DATA_VALIDATION_ON, FX_BONESET_FULL_XFORMS, &BoneSet, &Allocator);
+
+		if (!FX_SUCCEEDED(Result))
+		{
+			UE_LOG(LogFaceFX, Error, TEXT("UFaceFXActor::ValidateData. Unable to create FaceFX bone set. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(this));
+			if (OutErrorMessage)
+			{
+				*OutErrorMessage = FString::Printf(TEXT("Unable to create FaceFX bone set. %s"), *FaceFX::GetFaceFXResultString(Result));
+			}
+			return false;
+		}
+
+		Result = fxBoneSetDestroy(&BoneSet, nullptr, nullptr);
+
+		if (!FX_SUCCEEDED(Result))
+		{
+			UE_LOG(LogFaceFX, Error, TEXT("UFaceFXActor::ValidateData. FaceFX call <fxBoneSetDestroy> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(this));
+		}
+	}
+
+	FFaceFXCaptureActor CaptureActor;
+	const FxResult Result = CaptureActor.CreateActor(ActorData);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXActor::ValidateData. Unable to create FaceFX actor handle. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(this));
+		if (OutErrorMessage)
+		{
+			*OutErrorMessage = FString::Printf(TEXT("Unable to create FaceFX actor handle. %s"), *FaceFX::GetFaceFXResultString(Result));
+		}
+		return false;
+	}
+
+	ActorData.ValidatedDataHash = ActorData.DataHash;
+	return true;
+}
+
 #endif //WITH_EDITORONLY_DATA
 
 #if WITH_EDITORONLY_DATA && FACEFX_USEANIMATIONLINKAGE
 
+bool UFaceFXActor::BuildAnimationCompatibility()
+{
+	ActorData.AnimationCompatibility.Empty();
+
+	if (!ActorData.IsValid())
+	{
+		return false;
+	}
+
+	FFaceFXCaptureActor CaptureActor;
+	const FxResult Result = CaptureActor.CreateActor(ActorData);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXActor::BuildAnimationCompatibility. Unable to create FaceFX actor handle. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(this));
+		return false;
+	}
+
+	int32 IncompatibleCount = 0;
+
+	for (const UFaceFXAnim* Animation : Animations)
+	{
+		if (!Animation || !Animation->IsValid())
+		{
+			continue;
+		}
+
+		const FFaceFXAnimData& AnimData = Animation->GetData();
+
+		if (AnimData.DataHash == 0)
+		{
+			continue;
+		}
+
+		if (!FX_SUCCEEDED(CaptureActor.LoadAnimation(AnimData)))
+		{
+			continue;
+		}
+
+		const bool IsCompatible = FX_SUCCEEDED(fxActorCheckCompatibilityWithAnimation(CaptureActor.Actor, CaptureActor.Animation));
+		ActorData.AnimationCompatibility.Add(AnimData.DataHash, IsCompatible);
+
+		if (!IsCompatible)
+		{
+			UE_LOG(LogFaceFX, Warning, TEXT("UFaceFXActor::BuildAnimationCompatibility. Linked animation is not compatible. Asset: %s. Animation: %s"), *GetNameSafe(this), *GetNameSafe(Animation));
+			++IncompatibleCount;
+		}
+	}
+
+	UE_LOG(LogFaceFX, Verbose, TEXT("UFaceFXActor::BuildAnimationCompatibility. Checked %i animations, %i incompatible. Asset: %s"), ActorData.AnimationCompatibility.Num(), IncompatibleCount, *GetNameSafe(this));
+	return true;
+}
+
+/**
+* Samples a FaceFX animation and collects the tracks which differ from their values without any animation
+* @param CaptureActor The actor handle to sample with. Must not play any animation
+* @param RestValues The track values of the actor without any animation
+* @param AnimData The animation data to sample
+* @param OutTrackIndices The sorted indices of the changed tracks
+* @returns True if succeeded, else false
+*/
+static bool SampleAnimationActiveTracks(FFaceFXCaptureActor& CaptureActor, const TArray<float>& RestValues, const FFaceFXAnimData& AnimData, TArray<int32>& OutTrackIndices)
+{
+	const int32 NumTracks = RestValues.Num();
+
+	TArray<float> SampleValues;
+	SampleValues.AddUninitialized(NumTracks);
+
+	TBitArray<> ActiveTracks(false, NumTracks);
+
+	FxResult Result = CaptureActor.PlayAnimation(AnimData);
+
+	if (FX_SUCCEEDED(Result))
+	{
+		//the first processed frame anchors the animation. Sample the whole duration including both ends
+		const int32 NumSteps = FMath::Max(FMath::CeilToInt(AnimData.GetDuration() * FACEFX_ACTIVE_TRACKS_SAMPLE_RATE), 1);
+		const float StepSize = AnimData.GetDuration() / NumSteps;
+
+		for (int32 Step = 0; Step <= NumSteps && FX_SUCCEEDED(Result); ++Step)
+		{
+			bool IsAudioStart = false;
+			Result = CaptureActor.ProcessFrame(Step * StepSize, IsAudioStart);
+
+			if (FX_SUCCEEDED(Result))
+			{
+				Result = fxFrameStateGetTrackValues(CaptureActor.FrameState, SampleValues.GetData(), (size_t)NumTracks);
+			}
+
+			for (int32 TrackIdx = 0; FX_SUCCEEDED(Result) && TrackIdx < NumTracks; ++TrackIdx)
+			{
+				if (!FMath::IsNearlyEqual(SampleValues[TrackIdx], RestValues[TrackIdx], FACEFX_OUTPUT_EPSILON))
+				{
+					ActiveTracks[TrackIdx] = true;
+				}
+			}
+		}
+	}
+
+	CaptureActor.UnloadAnimation();
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		return false;
+	}
+
+	OutTrackIndices.Reset();
+	for (TConstSetBitIterator<> It(ActiveTracks); It; ++It)
+	{
+		OutTrackIndices.Add(It.GetIndex());
+	}
+	return true;
+}
+
+bool UFaceFXActor::BuildAnimationActiveTracks(const UFaceFXAnim* Animation)
+{
+	if (!ActorData.IsValid())
+	{
+		ActorData.AnimationActiveTracks.Empty();
+		return false;
+	}
+
+	ActorData.UpdateDataHash();
+
+	//collect the animations which are not sampled for the current data yet
+	TArray<const UFaceFXAnim*> PendingAnimations;
+
+	if (Animation)
+	{
+		PendingAnimations.Add(Animation);
+	}
+	else
+	{
+		//drop the entries of animations that are not linked anymore
+		TMap<uint32, FFaceFXAnimActiveTracks> LinkedActiveTracks;
+
+		for (const UFaceFXAnim* LinkedAnimation : Animations)
+		{
+			if (!LinkedAnimation || !LinkedAnimation->IsValid())
+			{
+				continue;
+			}
+
+			const FFaceFXAnimData& AnimData = LinkedAnimation->GetData();
+
+			if (const FFaceFXAnimActiveTracks* ActiveTracks = ActorData.AnimationActiveTracks.Find(AnimData.DataHash))
+			{
+				if (ActiveTracks->ActorDataHash == ActorData.DataHash)
+				{
+					LinkedActiveTracks.Add(AnimData.DataHash, *ActiveTracks);
+					continue;
+				}
+			}
+
+			PendingAnimations.Add(LinkedAnimation);
+		}
+
+		ActorData.AnimationActiveTracks = MoveTemp(LinkedActiveTracks);
+	}
+
+	if (PendingAnimations.Num() == 0)
+	{
+		return true;
+	}
+
+	FFaceFXCaptureActor CaptureActor;
+	FxResult Result = CaptureActor.CreateActor(ActorData);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXActor::BuildAnimationActiveTracks. Unable to create FaceFX actor handle. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(this));
+		return false;
+	}
+
+	size_t TrackCount = 0;
+	TArray<float> RestValues;
+
+	Result = fxActorGetTracks(CaptureActor.Actor, nullptr, &TrackCount);
+
+	if (FX_SUCCEEDED(Result) && TrackCount > 0)
+	{
+		//the values of all tracks without any animation playing
+		RestValues.AddUninitialized(TrackCount);
+
+		bool IsAudioStart = false;
+		Result = CaptureActor.ProcessFrame(0.f, IsAudioStart);
+
+		if (FX_SUCCEEDED(Result))
+		{
+			Result = fxFrameStateGetTrackValues(CaptureActor.FrameState, RestValues.GetData(), TrackCount);
+		}
+	}
+
+	int32 SampledCount = 0;
+
+	if (FX_SUCCEEDED(Result))
+	{
+		for (const UFaceFXAnim* PendingAnimation : PendingAnimations)
+		{
+			if (!PendingAnimation || !PendingAnimation->IsValid() || PendingAnimation->GetData().DataHash == 0)
+			{
+				continue;
+			}
+
+			const FFaceFXAnimData& AnimData = PendingAnimation->GetData();
+
+			FFaceFXAnimActiveTracks ActiveTracks;
+			ActiveTracks.ActorDataHash = ActorData.DataHash;
+
+			if (RestValues.Num() == 0 || SampleAnimationActiveTracks(CaptureActor, RestValues, AnimData, ActiveTracks.TrackIndices))
+			{
+				ActorData.AnimationActiveTracks.Add(AnimData.DataHash, MoveTemp(ActiveTracks));
+				++SampledCount;
+			}
+			else
+			{
+				//without an entry the characters process all tracks
+				ActorData.AnimationActiveTracks.Remove(AnimData.DataHash);
+				UE_LOG(LogFaceFX, Warning, TEXT("UFaceFXActor::BuildAnimationActiveTracks. Unable to sample animation. Asset: %s. Animation: %s"), *GetNameSafe(this), *GetNameSafe(PendingAnimation));
+			}
+		}
+	}
+	else
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXActor::BuildAnimationActiveTracks. Unable to retrieve the FaceFX rest track values. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(this));
+	}
+
+	UE_LOG(LogFaceFX, Verbose, TEXT("UFaceFXActor::BuildAnimationActiveTracks. Sampled %i of %i animations. Asset: %s"), SampledCount, PendingAnimations.Num(), *GetNameSafe(this));
+	return FX_SUCCEEDED(Result);
+}
+
 int32 UFaceFXActor::GetAnimationCount() const
 {
 	int32 Result = 0;
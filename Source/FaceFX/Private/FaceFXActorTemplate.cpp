@@ -0,0 +1,519 @@
+/*******************************************************************************
+  The MIT License (MIT)
+  Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "FaceFXActorTemplate.h"
+#include "FaceFX.h"
+#include "FaceFXActor.h"
+#include "FaceFXAnim.h"
+#include "FaceFXAllocator.h"
+#include "FaceFXAnimationCache.h"
+#include "Animation/Skeleton.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Materials/MaterialInterface.h"
+#include "Misc/ScopeLock.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Actor Templates"), STAT_FaceFXActorTemplates, STATGROUP_FACEFX);
+
+/** Event handler for the temporary actor handle used to retrieve the tracks */
+static void OnTemplateActorEvent(const FxEventFiringContext* Context, const char* Payload)
+{
+}
+
+FFaceFXActorTemplate::~FFaceFXActorTemplate()
+{
+	if (BoneSet)
+	{
+		FxResult Result = fxBoneSetDestroy(&BoneSet, nullptr, nullptr);
+
+		if (!FX_SUCCEEDED(Result))
+		{
+			UE_LOG(LogFaceFX, Error, TEXT("FFaceFXActorTemplate::~FFaceFXActorTemplate. FaceFX call <fxBoneSetDestroy> failed. %s"), *FaceFX::GetFaceFXResultString(Result));
+		}
+	}
+}
+
+bool FFaceFXActorTemplate::Init(FxBoneSetFlags InBoneSetFlags)
+{
+	const UFaceFXActor* Dataset = Asset.Get();
+	check(Dataset);
+
+	BoneSetFlags = InBoneSetFlags;
+
+	const FFaceFXActorData& ActorData = Dataset->GetData();
+
+	//make sure there is actor data
+	if (ActorData.ActorRawData.Num() == 0)
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXActorTemplate::Init. No FaceFX actor data present. Asset: %s"), *GetNameSafe(Dataset));
+		return false;
+	}
+
+	//data that passed the validation during cook does not need to be validated again
+	const bool IsTrustedData = FaceFX::IsTrustedData(ActorData);
+
+	FxAllocationCallbacks Allocator = FFaceFXAllocator::CreateAllocator();
+
+	//only create the bone set handle if there is bone set data
+	if (ActorData.BonesRawData.Num() > 0)
+	{
+		FxResult Result = fxBoneSetCreate(&ActorData.BonesRawData[0], ActorData.BonesRawData.Num(), IsTrustedData ? FX_DATA_VALIDATION_OFF : FX_DATA_VALIDATION_ON, BoneSetFlags, &BoneSet, &Allocator);
+
+		if (!FX_SUCCEEDED(Result))
+		{
+			UE_LOG(LogFaceFX, Error, TEXT("FFaceFXActorTemplate::Init. Unable to create FaceFX bone set. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+			return false;
+		}
+
+		if (Result == FX_WARNING_LEGACY_DATA_FORMAT)
+		{
+			UE_LOG(LogFaceFX, Verbose, TEXT("FFaceFXActorTemplate::Init. Loaded a legacy data format. Please recompile the content with the latest FaceFX Runtime compiler. Asset: %s"), *GetNameSafe(Dataset));
+		}
+
+		size_t XFormCount = 0;
+
+		Result = fxBoneSetGetBones(BoneSet, nullptr, &XFormCount);
+
+		if (!FX_SUCCEEDED(Result))
+		{
+			UE_LOG(LogFaceFX, Error, TEXT("FFaceFXActorTemplate::Init. Unable to retrieve FaceFX bone count. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+			return false;
+		}
+
+		if (XFormCount > 0)
+		{
+			BoneIds.AddUninitialized(XFormCount);
+
+			Result = fxBoneSetGetBones(BoneSet, BoneIds.GetData(), &XFormCount);
+
+			if (!FX_SUCCEEDED(Result))
+			{
+				UE_LOG(LogFaceFX, Error, TEXT("FFaceFXActorTemplate::Init. Unable to retrieve FaceFX bones. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+				return false;
+			}
+
+			//match bone ids with names from the .ffxids assets
+			BoneTransformIndices.Reserve(BoneIds.Num());
+
+			for (int32 BoneIdx = 0; BoneIdx < BoneIds.Num(); ++BoneIdx)
+			{
+				const uint64_t BoneIdHash = BoneIds[BoneIdx];
+
+				if (const FFaceFXIdData* BoneId = ActorData.FindId((uint64)BoneIdHash))
+				{
+					BoneNames.Add(BoneId->Name);
+
+					if (!BoneTransformIndices.Contains(BoneId->Name))
+					{
+						BoneTransformIndices.Add(BoneId->Name, BoneIdx);
+					}
+				}
+				else
+				{
+					UE_LOG(LogFaceFX, Warning, TEXT("FFaceFXActorTemplate::Init. Unknown bone id. %i. Asset: %s"), BoneIdHash, *GetNameSafe(Dataset));
+				}
+			}
+		}
+	}
+
+	//parse the actor data once to retrieve the tracks. Characters create their own actor handles without validation afterwards
+	FxEventCallbacks EventHandler;
+	EventHandler.pfnEventFired = OnTemplateActorEvent;
+	EventHandler.pUserData = nullptr;
+
+	FxActor Actor = FX_INVALID_ACTOR;
+
+	FxResult Result = CreateActor(ActorData, IsTrustedData, EventHandler, Actor);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXActorTemplate::Init. Unable to create FaceFX actor handle. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+		return false;
+	}
+
+	if (Result == FX_WARNING_LEGACY_DATA_FORMAT)
+	{
+		UE_LOG(LogFaceFX, Verbose, TEXT("FFaceFXActorTemplate::Init. Loaded a legacy data format. Please recompile the content with the latest FaceFX Runtime compiler. Asset: %s"), *GetNameSafe(Dataset));
+	}
+
+	size_t TrackCount = 0;
+
+	Result = fxActorGetTracks(Actor, nullptr, &TrackCount);
+
+	if (FX_SUCCEEDED(Result))
+	{
+		TrackIds.AddUninitialized(TrackCount);
+
+		Result = fxActorGetTracks(Actor, TrackIds.GetData(), &TrackCount);
+	}
+
+	if (FX_SUCCEEDED(Result))
+	{
+		ActorData.ResolveNames(TrackIds, TrackNames);
+
+		TrackIndices.Reserve(TrackIds.Num());
+
+		for (int32 TrackIdx = 0; TrackIdx < TrackIds.Num(); ++TrackIdx)
+		{
+			TrackIndices.FindOrAdd((uint64)TrackIds[TrackIdx], TrackIdx);
+		}
+	}
+	else
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXActorTemplate::Init. Unable to retrieve FaceFX tracks. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+	}
+
+	const bool IsSucceeded = FX_SUCCEEDED(Result);
+
+	Result = fxActorDestroy(&Actor, nullptr, nullptr);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXActorTemplate::Init. FaceFX call <fxActorDestroy> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(Dataset));
+	}
+
+	bIsDataValidated = IsSucceeded;
+	return IsSucceeded;
+}
+
+FxResult FFaceFXActorTemplate::CreateActor(const FFaceFXActorData& ActorData, bool IsDataValidated, FxEventCallbacks EventHandler, FxActor& OutActor, FxFrameState* OutFrameState)
+{
+	OutActor = FX_INVALID_ACTOR;
+
+	if (ActorData.ActorRawData.Num() == 0)
+	{
+		return FX_ERROR_INVALID_ARGUMENT;
+	}
+
+	FxAllocationCallbacks Allocator = FFaceFXAllocator::CreateAllocator();
+
+	const auto DataValidation = IsDataValidated ? FX_DATA_VALIDATION_OFF : FX_DATA_VALIDATION_ON;
+
+	FxResult Result = fxActorCreateWithEventHandler(&ActorData.ActorRawData[0], ActorData.ActorRawData.Num(), DataValidation, FACEFX_CHANNELS, &OutActor, &EventHandler, &Allocator);
+
+	if (FX_SUCCEEDED(Result) && OutFrameState)
+	{
+		const FxResult FrameStateResult = fxFrameStateCreate(OutActor, OutFrameState, &Allocator);
+
+		if (!FX_SUCCEEDED(FrameStateResult))
+		{
+			fxActorDestroy(&OutActor, nullptr, nullptr);
+			OutActor = FX_INVALID_ACTOR;
+			Result = FrameStateResult;
+		}
+	}
+
+	return Result;
+}
+
+bool FFaceFXActorTemplate::IsCompatible(const UFaceFXAnim* Animation, FxActor Actor) const
+{
+	const UFaceFXActor* Dataset = Asset.Get();
+
+	if (!Dataset || !Animation)
+	{
+		return false;
+	}
+
+	//use the result computed during cook if available
+	if (const bool* IsCompatible = Dataset->GetData().FindAnimationCompatibility(Animation->GetData()))
+	{
+		return *IsCompatible;
+	}
+
+	FxAnimation AnimHandle = FFaceFXAnimationCache::Get().Acquire(Animation);
+
+	FxActor CheckActor = Actor;
+
+	if (AnimHandle && !CheckActor)
+	{
+		FxEventCallbacks EventHandler;
+		EventHandler.pfnEventFired = OnTemplateActorEvent;
+		EventHandler.pUserData = nullptr;
+
+		CreateActor(Dataset->GetData(), bIsDataValidated, EventHandler, CheckActor);
+	}
+
+	const bool IsSucceeded = AnimHandle && CheckActor && FX_SUCCEEDED(fxActorCheckCompatibilityWithAnimation(CheckActor, AnimHandle));
+
+	if (CheckActor && CheckActor != Actor)
+	{
+		fxActorDestroy(&CheckActor, nullptr, nullptr);
+	}
+
+	//give back the animation so it isn't leaked.
+	FFaceFXAnimationCache::Get().Release(AnimHandle);
+
+	return IsSucceeded;
+}
+
+FxResult FFaceFXActorTemplate::ComputeBoneTransforms(FxFrameState FrameState, FxBoneTransform* OutBoneTransforms, int32 Num) const
+{
+	if (!BoneSet || Num <= 0)
+	{
+		return FX_SUCCESS;
+	}
+
+	FScopeLock Lock(&BoneSetLock);
+	return fxFrameStateComputeBoneTransforms(BoneSet, FrameState, OutBoneTransforms, (size_t)Num);
+}
+
+FFaceFXTrackBindings FFaceFXActorTemplate::GetMorphTargetBindings(const USkeletalMeshComponent* SkelMeshComp) const
+{
+	FFaceFXTrackBindings Result;
+
+	const UFaceFXActor* Dataset = Asset.Get();
+
+	if (!Dataset || !SkelMeshComp || !SkelMeshComp->SkeletalMesh)
+	{
+		return Result;
+	}
+
+	const FObjectKey MeshKey(SkelMeshComp->SkeletalMesh);
+
+	const TMap<FName, int32>& MorphTargetIndexMap = SkelMeshComp->SkeletalMesh->GetMorphTargetIndexMap();
+
+	//the mesh object stays the same when it gets reimported. Only reuse the bindings for the same set of morph targets
+	uint32 MorphTargetsHash = MorphTargetIndexMap.Num();
+
+	for (const TPair<FName, int32>& MorphTarget : MorphTargetIndexMap)
+	{
+		MorphTargetsHash = HashCombine(MorphTargetsHash, GetTypeHash(MorphTarget.Key));
+	}
+
+	FScopeLock Lock(&BindingsLock);
+
+	if (const FMorphTargetBindings* Bindings = MorphTargetBindings.Find(MeshKey))
+	{
+		if (Bindings->MorphTargetsHash == MorphTargetsHash)
+		{
+			return Bindings->Bindings;
+		}
+	}
+
+	if (MorphTargetIndexMap.Num() > 0)
+	{
+		Result.Names.Reserve(MorphTargetIndexMap.Num());
+		Result.Indices.Reserve(MorphTargetIndexMap.Num());
+
+		const int32 NumTracks = TrackNames.Num();
+
+		for (int32 TrackIndex = 0; TrackIndex < NumTracks; ++TrackIndex)
+		{
+			const FName& TrackName = TrackNames[TrackIndex];
+
+			if (!TrackName.IsNone() && MorphTargetIndexMap.Contains(TrackName))
+			{
+				Result.Names.Add(TrackName);
+				Result.Indices.Add((size_t)TrackIndex);
+
+				UE_LOG(LogFaceFX, Verbose, TEXT("FFaceFXActorTemplate::GetMorphTargetBindings. driving morph target named %s (Asset: %s)"), *TrackName.ToString(), *GetNameSafe(Dataset));
+			}
+		}
+	}
+
+	FMorphTargetBindings& Bindings = MorphTargetBindings.Add(MeshKey);
+	Bindings.MorphTargetsHash = MorphTargetsHash;
+	Bindings.Bindings = Result;
+
+	return Result;
+}
+
+FFaceFXTrackBindings FFaceFXActorTemplate::GetMaterialParameterBindings(const USkeletalMeshComponent* SkelMeshComp, const TArray<FName>& IgnoredTracks) const
+{
+	FFaceFXTrackBindings Result;
+
+	const UFaceFXActor* Dataset = Asset.Get();
+
+	if (!Dataset || !SkelMeshComp)
+	{
+		return Result;
+	}
+
+	const int32 NumMaterials = SkelMeshComp->GetNumMaterials();
+
+	TArray<FObjectKey> Materials;
+	Materials.Reserve(NumMaterials);
+
+	for (int32 MaterialIndex = 0; MaterialIndex < NumMaterials; ++MaterialIndex)
+	{
+		Materials.Add(FObjectKey(SkelMeshComp->GetMaterial(MaterialIndex)));
+	}
+
+	const FObjectKey MeshKey(SkelMeshComp->SkeletalMesh);
+
+	FScopeLock Lock(&BindingsLock);
+
+	//the materials may be overridden per component -> only reuse the bindings for the same set of materials
+	if (const FMaterialBindings* Bindings = MaterialParameterBindings.Find(MeshKey))
+	{
+		if (Bindings->Materials == Materials && Bindings->IgnoredTracks == IgnoredTracks)
+		{
+			return Bindings->Bindings;
+		}
+	}
+
+	Result.Names.Reserve(NumMaterials);
+	Result.Indices.Reserve(NumMaterials);
+
+	const TSet<FName> IgnoredTrackSet(IgnoredTracks);
+
+	const int32 NumTracks = TrackNames.Num();
+
+	for (int32 TrackIndex = 0; TrackIndex < NumTracks; ++TrackIndex)
+	{
+		const FName& TrackName = TrackNames[TrackIndex];
+
+		if (TrackName.IsNone() || IgnoredTrackSet.Contains(TrackName))
+		{
+			continue;
+		}
+
+		for (int32 MaterialIndex = 0; MaterialIndex < NumMaterials; ++MaterialIndex)
+		{
+			if (UMaterialInterface* Material = SkelMeshComp->GetMaterial(MaterialIndex))
+			{
+				float ParamterValue;
+
+				if (Material->GetScalarParameterValue(TrackName, ParamterValue))
+				{
+					Result.Names.Add(TrackName);
+					Result.Indices.Add((size_t)TrackIndex);
+
+					UE_LOG(LogFaceFX, Verbose, TEXT("FFaceFXActorTemplate::GetMaterialParameterBindings. driving material parameter named %s (Asset: %s)"), *TrackName.ToString(), *GetNameSafe(Dataset));
+
+					break;
+				}
+			}
+		}
+	}
+
+	FMaterialBindings& Bindings = MaterialParameterBindings.FindOrAdd(MeshKey);
+	Bindings.Materials = MoveTemp(Materials);
+	Bindings.IgnoredTracks = IgnoredTracks;
+	Bindings.Bindings = Result;
+
+	return Result;
+}
+
+FFaceFXTrackBindings FFaceFXActorTemplate::GetAnimationCurveBindings(const USkeleton* Skeleton, bool IsMorphTargets, bool IsMaterialParameters) const
+{
+	FFaceFXTrackBindings Result;
+
+	const UFaceFXActor* Dataset = Asset.Get();
+
+	if (!Dataset || !Skeleton || (!IsMorphTargets && !IsMaterialParameters))
+	{
+		return Result;
+	}
+
+	const TTuple<FObjectKey, bool, bool> Key(FObjectKey(Skeleton), IsMorphTargets, IsMaterialParameters);
+
+	FScopeLock Lock(&BindingsLock);
+
+	if (const FFaceFXTrackBindings* Bindings = AnimationCurveBindings.Find(Key))
+	{
+		return *Bindings;
+	}
+
+	const int32 NumTracks = TrackNames.Num();
+
+	for (int32 TrackIndex = 0; TrackIndex < NumTracks; ++TrackIndex)
+	{
+		const FName& TrackName = TrackNames[TrackIndex];
+
+		if (TrackName.IsNone())
+		{
+			continue;
+		}
+
+		//only curves that the engine applies onto morph targets or materials are of interest
+		if (const FCurveMetaData* MetaData = Skeleton->GetCurveMetaData(TrackName))
+		{
+			if ((IsMorphTargets && MetaData->Type.bMorphtarget) || (IsMaterialParameters && MetaData->Type.bMaterial))
+			{
+				Result.Names.Add(TrackName);
+				Result.Indices.Add((size_t)TrackIndex);
+
+				UE_LOG(LogFaceFX, Verbose, TEXT("FFaceFXActorTemplate::GetAnimationCurveBindings. driving animation curve named %s (Asset: %s)"), *TrackName.ToString(), *GetNameSafe(Dataset));
+			}
+		}
+	}
+
+	AnimationCurveBindings.Add(Key, Result);
+
+	return Result;
+}
+
+FFaceFXActorTemplateCache& FFaceFXActorTemplateCache::Get()
+{
+	static FFaceFXActorTemplateCache Instance;
+	return Instance;
+}
+
+FFaceFXActorTemplatePtr FFaceFXActorTemplateCache::Acquire(const UFaceFXActor* Asset, FxBoneSetFlags BoneSetFlags)
+{
+	if (!Asset)
+	{
+		return nullptr;
+	}
+
+	const TPair<const UFaceFXActor*, FxBoneSetFlags> Key(Asset, BoneSetFlags);
+
+	FScopeLock Lock(&CriticalSection);
+
+	if (const FFaceFXActorTemplatePtr* Template = Templates.Find(Key))
+	{
+		return *Template;
+	}
+
+	TSharedPtr<FFaceFXActorTemplate, ESPMode::ThreadSafe> Template = MakeShareable(new FFaceFXActorTemplate(Asset));
+
+	if (!Template->Init(BoneSetFlags))
+	{
+		return nullptr;
+	}
+
+	Templates.Add(Key, Template);
+	INC_DWORD_STAT(STAT_FaceFXActorTemplates);
+
+	return Template;
+}
+
+void FFaceFXActorTemplateCache::Purge(const UFaceFXActor* Asset)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	for (auto It = Templates.CreateIterator(); It; ++It)
+	{
+		if (It.Key().Key == Asset)
+		{
+			It.RemoveCurrent();
+			DEC_DWORD_STAT(STAT_FaceFXActorTemplates);
+		}
+	}
+}
+
+void FFaceFXActorTemplateCache::Empty()
+{
+	FScopeLock Lock(&CriticalSection);
+
+	DEC_DWORD_STAT_BY(STAT_FaceFXActorTemplates, Templates.Num());
+	Templates.Empty();
+}
@@ -20,6 +20,9 @@
 
 #include "FaceFXAnim.h"
 #include "FaceFX.h"
+#include "FaceFXAnimationCache.h"
+#include "FaceFXAnimationSampler.h"
+#include "FaceFXAllocator.h"
 #include "Sound/SoundWave.h"
 
 #if WITH_EDITORONLY_DATA
@@ -44,8 +47,93 @@ bool UFaceFXAnim::GetAbsoluteAudioPath(FString& OutResult) const
 	return false;
 }
 
+void UFaceFXAnim::PreSave(const ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+
+	if (!IsTemplate() && TargetPlatform)
+	{
+		//cooking -> validate the data once so the runtime can skip the validation
+		ValidateData();
+	}
+	else
+	{
+		//the data may still change within the editor -> always perform the live validation
+		AnimData.ValidatedDataHash = 0;
+	}
+}
+
+bool UFaceFXAnim::ValidateData(FString* OutErrorMessage)
+{
+	AnimData.ValidatedDataHash = 0;
+
+	if (!AnimData.IsValid())
+	{
+		if (OutErrorMessage)
+		{
+			*OutErrorMessage = TEXT("No FaceFX animation data present");
+		}
+		return false;
+	}
+
+	AnimData.UpdateDataHash();
+
+	FxAllocationCallbacks Allocator = FFaceFXAllocator::CreateAllocator();
+
+	FxAnimation Animation = FX_INVALID_ANIMATION;
+
+	FxResult Result = fxAnimationCreate(&AnimData.RawData[0], AnimData.RawData.Num(), FX_DATA_VALIDATION_ON, &Animation, &Allocator);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXAnim::ValidateData. Unable to create FaceFX animation. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(this));
+		if (OutErrorMessage)
+		{
+			*OutErrorMessage = FString::Printf(TEXT("Unable to create FaceFX animation. %s"), *FaceFX::GetFaceFXResultString(Result));
+		}
+		return false;
+	}
+
+	Result = fxAnimationDestroy(&Animation, nullptr, nullptr);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXAnim::ValidateData. FaceFX call <fxAnimationDestroy> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(this));
+	}
+
+	AnimData.ValidatedDataHash = AnimData.DataHash;
+	return true;
+}
+
 #endif //WITH_EDITORONLY_DATA
 
+void UFaceFXAnim::PostLoad()
+{
+	Super::PostLoad();
+
+	if (AnimData.IsValid() && !AnimData.bIsBoundsSet)
+	{
+		//upgrade assets that were imported before the bounds got stored within the asset data
+		if (FaceFX::ComputeAnimationBounds(AnimData))
+		{
+			UE_LOG(LogFaceFX, Log, TEXT("Upgraded FaceFXAnim bounds %s:%s/%s. Please re-save."), *AssetName, *(GetGroup().ToString()), *(GetName().ToString()));
+		}
+	}
+
+	//the hash is recomputed from the loaded bytes so the data validation is only skipped for data that did not change since it got validated.
+	//This also upgrades assets that were imported before the data hash got stored
+	AnimData.UpdateDataHash();
+}
+
+void UFaceFXAnim::BeginDestroy()
+{
+	Super::BeginDestroy();
+
+	//the cache is keyed by this asset. Drop the handles before the address can get reused
+	FFaceFXAnimationCache::Get().Purge(this);
+	FFaceFXAnimationSampler::Get().Purge(this);
+}
+
 void UFaceFXAnim::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
 {
 	Super::GetResourceSizeEx(CumulativeResourceSize);
@@ -115,6 +203,14 @@ void UFaceFXAnim::GetDetails(FString& OutDetails) const
 		OutDetails += LOCTEXT("DetailsAnimTimeDuration", "Duration: ").ToString() + FString::Printf(TEXT("%0.5fs\n"), Duration);
 	}
 
+	if (AnimData.IsBaked())
+	{
+		const FFaceFXBakedAnimData& BakedData = AnimData.BakedData;
+		OutDetails += LOCTEXT("DetailsAnimBaked", "Baked: ").ToString() + FString::Printf(TEXT("%i frames at %0.1f fps, %i bytes (raw: %i bytes)\n"), BakedData.NumFrames, BakedData.SampleRate, BakedData.GetDataSize(), AnimData.RawData.Num());
+		OutDetails += LOCTEXT("DetailsAnimBakedError", "Baked Max Error: ").ToString() + FString::Printf(TEXT("Tracks %0.5f, Translation %0.5f, Rotation %0.5f, Scale %0.5f\n"),
+			BakedData.MaxTrackError, BakedData.MaxTranslationError, BakedData.MaxRotationError, BakedData.MaxScaleError);
+	}
+
 	if (!IsValid())
 	{
 		OutDetails += TEXT("\n") + LOCTEXT("DetailsNotLoaded", "No FaceFX data").ToString();
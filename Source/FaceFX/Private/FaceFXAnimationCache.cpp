@@ -0,0 +1,250 @@
+/*******************************************************************************
+  The MIT License (MIT)
+  Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "FaceFXAnimationCache.h"
+#include "FaceFX.h"
+#include "FaceFXAnim.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Animation Cache Hits"), STAT_FaceFXAnimationCacheHits, STATGROUP_FACEFX);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Animation Cache Misses"), STAT_FaceFXAnimationCacheMisses, STATGROUP_FACEFX);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Animation Cache Evictions"), STAT_FaceFXAnimationCacheEvictions, STATGROUP_FACEFX);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Animation Cache Handles"), STAT_FaceFXAnimationCacheHandles, STATGROUP_FACEFX);
+DECLARE_MEMORY_STAT(TEXT("Animation Cache Memory"), STAT_FaceFXAnimationCacheMemory, STATGROUP_FACEFX);
+
+//The maximum number of animation assets without users whose handles are kept cached
+static int32 FaceFXAnimationCacheMaxUnused = 32;
+FAutoConsoleVariableRef CVarFaceFXAnimationCacheMaxUnused(TEXT("FaceFX.AnimationCache.MaxUnused"), FaceFXAnimationCacheMaxUnused, TEXT("Sets the maximum number of FaceFX animations without users whose runtime handles are kept cached. Default: 32"));
+
+//The maximum number of unused handles kept pooled per animation asset when not sharing handles
+static int32 FaceFXAnimationCacheMaxFreeHandles = 4;
+FAutoConsoleVariableRef CVarFaceFXAnimationCacheMaxFreeHandles(TEXT("FaceFX.AnimationCache.MaxFreeHandles"), FaceFXAnimationCacheMaxFreeHandles, TEXT("Sets the maximum number of unused FaceFX runtime handles kept pooled per animation when handles are not shared (FACEFX_SHARE_ANIMATION_HANDLES). Default: 4"));
+
+FFaceFXAnimationCache& FFaceFXAnimationCache::Get()
+{
+	static FFaceFXAnimationCache Instance;
+	return Instance;
+}
+
+FxAnimation FFaceFXAnimationCache::Acquire(const UFaceFXAnim* Animation)
+{
+	if (!Animation)
+	{
+		return FX_INVALID_ANIMATION;
+	}
+
+	FScopeLock Lock(&CriticalSection);
+
+	FEntry& Entry = Entries.FindOrAdd(Animation);
+
+	FxAnimation Handle = FX_INVALID_ANIMATION;
+
+#if FACEFX_SHARE_ANIMATION_HANDLES
+	if (Entry.Handles.Num() > 0)
+	{
+		Handle = Entry.Handles[0];
+	}
+#else
+	if (Entry.FreeHandles.Num() > 0)
+	{
+		Handle = Entry.FreeHandles.Pop(false);
+	}
+#endif //FACEFX_SHARE_ANIMATION_HANDLES
+
+	if (Handle)
+	{
+		INC_DWORD_STAT(STAT_FaceFXAnimationCacheHits);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_FaceFXAnimationCacheMisses);
+
+		Handle = FaceFX::LoadAnimation(Animation->GetData());
+
+		if (!Handle)
+		{
+			if (Entry.Handles.Num() == 0)
+			{
+				Entries.Remove(Animation);
+			}
+			return FX_INVALID_ANIMATION;
+		}
+
+		Entry.Handles.Add(Handle);
+		Entry.NumBytes = Animation->GetData().RawData.Num();
+		HandleOwners.Add(Handle, Animation);
+
+		INC_DWORD_STAT(STAT_FaceFXAnimationCacheHandles);
+		INC_MEMORY_STAT_BY(STAT_FaceFXAnimationCacheMemory, Entry.NumBytes);
+	}
+
+	++Entry.NumUsers;
+	Entry.LastUsed = ++UseCounter;
+
+	return Handle;
+}
+
+void FFaceFXAnimationCache::Release(FxAnimation& Handle)
+{
+	if (!Handle)
+	{
+		return;
+	}
+
+	FScopeLock Lock(&CriticalSection);
+
+	if (const UFaceFXAnim** Owner = HandleOwners.Find(Handle))
+	{
+		FEntry& Entry = Entries.FindChecked(*Owner);
+		checkf(Entry.NumUsers > 0, TEXT("Internal Error: FaceFX animation handle released more often than acquired."));
+
+		--Entry.NumUsers;
+		Entry.LastUsed = ++UseCounter;
+
+#if !FACEFX_SHARE_ANIMATION_HANDLES
+		if (Entry.FreeHandles.Num() < FMath::Max(FaceFXAnimationCacheMaxFreeHandles, 0))
+		{
+			Entry.FreeHandles.Push(Handle);
+		}
+		else
+		{
+			//the pool is full. Drop handles that were only needed during a peak of concurrent users
+			Entry.Handles.RemoveSingleSwap(Handle, false);
+			HandleOwners.Remove(Handle);
+			DestroyHandle(Handle, Entry.NumBytes);
+		}
+#endif //FACEFX_SHARE_ANIMATION_HANDLES
+
+		if (Entry.NumUsers == 0)
+		{
+			EvictUnusedEntries();
+		}
+	}
+	else if (FStaleHandle* StaleHandle = StaleHandles.Find(Handle))
+	{
+		//the asset got purged while we were using the handle
+		if (--StaleHandle->NumUsers <= 0)
+		{
+			DestroyHandle(Handle, StaleHandle->NumBytes);
+			StaleHandles.Remove(Handle);
+		}
+	}
+	else
+	{
+		UE_LOG(LogFaceFX, Warning, TEXT("FFaceFXAnimationCache::Release. Released unknown FaceFX animation handle."));
+	}
+
+	Handle = FX_INVALID_ANIMATION;
+}
+
+void FFaceFXAnimationCache::Purge(const UFaceFXAnim* Animation)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	if (const FEntry* Entry = Entries.Find(Animation))
+	{
+		RemoveHandles(*Entry);
+		Entries.Remove(Animation);
+	}
+}
+
+void FFaceFXAnimationCache::Empty()
+{
+	FScopeLock Lock(&CriticalSection);
+
+	for (const TPair<const UFaceFXAnim*, FEntry>& Entry : Entries)
+	{
+		RemoveHandles(Entry.Value);
+	}
+	Entries.Empty();
+}
+
+void FFaceFXAnimationCache::RemoveHandles(const FEntry& Entry)
+{
+	for (FxAnimation Handle : Entry.Handles)
+	{
+		HandleOwners.Remove(Handle);
+
+#if FACEFX_SHARE_ANIMATION_HANDLES
+		const int32 NumUsers = Entry.NumUsers;
+#else
+		const int32 NumUsers = Entry.FreeHandles.Contains(Handle) ? 0 : 1;
+#endif //FACEFX_SHARE_ANIMATION_HANDLES
+
+		if (NumUsers > 0)
+		{
+			StaleHandles.Add(Handle, FStaleHandle(NumUsers, Entry.NumBytes));
+		}
+		else
+		{
+			DestroyHandle(Handle, Entry.NumBytes);
+		}
+	}
+}
+
+void FFaceFXAnimationCache::DestroyHandle(FxAnimation Handle, uint32 NumBytes)
+{
+	FxResult Result = fxAnimationDestroy(&Handle, nullptr, nullptr);
+
+	if (!FX_SUCCEEDED(Result))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("FFaceFXAnimationCache::DestroyHandle. FaceFX call <fxAnimationDestroy> failed. %s"), *FaceFX::GetFaceFXResultString(Result));
+	}
+
+	DEC_DWORD_STAT(STAT_FaceFXAnimationCacheHandles);
+	DEC_MEMORY_STAT_BY(STAT_FaceFXAnimationCacheMemory, NumBytes);
+}
+
+void FFaceFXAnimationCache::EvictUnusedEntries()
+{
+	int32 NumUnused = 0;
+	for (const TPair<const UFaceFXAnim*, FEntry>& Entry : Entries)
+	{
+		if (Entry.Value.NumUsers == 0)
+		{
+			++NumUnused;
+		}
+	}
+
+	while (NumUnused > FMath::Max(FaceFXAnimationCacheMaxUnused, 0))
+	{
+		//find the least recently used entry
+		const UFaceFXAnim* EvictKey = nullptr;
+		uint64 EvictLastUsed = MAX_uint64;
+
+		for (const TPair<const UFaceFXAnim*, FEntry>& Entry : Entries)
+		{
+			if (Entry.Value.NumUsers == 0 && Entry.Value.LastUsed < EvictLastUsed)
+			{
+				EvictKey = Entry.Key;
+				EvictLastUsed = Entry.Value.LastUsed;
+			}
+		}
+
+		check(EvictKey);
+
+		RemoveHandles(Entries.FindChecked(EvictKey));
+		Entries.Remove(EvictKey);
+		--NumUnused;
+
+		INC_DWORD_STAT(STAT_FaceFXAnimationCacheEvictions);
+	}
+}
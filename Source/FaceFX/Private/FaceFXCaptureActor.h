@@ -0,0 +1,181 @@
+/*******************************************************************************
+The MIT License (MIT)
+Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#pragma once
+
+#include "FaceFX.h"
+#include "FaceFXData.h"
+#include "FaceFXActorTemplate.h"
+
+/** The events fired while sampling an animation against a temporary actor handle */
+struct FFaceFXEventCapture
+{
+	TArray<FFaceFXTimelineEvent> Events;
+	float Time = 0.f;
+};
+
+/**
+* A temporary actor handle used to validate, check and sample data outside of any character. Plays a single animation at a time and captures the events it fires.
+* Releases all FaceFX handles on destruction
+*/
+struct FFaceFXCaptureActor
+{
+	FFaceFXEventCapture EventCapture;
+	FxActor Actor = FX_INVALID_ACTOR;
+	FxFrameState FrameState = FX_INVALID_FRAMESTATE;
+	FxAnimation Animation = FX_INVALID_ANIMATION;
+
+	/** The actor time in seconds between the last processed frame and the anchor of the next played animation */
+	static constexpr float AnchorGap = 1.f;
+
+	FFaceFXCaptureActor() {}
+	FFaceFXCaptureActor(const FFaceFXCaptureActor&) = delete;
+	FFaceFXCaptureActor& operator=(const FFaceFXCaptureActor&) = delete;
+
+	~FFaceFXCaptureActor()
+	{
+		UnloadAnimation();
+
+		if (FrameState != FX_INVALID_FRAMESTATE)
+		{
+			fxFrameStateDestroy(&FrameState);
+		}
+
+		if (Actor != FX_INVALID_ACTOR)
+		{
+			fxActorDestroy(&Actor, nullptr, nullptr);
+		}
+	}
+
+	/**
+	* Creates the actor handle with data validation and its frame state
+	* @param ActorData The actor to create the handle for
+	* @returns The FaceFX result
+	*/
+	FxResult CreateActor(const FFaceFXActorData& ActorData)
+	{
+		FxEventCallbacks EventHandler;
+		EventHandler.pfnEventFired = OnEvent;
+		EventHandler.pUserData = &EventCapture;
+
+		return FFaceFXActorTemplate::CreateActor(ActorData, false, EventHandler, Actor, &FrameState);
+	}
+
+	/**
+	* Creates the actor handle and starts the playback of an animation. The first processed frame anchors the animation
+	* @param ActorData The actor to play the animation with
+	* @param AnimData The animation to play
+	* @returns The FaceFX result
+	*/
+	FxResult Create(const FFaceFXActorData& ActorData, const FFaceFXAnimData& AnimData)
+	{
+		const FxResult Result = CreateActor(ActorData);
+		return FX_SUCCEEDED(Result) ? PlayAnimation(AnimData) : Result;
+	}
+
+	/**
+	* Loads an animation without playing it. Replaces the previously loaded animation
+	* @param AnimData The animation to load
+	* @returns The FaceFX result
+	*/
+	FxResult LoadAnimation(const FFaceFXAnimData& AnimData)
+	{
+		UnloadAnimation();
+
+		Animation = FaceFX::LoadAnimation(AnimData);
+		return Animation != FX_INVALID_ANIMATION ? FX_SUCCESS : FX_ERROR_INVALID_ARGUMENT;
+	}
+
+	/**
+	* Loads an animation and starts its playback. Replaces the previously loaded animation and drops the captured events. The next processed frame anchors the animation
+	* @param AnimData The animation to play
+	* @returns The FaceFX result
+	*/
+	FxResult PlayAnimation(const FFaceFXAnimData& AnimData)
+	{
+		EventCapture.Events.Reset();
+		AnchorTime = -1.f;
+
+		const FxResult Result = LoadAnimation(AnimData);
+		return FX_SUCCEEDED(Result) ? fxActorPlayAnimation(Actor, Animation, nullptr) : Result;
+	}
+
+	/** Stops the playback and releases the loaded animation */
+	void UnloadAnimation()
+	{
+		if (Animation != FX_INVALID_ANIMATION)
+		{
+			fxActorStopAnimation(Actor, FX_CHANNEL_ANY);
+			fxAnimationDestroy(&Animation, nullptr, nullptr);
+		}
+	}
+
+	/**
+	* Processes the frame at an animation time. The fired events get captured with that time.
+	* The first processed frame of each animation anchors it after the previously processed frames, so the actor time never goes backwards
+	* @param Time The animation time in seconds
+	* @param OutIsAudioStart Indicator if the animation requested the start of the audio playback within this frame
+	* @returns The FaceFX result
+	*/
+	FxResult ProcessFrame(float Time, bool& OutIsAudioStart)
+	{
+		if (AnchorTime < 0.f)
+		{
+			AnchorTime = LastActorTime < 0.f ? 0.f : LastActorTime + AnchorGap;
+		}
+
+		EventCapture.Time = Time;
+		LastActorTime = AnchorTime + Time;
+
+		FxResult Result = fxActorProcessFrame(Actor, FrameState, LastActorTime);
+
+		FxChannelFlags ChannelFlags[FACEFX_CHANNELS];
+
+		if (FX_SUCCEEDED(Result))
+		{
+			Result = fxFrameStateGetChannelFlags(FrameState, ChannelFlags, FACEFX_CHANNELS);
+		}
+
+		OutIsAudioStart = FX_SUCCEEDED(Result) && (ChannelFlags[0] & FX_CHANNEL_START_AUDIO_BIT) != 0;
+		return Result;
+	}
+
+private:
+
+	/** The actor time the current animation got anchored at. Negative until the first processed frame */
+	float AnchorTime = -1.f;
+
+	/** The actor time of the last processed frame. Negative until the first processed frame */
+	float LastActorTime = -1.f;
+
+	/** Event handler of the actor handle */
+	static void OnEvent(const FxEventFiringContext* Context, const char* Payload)
+	{
+		if (FFaceFXEventCapture* Capture = static_cast<FFaceFXEventCapture*>(Context->pUserData))
+		{
+			FFaceFXTimelineEvent& Event = Capture->Events[Capture->Events.AddDefaulted()];
+			Event.Time = Capture->Time;
+			Event.ChannelIndex = (int32)Context->channelIndex;
+			Event.ChannelTime = Context->channelTime;
+			Event.EventTime = Context->eventTime;
+			Event.Payload = ANSI_TO_TCHAR(Payload);
+		}
+	}
+};
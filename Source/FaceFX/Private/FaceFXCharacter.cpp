@@ -20,74 +20,175 @@
 
 #include "FaceFXCharacter.h"
 #include "FaceFX.h"
-#include "FaceFXAllocator.h"
 #include "FaceFXActor.h"
+#include "FaceFXAnimationSampler.h"
 #include "FaceFXBlueprintLibrary.h"
+#include "FaceFXCharacterSubsystem.h"
 #include "Audio/FaceFXAudio.h"
+#include "Evaluation/FaceFXEvaluator.h"
 #include "GameFramework/Actor.h"
 #include "Animation/FaceFXComponent.h"
 #include "Engine/StreamableManager.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "HAL/IConsoleManager.h"
 
 DECLARE_CYCLE_STAT(TEXT("Tick Character"), STAT_FaceFXTick, STATGROUP_FACEFX);
-DECLARE_CYCLE_STAT(TEXT("Update Transforms"), STAT_FaceFXUpdateTransforms, STATGROUP_FACEFX);
+DECLARE_CYCLE_STAT(TEXT("Publish Output"), STAT_FaceFXPublishOutput, STATGROUP_FACEFX);
 DECLARE_CYCLE_STAT(TEXT("Load Assets"), STAT_FaceFXLoad, STATGROUP_FACEFX);
 DECLARE_CYCLE_STAT(TEXT("Play"), STAT_FaceFXPlay, STATGROUP_FACEFX);
 DECLARE_CYCLE_STAT(TEXT("Broadcast Audio Events"), STAT_FaceFXAudioEvents, STATGROUP_FACEFX);
 DECLARE_CYCLE_STAT(TEXT("Broadcast Anim Events"), STAT_FaceFXAnimEvents, STATGROUP_FACEFX);
 DECLARE_CYCLE_STAT(TEXT("Process Morph Targets"), STAT_FaceFXProcessMorphTargets, STATGROUP_FACEFX);
 DECLARE_CYCLE_STAT(TEXT("Process Material Parameters"), STAT_FaceFXProcessMaterialParameters, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Material Parameters - Written"), STAT_FaceFXMaterialParametersWritten, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Material Parameters - Skipped"), STAT_FaceFXMaterialParametersSkipped, STATGROUP_FACEFX);
+DECLARE_CYCLE_STAT(TEXT("Process Custom Primitive Data"), STAT_FaceFXProcessCustomPrimitiveData, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Custom Primitive Data - Updates"), STAT_FaceFXCustomPrimitiveDataUpdates, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Morph Targets - Written"), STAT_FaceFXMorphTargetsWritten, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Morph Targets - Skipped"), STAT_FaceFXMorphTargetsSkipped, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Unchanged Outputs"), STAT_FaceFXUnchangedOutputs, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Redundant Evaluations Avoided"), STAT_FaceFXRedundantEvaluations, STATGROUP_FACEFX);
+
+//The minimal change of a FaceFX output value that counts as a change
+static float FaceFXOutputEpsilon = FACEFX_OUTPUT_EPSILON;
+FAutoConsoleVariableRef CVarFaceFXOutputEpsilon(TEXT("FaceFX.Output.Epsilon"), FaceFXOutputEpsilon, TEXT("Sets the minimal change of a FaceFX track value or bone transform component that gets written into morph targets, material parameters and the published outputs. 0=Write every change. Default: 0.0001"));
+
+//Indicator if forward jumps of playing characters fire the events they skip
+static int32 FaceFXJumpCatchUpEvents = 0;
+FAutoConsoleVariableRef CVarFaceFXJumpCatchUpEvents(TEXT("FaceFX.Jump.CatchUpEvents"), FaceFXJumpCatchUpEvents, TEXT("Sets if forward jumps of playing FaceFX characters fire the events skipped in between. Looked up within the animation timeline extracted during import. 0=Skip, 1=Fire. Default: 0"));
 
 namespace
 {
-	EFaceFXBlendMode GetBlendMode(const UFaceFXActor* Dataset)
-	{
-		check(Dataset);
-		EFaceFXBlendMode BlendMode = EFaceFXBlendMode::Replace;
-		switch (Dataset->GetBlendMode())
+	/**
+	* Gets if two sets of values are equal within the output epsilon
+	* @param A The first values
+	* @param B The second values
+	* @param Num The number of values
+	* @returns True if equal, else false
+	*/
+	inline bool IsOutputEqual(const float* A, const float* B, int32 Num)
+	{
+		for (int32 Idx = 0; Idx < Num; ++Idx)
 		{
-		case EFaceFXActorBlendMode::Global: BlendMode = UFaceFXConfig::Get().GetDefaultBlendMode(); break;
-		case EFaceFXActorBlendMode::Additive: BlendMode = EFaceFXBlendMode::Additive; break;
-		default: break;
+			if (!FMath::IsNearlyEqual(A[Idx], B[Idx], FaceFXOutputEpsilon))
+			{
+				return false;
+			}
 		}
-
-		return BlendMode;
+		return true;
 	}
 
-	FxBoneSetFlags GetBoneSetCreationFlags(EFaceFXBlendMode BlendMode, bool IsCompensateForForceFrontXAxis)
+	/**
+	* Gets if two sets of FaceFX bone transforms are equal within the output epsilon. Compares the translation, rotation and scale per component
+	* @param A The first transforms
+	* @param B The second transforms
+	* @param Num The number of transforms
+	* @returns True if equal, else false
+	*/
+	inline bool IsOutputEqual(const FxBoneTransform* A, const FxBoneTransform* B, int32 Num)
 	{
-		FxBoneSetFlags BoneSetCreationFlags = BlendMode == EFaceFXBlendMode::Additive ? FX_BONESET_OFFSET_XFORMS_BIT : FX_BONESET_FULL_XFORMS;
-
-		if (IsCompensateForForceFrontXAxis)
+		for (int32 Idx = 0; Idx < Num; ++Idx)
 		{
-			BoneSetCreationFlags |= 0x80000000;
+			const FxBoneTransform& TransformA = A[Idx];
+			const FxBoneTransform& TransformB = B[Idx];
+
+			if (!FMath::IsNearlyEqual(TransformA.translation.x, TransformB.translation.x, FaceFXOutputEpsilon) ||
+				!FMath::IsNearlyEqual(TransformA.translation.y, TransformB.translation.y, FaceFXOutputEpsilon) ||
+				!FMath::IsNearlyEqual(TransformA.translation.z, TransformB.translation.z, FaceFXOutputEpsilon) ||
+				!FMath::IsNearlyEqual(TransformA.rotation.x, TransformB.rotation.x, FaceFXOutputEpsilon) ||
+				!FMath::IsNearlyEqual(TransformA.rotation.y, TransformB.rotation.y, FaceFXOutputEpsilon) ||
+				!FMath::IsNearlyEqual(TransformA.rotation.z, TransformB.rotation.z, FaceFXOutputEpsilon) ||
+				!FMath::IsNearlyEqual(TransformA.rotation.w, TransformB.rotation.w, FaceFXOutputEpsilon) ||
+				!FMath::IsNearlyEqual(TransformA.scale.x, TransformB.scale.x, FaceFXOutputEpsilon) ||
+				!FMath::IsNearlyEqual(TransformA.scale.y, TransformB.scale.y, FaceFXOutputEpsilon) ||
+				!FMath::IsNearlyEqual(TransformA.scale.z, TransformB.scale.z, FaceFXOutputEpsilon))
+			{
+				return false;
+			}
 		}
+		return true;
+	}
+
+	/**
+	* Gets if two sets of transforms are equal within the output epsilon. Compares the translation, rotation and scale per component and skips any padding
+	* @param A The first transforms
+	* @param B The second transforms
+	* @param Num The number of transforms
+	* @returns True if equal, else false
+	*/
+	inline bool IsOutputEqual(const FTransform* A, const FTransform* B, int32 Num)
+	{
+		for (int32 Idx = 0; Idx < Num; ++Idx)
+		{
+			const FTransform& TransformA = A[Idx];
+			const FTransform& TransformB = B[Idx];
+
+			if (!TransformA.GetTranslation().Equals(TransformB.GetTranslation(), FaceFXOutputEpsilon) ||
+				!TransformA.GetScale3D().Equals(TransformB.GetScale3D(), FaceFXOutputEpsilon))
+			{
+				return false;
+			}
+
+			const FQuat RotationA = TransformA.GetRotation();
+			const FQuat RotationB = TransformB.GetRotation();
 
-		return BoneSetCreationFlags;
+			if (!FMath::IsNearlyEqual(RotationA.X, RotationB.X, FaceFXOutputEpsilon) ||
+				!FMath::IsNearlyEqual(RotationA.Y, RotationB.Y, FaceFXOutputEpsilon) ||
+				!FMath::IsNearlyEqual(RotationA.Z, RotationB.Z, FaceFXOutputEpsilon) ||
+				!FMath::IsNearlyEqual(RotationA.W, RotationB.W, FaceFXOutputEpsilon))
+			{
+				return false;
+			}
+		}
+		return true;
 	}
 }
 
 UFaceFXCharacter::FOnFaceFXCharacterPlayAssetIncompatibleSignature UFaceFXCharacter::OnFaceFXCharacterPlayAssetIncompatible;
 
 UFaceFXCharacter::UFaceFXCharacter(const class FObjectInitializer& PCIP) : Super(PCIP),
-	Actor(FX_INVALID_ACTOR),
-	FrameState(FX_INVALID_FRAMESTATE),
-	BoneSet(FX_INVALID_BONESET),
-	CurrentAnimation(FX_INVALID_ANIMATION),
+	PendingActiveTracksVersion(0),
+	NumPendingResetWrites(0),
+	CurrentLODMaskIdx(INDEX_NONE),
+	LODMasksVersion(0),
+	PendingJumpPosition(0.f),
+	PendingJumpOrigin(0.f),
+	PendingJumpFrame(0),
+	LastEvaluationFrame(0),
+	SubsystemIndex(INDEX_NONE),
+	NumInterpolationKeys(0),
+	EvaluationInterval(0.f),
+	TimeSinceEvaluation(0.f),
+	EvaluationCost(0.f),
+	NumDeferredTicks(0),
 	CurrentTime(0.f),
 	CurrentAnimProgress(0.f),
 	CurrentAnimDuration(0.f),
 	AnimPlaybackState(EPlaybackState::Stopped),
-	bIsDirty(true),
 	bIsLooping(false),
 	bCanPlay(true),
 	bCompensatedForForceFrontXAxis(false),
 	bDisabledMorphTargets(false),
 	bDisabledMaterialParameters(false)
 	,bIgnoreEvents(false)
-#if WITH_EDITOR
-	,LastFrameNumber(0)
-#endif
+	,bDeferEvents(false)
+	,bIsGameThreadWorkPending(false)
+	,bIsAudioStartPending(false)
+	,bIsAudioStartDetected(false)
+	,bIsAnimEndPending(false)
+	,bIsOutputPending(false)
+	,bInterpolateOutput(false)
+	,bFreezeOutput(false)
+	,bIsInterpolationKeysEqual(false)
+	,bIsInterpolatedOutputSettled(false)
+	,bForceEvaluation(true)
+	,bDeferEvaluation(false)
+	,bIsActiveTracksPending(false)
+	,bIsAllOutputsActive(true)
+	,bIsScrubbed(false)
+	,bIsJumpPending(false)
+	,bIsJumpEvaluatedPending(false)
 {
 	if (!IsTemplate())
 	{
@@ -113,52 +214,61 @@ void UFaceFXCharacter::BeginDestroy()
 #endif
 }
 
-bool UFaceFXCharacter::TickUntil(float Duration, bool& OutAudioStarted, bool IgnoreEvents)
+bool UFaceFXCharacter::EvaluateJump(bool& OutIsAudioStart)
 {
-	if (!bCanPlay || Duration < 0.f)
-	{
-		return false;
-	}
-
-	CurrentTime = Duration;
-	CurrentAnimProgress = 0.F;
-
-	//The steps to perform
-	static const float TickSteps = 0.1f;
+	bIsJumpPending = false;
+	bIsJumpEvaluatedPending = true;
 
+	//explicitly stop and start the playback again at the jump position. The events up to the jump position are skipped
 	const bool IgnoreEventsPrev = bIgnoreEvents;
-	bIgnoreEvents = IgnoreEvents;
+	bIgnoreEvents = true;
 
-	FxResult ProcessZeroResult = fxActorProcessFrame(Actor, FrameState, 0.f);
-	const bool bIsAudioStartedAtZero = IsAudioStarted();
-	FxResult Result = fxActorProcessFrame(Actor, FrameState, CurrentTime);
+	bool IsAudioStartedAtJump = false;
+	bool IsProcessed = Evaluator->Stop() && Evaluator->PlayAt(PendingJumpPosition, IsAudioStartedAtJump);
 
 	bIgnoreEvents = IgnoreEventsPrev;
 
-	if (!FX_SUCCEEDED(ProcessZeroResult) || !FX_SUCCEEDED(Result))
+	if (!IsProcessed)
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::TickUntil. FaceFX call <fxActorProcessFrame> failed. (zero: %s) %s. Asset: %s"),
-		       *FaceFX::GetFaceFXResultString(ProcessZeroResult), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::EvaluateJump. Unable to restart the animation. Evaluator: %s. Asset: %s"), Evaluator->GetName(), *GetNameSafe(FaceFXActor));
 		return false;
 	}
 
-	Result = fxFrameStateGetTrackValues(FrameState, &TrackValues[0], (size_t)TrackValues.Num());
+	OutIsAudioStart = IsAudioStartedAtJump;
 
-	if (!FX_SUCCEEDED(Result))
+	if (CurrentAnim && CurrentAnim->GetData().HasTimeline())
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::TickUntil. FaceFX call <fxFrameStateGetTrackValues> failed. (zero: %s) %s. Asset: %s"),
-		       *FaceFX::GetFaceFXResultString(ProcessZeroResult), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
-		return false;
+		//look up the audio state and the skipped events within the timeline extracted during import
+		const FFaceFXAnimTimeline& Timeline = CurrentAnim->GetData().Timeline;
+		OutIsAudioStart = Timeline.IsAudioStarted(PendingJumpPosition);
+
+		if (FaceFXJumpCatchUpEvents && IsPlaying() && PendingJumpPosition > PendingJumpOrigin)
+		{
+			const int32 LastEventIdx = FFaceFXAnimTimeline::FindNextEvent(Timeline.Events, PendingJumpPosition);
+
+			for (int32 EventIdx = FFaceFXAnimTimeline::FindNextEvent(Timeline.Events, PendingJumpOrigin); EventIdx < LastEventIdx; ++EventIdx)
+			{
+				const FFaceFXTimelineEvent& Event = Timeline.Events[EventIdx];
+				HandleAnimationEvent(Event.ChannelIndex, Event.ChannelTime, Event.EventTime, CopyTemp(Event.Payload));
+			}
+		}
 	}
 
-	OutAudioStarted = bIsAudioStartedAtZero || IsAudioStarted();
-	CurrentAnimProgress = CurrentTime;
-	bIsDirty = true;
+	//the tick that evaluates a jump of a previous frame continues from the jump position
+	if (CurrentTime > PendingJumpPosition)
+	{
+		bool IsAudioStartedSinceJump = false;
+		IsProcessed = Evaluator->ProcessFrame(CurrentTime, IsAudioStartedSinceJump);
+		OutIsAudioStart |= IsAudioStartedSinceJump;
+	}
 
-	ProcessMorphTargets();
-	ProcessMaterialParameters();
+	if (IsProcessed && !IsPlaying())
+	{
+		//paused right after the jump
+		IsProcessed = Evaluator->Pause(CurrentTime);
+	}
 
-	return true;
+	return IsProcessed;
 }
 
 AActor* UFaceFXCharacter::GetOwningActor() const
@@ -168,20 +278,34 @@ AActor* UFaceFXCharacter::GetOwningActor() const
 }
 
 void UFaceFXCharacter::Tick(float DeltaTime)
+{
+	TickEvaluate(DeltaTime);
+	TickGameThread();
+}
+
+void UFaceFXCharacter::TickEvaluate(float DeltaTime)
 {
 	SCOPE_CYCLE_COUNTER(STAT_FaceFXTick);
 
+	if (bIsJumpPending && (!IsPlaying() || PendingJumpFrame == GFrameCounter))
+	{
+		//paused characters only tick to evaluate their pending jump. Jumps requested within this frame are evaluated at the requested position
+		DeltaTime = 0.F;
+	}
+
 	const bool IsNonZeroTick = DeltaTime > 0.F;
 	checkf(!IsNonZeroTick || bCanPlay, TEXT("Internal Error: FaceFX character is not allowed to tick."));
 
-#if WITH_EDITOR
-	if (LastFrameNumber == GFrameNumber)
+	bool IsEvaluate = bIsJumpPending || IsEvaluationEnforced(DeltaTime) || (!bDeferEvaluation && IsEvaluationDue(DeltaTime));
+	bDeferEvaluation = false;
+
+	if (IsEvaluate && !bIsJumpPending && LastEvaluationFrame == GFrameCounter)
 	{
-		//tick was called twice within the same frame -> happens when running in PIE with dedicated server active or multiple instances
-		return;
+		//already evaluated within this frame (i.e. by a flushed jump). The next frame evaluates the progressed time
+		INC_DWORD_STAT(STAT_FaceFXRedundantEvaluations);
+		IsEvaluate = false;
+		bForceEvaluation = true;
 	}
-	LastFrameNumber = GFrameNumber;
-#endif
 
 	//progress in time
 	CurrentTime += DeltaTime;
@@ -190,43 +314,171 @@ void UFaceFXCharacter::Tick(float DeltaTime)
 	//tick the audio player to update its progression
 	AudioPlayer->Tick(DeltaTime);
 
-	FxResult Result = fxActorProcessFrame(Actor, FrameState, CurrentTime);
+	TimeSinceEvaluation += DeltaTime;
 
-	if (!FX_SUCCEEDED(Result))
+	if (!IsEvaluate)
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Tick. FaceFX call <fxActorProcessFrame> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
+		if (bInterpolateOutput && !bFreezeOutput && NumInterpolationKeys > 0 && PublishInterpolatedOutput())
+		{
+			bIsOutputPending = true;
+			bIsGameThreadWorkPending = true;
+		}
 		return;
 	}
 
-	FxChannelFlags ChannelFlags[FACEFX_CHANNELS];
+	const uint32 StartCycles = FPlatformTime::Cycles();
+
+	EvaluateFrame(IsNonZeroTick && CurrentAnimProgress >= CurrentAnimDuration);
+
+	//keep track of the evaluation cost for the budget of the character subsystem
+	const float Cost = FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - StartCycles);
+	EvaluationCost = EvaluationCost > 0.F ? FMath::Lerp(EvaluationCost, Cost, .1F) : Cost;
+}
+
+bool UFaceFXCharacter::IsEvaluationEnforced(float DeltaTime) const
+{
+	//always evaluate the last tick of an animation so no events get lost
+	return bForceEvaluation || DeltaTime <= 0.F || CurrentAnimProgress + DeltaTime >= CurrentAnimDuration || IsTimelineEventDue(DeltaTime);
+}
+
+bool UFaceFXCharacter::IsTimelineEventDue(float DeltaTime) const
+{
+	if (!CurrentAnim || !IsPlaying())
+	{
+		return false;
+	}
+
+	const FFaceFXAnimData& AnimData = CurrentAnim->GetData();
+
+	if (!AnimData.HasTimeline())
+	{
+		//without timeline the audio start is only found by evaluating. Evaluate each tick until it got found
+		return !bIsAudioStartDetected && CurrentAnim->IsAudioAssetSet();
+	}
+
+	//the timeline times are rounded up to the next sample. Look ahead by one sample so the tick that passes the exact time evaluates
+	const FFaceFXAnimTimeline& Timeline = AnimData.Timeline;
+	const float From = CurrentAnimProgress;
+	const float To = CurrentAnimProgress + DeltaTime + 1.F / FACEFX_TIMELINE_SAMPLE_RATE;
+
+	return (!bIsAudioStartDetected && Timeline.IsAudioStarted(To)) || FFaceFXAnimTimeline::FindNextEvent(Timeline.Events, From) < FFaceFXAnimTimeline::FindNextEvent(Timeline.Events, To);
+}
+
+bool UFaceFXCharacter::IsEvaluationDue(float DeltaTime) const
+{
+	return IsEvaluationEnforced(DeltaTime) || TimeSinceEvaluation + DeltaTime >= EvaluationInterval;
+}
+
+void UFaceFXCharacter::EvaluateFrame(bool IsLastTick)
+{
+	bForceEvaluation = false;
+
+	//keep the cadence stable. Only carry over the remainder of a single interval so long hitches don't cause catch up evaluations
+	TimeSinceEvaluation = EvaluationInterval > 0.F ? FMath::Fmod(TimeSinceEvaluation, EvaluationInterval) : 0.F;
+
+	LastEvaluationFrame = GFrameCounter;
+
+	//events are broadcasted later on within TickGameThread
+	bool IsAudioStart = false;
 
-	Result = fxFrameStateGetChannelFlags(FrameState, ChannelFlags, FACEFX_CHANNELS);
+	bDeferEvents = true;
+	const bool IsProcessed = bIsJumpPending ? EvaluateJump(IsAudioStart) : Evaluator->ProcessFrame(CurrentTime, IsAudioStart);
+	const bool IsEvaluated = IsProcessed && Evaluator->GetTrackValues(TrackValues.GetData(), TrackValues.Num());
+	bDeferEvents = false;
 
-	if (!FX_SUCCEEDED(Result))
+	//from here on the game thread has to process the received events even if the evaluation fails
+	bIsGameThreadWorkPending = true;
+
+	if (!IsEvaluated)
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Tick. FaceFX call <fxFrameStateGetChannelFlags> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
 		return;
 	}
 
-	const FxChannelFlags EventStoppedCurrentAnimationFlags = FX_CHANNEL_ACTIVE_BIT | FX_CHANNEL_EVENT_FIRED_BIT | FX_CHANNEL_FINISHED_BIT;
+	bIsAudioStartPending = IsAudioStart;
+	bIsAudioStartDetected |= IsAudioStart;
+	bIsAnimEndPending = IsLastTick;
 
-	if (EventStoppedCurrentAnimationFlags == ChannelFlags[0])
+	if (bFreezeOutput)
 	{
-		UE_LOG(LogFaceFX, Warning, TEXT("UFaceFXCharacter::Tick(). The FaceFX event handler stopped the currently playing animation."));
+		//the evaluation only kept events and audio going
 		return;
 	}
 
-	Result = fxFrameStateGetTrackValues(FrameState, &TrackValues[0], (size_t)TrackValues.Num());
+	//compute the bone transforms right away while we're still on the evaluating thread
+	bool IsOutputChanged = false;
+
+	if (bInterpolateOutput)
+	{
+		if (ComputeBoneTransforms())
+		{
+			PushInterpolationKey();
+			IsOutputChanged = PublishInterpolatedOutput();
+		}
+	}
+	else
+	{
+		NumInterpolationKeys = 0;
+		IsOutputChanged = PublishOutput();
+	}
+
+	//unchanged outputs don't need to get written into morph targets and material parameters again
+	bIsOutputPending = IsOutputChanged;
+}
+
+void UFaceFXCharacter::TickGameThread()
+{
+	check(IsInGameThread());
 
-	if (!FX_SUCCEEDED(Result))
+	if (!bIsGameThreadWorkPending)
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Tick. FaceFX call <fxFrameStateGetTrackValues> failed. (zero: %s) %s. Asset: %s"),
-		       *FaceFX::GetFaceFXResultString(Result), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
 		return;
 	}
 
-	if (IsAudioStarted())
+	bIsGameThreadWorkPending = false;
+
+	if (PendingAnimationEvents.Num() > 0)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_FaceFXAnimEvents);
+
+		const FFaceFXAnimId AnimId = GetCurrentAnimationId();
+
+		//move out the events as the listeners may trigger a new evaluation
+		TArray<FPendingAnimationEvent> AnimationEvents = MoveTemp(PendingAnimationEvents);
+		PendingAnimationEvents.Reset();
+
+		for (const FPendingAnimationEvent& AnimationEvent : AnimationEvents)
+		{
+			OnAnimationEvent.Broadcast(this, AnimId, AnimationEvent.ChannelIndex, AnimationEvent.ChannelTime, AnimationEvent.EventTime, AnimationEvent.Payload);
+		}
+	}
+
+	if (bIsJumpEvaluatedPending)
+	{
+		bIsJumpEvaluatedPending = false;
+
+		//jumps continue the audio at the evaluated position instead of starting it over
+		if (bIsAudioStartPending)
+		{
+			bIsAudioStartPending = false;
+
+			const float AudioPosition = CurrentAnimProgress + CurrentAnimStart;
+			checkf(AudioPosition >= 0.F, TEXT("Invalid audio playback range."));
+
+			if (AudioPlayer->Play(AudioPosition) && !IsPlaying())
+			{
+				AudioPlayer->Pause(true);
+			}
+		}
+		else
+		{
+			AudioPlayer->Stop();
+		}
+	}
+
+	if (bIsAudioStartPending)
 	{
+		bIsAudioStartPending = false;
+
 		SCOPE_CYCLE_COUNTER(STAT_FaceFXAudioEvents);
 		UActorComponent* AudioCompStartedOn = nullptr;
 		const bool AudioStarted = AudioPlayer->Play(&AudioCompStartedOn);
@@ -234,15 +486,17 @@ void UFaceFXCharacter::Tick(float DeltaTime)
 		OnPlaybackStartAudio.Broadcast(this, GetCurrentAnimationId(), AudioStarted, AudioCompStartedOn);
 	}
 
-	ProcessMorphTargets();
-	ProcessMaterialParameters();
-
-	bIsDirty = true;
+	if (bIsOutputPending)
+	{
+		bIsOutputPending = false;
 
-    const bool bIsLastTick = IsNonZeroTick && CurrentAnimProgress >= CurrentAnimDuration;
+		ProcessTrackOutputs();
+	}
 
-	if (bIsLastTick)
+	if (bIsAnimEndPending)
 	{
+		bIsAnimEndPending = false;
+
 		if (IsLooping())
 		{
 			Restart();
@@ -256,12 +510,36 @@ void UFaceFXCharacter::Tick(float DeltaTime)
 
 bool UFaceFXCharacter::IsTickable() const
 {
-	return IsPlaying() && bCanPlay;
+	return (IsPlaying() || bIsJumpPending) && bCanPlay;
+}
+
+void UFaceFXCharacter::RegisterWithSubsystem()
+{
+	if (Subsystem.IsValid())
+	{
+		//already registered
+		return;
+	}
+
+	if (UFaceFXCharacterSubsystem* WorldSubsystem = UFaceFXCharacterSubsystem::Get(this))
+	{
+		WorldSubsystem->RegisterCharacter(this);
+	}
+	else
+	{
+		UE_LOG(LogFaceFX, Warning, TEXT("UFaceFXCharacter::RegisterWithSubsystem. Character is not part of a world and won't get ticked. Actor: %s. Asset: %s"), *GetNameSafe(GetOwningActor()), *GetNameSafe(FaceFXActor));
+	}
 }
 
-TStatId UFaceFXCharacter::GetStatId() const
+void UFaceFXCharacter::UnregisterFromSubsystem()
 {
-	RETURN_QUICK_DECLARE_CYCLE_STAT(UFaceFXCharacter, STATGROUP_Tickables);
+	if (UFaceFXCharacterSubsystem* WorldSubsystem = Subsystem.Get())
+	{
+		WorldSubsystem->UnregisterCharacter(this);
+	}
+
+	Subsystem.Reset();
+	SubsystemIndex = INDEX_NONE;
 }
 
 #if FACEFX_USEANIMATIONLINKAGE
@@ -327,20 +605,12 @@ bool UFaceFXCharacter::GetAllLinkedAnimationIds(TArray<FFaceFXAnimId>& OutAnimId
 
 bool UFaceFXCharacter::GetAnimationBounds(float& OutStart, float& OutEnd) const
 {
-	if (!IsPlaying() || !CurrentAnimation)
-	{
-		return false;
-	}
-
-	FxResult Result = fxAnimationGetBounds(CurrentAnimation, &OutStart, &OutEnd);
-
-	if (!FX_SUCCEEDED(Result))
+	if (!IsPlaying() || !CurrentAnim)
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::GetAnimationBounds. FaceFX call <fxAnimationGetBounds> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
 		return false;
 	}
 
-	return true;
+	return FaceFX::GetAnimationBounds(CurrentAnim, OutStart, OutEnd);
 }
 
 #if FACEFX_USEANIMATIONLINKAGE
@@ -417,42 +687,27 @@ bool UFaceFXCharacter::Play(const UFaceFXAnim* Animation, bool Loop)
 	{
 		//animation changed -> create new handle
 
-		//check if we actually can play this animation
-		FxAnimation NewAnimation = FaceFX::LoadAnimation(Animation->GetData());
-
-		if (!IsCanPlay(NewAnimation))
+		//check if we actually can play this animation. Keeps the previous animation loaded if not
+		if (!Evaluator->LoadAnimation(Animation))
 		{
 			UE_LOG(LogFaceFX, Warning, TEXT("UFaceFXCharacter::Play. Animation is not compatible with FaceFX actor. Actor: %s. Animation: %s"), *GetNameSafe(FaceFXActor), *GetNameSafe(Animation));
 			OnFaceFXCharacterPlayAssetIncompatible.Broadcast(this, Animation);
-
-			//destroy the animation that can't be played so it isn't leaked.
-			FxResult Result = fxAnimationDestroy(&NewAnimation, nullptr, nullptr);
-
-			if (!FX_SUCCEEDED(Result))
-			{
-				UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Play. FaceFX call <fxAnimationDestroy> failed. %s. Actor: %s Animation: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor), *GetNameSafe(Animation));
-			}
-
 			return false;
 		}
 
-		//unload previous animation
-		UnloadCurrentAnim();
-
-		CurrentAnimation = NewAnimation;
+		//the previous animation got unloaded
+		CurrentAnim = nullptr;
 
 		AudioPlayer->Prepare(Animation);
 	}
 
-	//get anim bounds
+	//get anim bounds. Those got stored in the asset during import
 	float AnimStart = 0.f;
 	float AnimEnd = 0.f;
 
-	FxResult Result = fxAnimationGetBounds(CurrentAnimation, &AnimStart, &AnimEnd);
-
-	if (!FX_SUCCEEDED(Result))
+	if (!FaceFX::GetAnimationBounds(Animation, AnimStart, AnimEnd))
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Play. FaceFX call <fxAnimationGetBounds> failed. %s. Actor: %s. Animation: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor), *GetNameSafe(Animation));
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Play. Unable to retrieve the animation bounds. Actor: %s. Animation: %s"), *GetNameSafe(FaceFXActor), *GetNameSafe(Animation));
 		return false;
 	}
 
@@ -465,11 +720,9 @@ bool UFaceFXCharacter::Play(const UFaceFXAnim* Animation, bool Loop)
 		return false;
 	}
 
-	Result = fxActorPlayAnimation(Actor, CurrentAnimation, nullptr);
-
-	if (!FX_SUCCEEDED(Result))
+	if (!Evaluator->Play())
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Play. FaceFX call <fxActorPlayAnimation> failed. %s. Actor: %s. Animation: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor), *GetNameSafe(Animation));
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Play. Unable to start the animation. Evaluator: %s. Actor: %s. Animation: %s"), Evaluator->GetName(), *GetNameSafe(FaceFXActor), *GetNameSafe(Animation));
 		return false;
 	}
 
@@ -479,6 +732,14 @@ bool UFaceFXCharacter::Play(const UFaceFXAnim* Animation, bool Loop)
 	CurrentAnimStart = AnimStart;
 	AnimPlaybackState = EPlaybackState::Playing;
 	bIsLooping = Loop;
+	bIsScrubbed = false;
+	bIsJumpPending = false;
+	bIsAudioStartDetected = false;
+
+	ResetEvaluationHistory();
+
+	//only process the tracks the animation changes. Linked animations got sampled during import and cook
+	SetActiveTracks(FaceFXActor->GetData().FindAnimationActiveTracks(Animation->GetData()));
 
 	{
 		SCOPE_CYCLE_COUNTER(STAT_FaceFXAudioEvents);
@@ -507,17 +768,23 @@ bool UFaceFXCharacter::Resume()
 		return false;
 	}
 
-	FxResult Result = fxActorResumeAnimation(Actor, CurrentTime);
+	if (bIsScrubbed)
+	{
+		//the evaluator is still at the position before scrubbing. Restart at the scrubbed position instead
+		return JumpTo(CurrentAnimProgress);
+	}
 
-	if (!FX_SUCCEEDED(Result))
+	//a pending jump restarts the evaluator once it got evaluated
+	if (!bIsJumpPending && !Evaluator->Resume(CurrentTime))
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Resume. FaceFX call <fxActorResumeAnimation> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
 		return false;
 	}
 
 	AnimPlaybackState = EPlaybackState::Playing;
 	AudioPlayer->Resume();
 
+	ResetEvaluationHistory();
+
 	return true;
 }
 
@@ -529,15 +796,10 @@ bool UFaceFXCharacter::Pause(bool fadeOut)
 		return false;
 	}
 
-	if (IsPlaying())
+	//a pending jump pauses the evaluator once it got evaluated
+	if (IsPlaying() && !bIsJumpPending && !Evaluator->Pause(CurrentTime))
 	{
-		FxResult Result = fxActorPauseAnimation(Actor, CurrentTime);
-
-		if (!FX_SUCCEEDED(Result))
-		{
-			UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Pause. FaceFX call <fxActorPauseAnimation> failed. %s Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
-			return false;
-		}
+		return false;
 	}
 
 	AnimPlaybackState = EPlaybackState::Paused;
@@ -561,15 +823,9 @@ bool UFaceFXCharacter::Stop(bool enforceStop)
 
 	const bool WasPlayingOrPaused = IsPlayingOrPaused();
 
-	if (WasPlayingOrPaused)
+	if (WasPlayingOrPaused && Evaluator.IsValid() && !Evaluator->Stop())
 	{
-		FxResult Result = fxActorStopAnimation(Actor, FX_CHANNEL_ANY);
-
-		if (!FX_SUCCEEDED(Result))
-		{
-			UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Stop. FaceFX call <fxActorStopAnimation> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
-			return false;
-		}
+		return false;
 	}
 
 	const FFaceFXAnimId StoppedAnimId = GetCurrentAnimationId();
@@ -578,10 +834,16 @@ bool UFaceFXCharacter::Stop(bool enforceStop)
 	CurrentAnimProgress = .0F;
 	CurrentAnim = nullptr;
 	AnimPlaybackState = EPlaybackState::Stopped;
+	bIsScrubbed = false;
+	bIsJumpPending = false;
+	bIsJumpEvaluatedPending = false;
 	AudioPlayer->Stop(enforceStop);
 
 	UnloadCurrentAnim();
 
+	//process all tracks again so none of them keeps the values of the stopped animation
+	SetActiveTracks(nullptr);
+
 	ResetMaterialParametersToDefaults();
 
 	if (WasPlayingOrPaused)
@@ -611,33 +873,69 @@ bool UFaceFXCharacter::JumpTo(float Position)
 		return false;
 	}
 
-	if (!CurrentAnimation)
+	if (!Evaluator->IsAnimationLoaded())
 	{
 		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::JumpTo. Current animation is invalid. Asset: %s"), *GetNameSafe(FaceFXActor));
 		return false;
 	}
 
-	//explicitly stop and start the playback again
-	FxResult Result = fxActorStopAnimation(Actor, FX_CHANNEL_ANY);
+	if (Position > CurrentAnimDuration)
+	{
+		//cap the position to the animation range
+		Position = FMath::Fmod(Position, CurrentAnimDuration);
+	}
 
-	if (!FX_SUCCEEDED(Result))
+	if (bIsJumpPending)
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::JumpTo. FaceFX call <fxActorStopAnimation> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
-		return false;
+		//the previous jump never got evaluated
+		INC_DWORD_STAT(STAT_FaceFXRedundantEvaluations);
+	}
+	else
+	{
+		//the events in between get caught up only for jumps of a playing animation
+		PendingJumpOrigin = IsPlaying() ? CurrentAnimProgress : Position;
 	}
 
-	AnimPlaybackState = EPlaybackState::Stopped;
+	//only record the jump. The next tick or FlushRequests restarts the evaluator at the position and updates the audio
+	bIsJumpPending = true;
+	bIsAudioStartDetected = false;
+	PendingJumpPosition = Position;
+	PendingJumpFrame = GFrameCounter;
+
+	CurrentTime = Position;
+	CurrentAnimProgress = Position;
+	AnimPlaybackState = EPlaybackState::Playing;
+	bIsScrubbed = false;
+
+	ResetEvaluationHistory();
+
+	return true;
+}
+
+void UFaceFXCharacter::FlushRequests()
+{
+	check(IsInGameThread());
 
-	//play again
-	Result = fxActorPlayAnimation(Actor, CurrentAnimation, nullptr);
+	if (!bIsJumpPending || !bCanPlay)
+	{
+		return;
+	}
+
+	TickEvaluate(0.F);
+	TickGameThread();
+}
 
-	if (!FX_SUCCEEDED(Result))
+bool UFaceFXCharacter::ScrubTo(float Position)
+{
+	if (Position < 0.F || (!IsLooping() && Position > CurrentAnimDuration))
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::JumpTo. FaceFX call <fxActorPlayAnimation> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
 		return false;
 	}
 
-	AnimPlaybackState = EPlaybackState::Playing;
+	if (!bCanPlay || !IsPaused())
+	{
+		return false;
+	}
 
 	if (Position > CurrentAnimDuration)
 	{
@@ -645,68 +943,114 @@ bool UFaceFXCharacter::JumpTo(float Position)
 		Position = FMath::Fmod(Position, CurrentAnimDuration);
 	}
 
-	bool IsAudioStarted;
-	if (TickUntil(Position, IsAudioStarted) && IsAudioStarted)
+	if (bIsJumpPending)
 	{
-		const float AudioPosition = Position + CurrentAnimStart;
-		checkf(AudioPosition >= 0.F, TEXT("Invalid audio playback range."));
-		return AudioPlayer->Play(AudioPosition);
+		//the evaluator gets restarted anyway. Move the pending jump instead of evaluating twice
+		INC_DWORD_STAT(STAT_FaceFXRedundantEvaluations);
+		PendingJumpPosition = Position;
+		CurrentTime = Position;
+		CurrentAnimProgress = Position;
+		return true;
 	}
 
-	AudioPlayer->Stop();
-	return true;
-}
-
-void UFaceFXCharacter::Reset()
-{
-	//Stop any playing animation before destroying the handles
-	Stop();
+	//the sampler evaluates on its own scratch handles so the evaluator keeps its state
+	FFaceFXCharacterOutput Output;
 
-	//free the facefx handles
-	UnloadCurrentAnim();
+	if (!FFaceFXAnimationSampler::Get().Evaluate(FaceFXActor, CurrentAnim, Position, bCompensatedForForceFrontXAxis, Output))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::ScrubTo. Evaluation failed. Asset: %s. Animation: %s"), *GetNameSafe(FaceFXActor), *GetNameSafe(CurrentAnim));
+		return false;
+	}
 
-	if (Actor)
+	if (Output.TrackValues.Num() != TrackValues.Num() || Output.BoneTransforms.Num() != FaceFXBoneTransforms.Num())
 	{
-		FxResult Result = fxActorDestroy(&Actor, nullptr, nullptr);
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::ScrubTo. Evaluated output does not match the character. Asset: %s. Animation: %s"), *GetNameSafe(FaceFXActor), *GetNameSafe(CurrentAnim));
+		return false;
+	}
 
-		if (!FX_SUCCEEDED(Result))
-		{
-			UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Reset. FaceFX call <fxActorDestroy> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
-		}
+	CurrentTime = Position;
+	CurrentAnimProgress = Position;
+	LastEvaluationFrame = GFrameCounter;
+	bIsScrubbed = true;
+
+	ResetEvaluationHistory();
+
+	if (TrackValues.Num() > 0)
+	{
+		FMemory::Memcpy(TrackValues.GetData(), Output.TrackValues.GetData(), TrackValues.Num() * sizeof(float));
 	}
 
-	if (FrameState)
 	{
-		FxResult Result = fxFrameStateDestroy(&FrameState);
+		SCOPE_CYCLE_COUNTER(STAT_FaceFXPublishOutput);
 
-		if (!FX_SUCCEEDED(Result))
+		//copy into the allocated buffers. Readers may still copy out of them
+		FFaceFXCharacterOutput& Published = OutputBuffer.BeginWrite();
+		checkSlow(Published.BoneTransforms.Num() == Output.BoneTransforms.Num() && Published.TrackValues.Num() == Output.TrackValues.Num());
+
+		if (Output.BoneTransforms.Num() > 0)
 		{
-			UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Reset. FaceFX call <fxFrameStateDestroy> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
+			FMemory::Memcpy(Published.BoneTransforms.GetData(), Output.BoneTransforms.GetData(), Output.BoneTransforms.Num() * sizeof(FTransform));
 		}
-	}
-
-	if (BoneSet)
-	{
-		FxResult Result = fxBoneSetDestroy(&BoneSet, nullptr, nullptr);
 
-		if (!FX_SUCCEEDED(Result))
+		if (TrackValues.Num() > 0)
 		{
-			UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Reset. FaceFX call <fxBoneSetDestroy> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
+			FMemory::Memcpy(Published.TrackValues.GetData(), TrackValues.GetData(), TrackValues.Num() * sizeof(float));
 		}
+
+		OutputBuffer.EndWrite();
+	}
+
+	ProcessTrackOutputs();
+
+	return true;
+}
+
+void UFaceFXCharacter::Reset()
+{
+	//Stop any playing animation before destroying the handles
+	Stop();
+
+	UnregisterFromSubsystem();
+
+	//free the facefx handles
+	UnloadCurrentAnim();
+
+	if (Evaluator.IsValid())
+	{
+		Evaluator->Unload();
+		Evaluator.Reset();
 	}
 
+	//the bone set is owned by the shared template
+	ActorTemplate.Reset();
+
 	//reset arrays
 	TrackValues.Empty();
 	FaceFXBoneTransforms.Empty();
-	BoneTransforms.Empty();
-	BoneIds.Empty();
+	OutputBuffer.Reset();
+	InterpolationKeys[0] = FFaceFXCharacterOutput();
+	InterpolationKeys[1] = FFaceFXCharacterOutput();
+	ResetEvaluationHistory();
 
 	ResetMorphTargets();
 	ResetMaterialParameters();
+	ResetAnimationCurves();
+	ResetCustomPrimitiveData();
+	ResetLODMasks();
+	ResetActiveTracks();
+
+	PendingAnimationEvents.Empty();
+	bIsGameThreadWorkPending = false;
+	bIsAudioStartPending = false;
+	bIsAnimEndPending = false;
+	bIsOutputPending = false;
 
 	FaceFXActor = nullptr;
+}
 
-	bIsDirty = true;
+bool UFaceFXCharacter::IsLoaded() const
+{
+	return Evaluator.IsValid() && Evaluator->IsLoaded() && FaceFXActor;
 }
 
 bool UFaceFXCharacter::IsPlaying(const UFaceFXAnim* Animation) const
@@ -719,22 +1063,27 @@ bool UFaceFXCharacter::IsPlayingOrPaused(const UFaceFXAnim* Animation) const
 	return Animation && IsPlayingOrPaused(Animation->GetId());
 }
 
-void UFaceFXCharacter::OnFaceFXEvent(const FxEventFiringContext* Context, const char* Payload)
+void UFaceFXCharacter::HandleAnimationEvent(int32 ChannelIndex, float ChannelTime, float EventTime, FString&& Payload)
 {
-	UE_LOG(LogFaceFX, Verbose, TEXT("UFaceFXCharacter::OnFaceFXEventReceived. FaceFX event received: %s."), ANSI_TO_TCHAR(Payload));
-
-	if (UFaceFXCharacter* Character = static_cast<UFaceFXCharacter*>(Context->pUserData))
+	if (bIgnoreEvents)
 	{
-		if (!Character->bIgnoreEvents && Context->actor == Character->Actor && Context->animation == Character->CurrentAnimation)
-		{
-			SCOPE_CYCLE_COUNTER(STAT_FaceFXAnimEvents);
-			Character->OnAnimationEvent.Broadcast(Character, Character->GetCurrentAnimationId(), (int)Context->channelIndex, Context->channelTime, Context->eventTime, Payload);
-		}
+		return;
 	}
-}
 
-bool UFaceFXCharacter::Load(const UFaceFXActor* Dataset, bool IsCompensateForForceFrontXAxis, bool IsDisabledMorphTargets, bool IsDisableMaterialParameters)
-{
+	if (bDeferEvents)
+	{
+		//we may run on a worker thread -> queue up for the broadcast on the game thread
+		PendingAnimationEvents.Add(FPendingAnimationEvent(ChannelIndex, ChannelTime, EventTime, MoveTemp(Payload)));
+	}
+	else
+	{
+		SCOPE_CYCLE_COUNTER(STAT_FaceFXAnimEvents);
+		OnAnimationEvent.Broadcast(this, GetCurrentAnimationId(), ChannelIndex, ChannelTime, EventTime, Payload);
+	}
+}
+
+bool UFaceFXCharacter::Load(const UFaceFXActor* Dataset, bool IsCompensateForForceFrontXAxis, bool IsDisabledMorphTargets, bool IsDisableMaterialParameters)
+{
 	SCOPE_CYCLE_COUNTER(STAT_FaceFXLoad);
 
 	if (!Dataset)
@@ -752,358 +1101,795 @@ bool UFaceFXCharacter::Load(const UFaceFXActor* Dataset, bool IsCompensateForFor
 	Reset();
 
 	FaceFXActor = Dataset;
-	BlendMode = ::GetBlendMode(Dataset);
+	BlendMode = FaceFX::GetBlendMode(Dataset);
 
-	const FFaceFXActorData& ActorData = FaceFXActor->GetData();
+	//the parsed actor data is shared by all characters created from the same asset
+	ActorTemplate = FFaceFXActorTemplateCache::Get().Acquire(Dataset, FaceFX::GetBoneSetCreationFlags(BlendMode, IsCompensateForForceFrontXAxis));
+
+	if (!ActorTemplate.IsValid())
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Load. Unable to load FaceFX actor data. Asset: %s"), *GetNameSafe(FaceFXActor));
+		Reset();
+		return false;
+	}
 
-	FxAllocationCallbacks Allocator = FFaceFXAllocator::CreateAllocator();
+	//the evaluator gets picked on load so loading a character switches to the currently preferred one
+	Evaluator = FFaceFXEvaluator::Create(this, FaceFXActor);
+	check(Evaluator.IsValid());
 
-	//only create the bone set handle if there is bone set data
-	if (ActorData.BonesRawData.Num() > 0)
+	if (!Evaluator->Load(FaceFXActor, ActorTemplate))
 	{
-		const FxBoneSetFlags BoneSetCreationFlags = ::GetBoneSetCreationFlags(BlendMode, IsCompensateForForceFrontXAxis);
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Load. Unable to load the evaluator. Evaluator: %s. Asset: %s"), Evaluator->GetName(), *GetNameSafe(FaceFXActor));
+		Reset();
+		return false;
+	}
+
+	//prepare buffers
+	TrackValues.AddUninitialized(ActorTemplate->GetTrackIds().Num());
+	FaceFXBoneTransforms.AddUninitialized(ActorTemplate->GetBoneIds().Num());
+
+	//prepare the published outputs
+	OutputBuffer.Init(FaceFXBoneTransforms.Num(), TrackValues.Num());
+
+	bCompensatedForForceFrontXAxis = IsCompensateForForceFrontXAxis;
+	bDisabledMorphTargets = IsDisabledMorphTargets;
+	bDisabledMaterialParameters = IsDisableMaterialParameters;
 
-		FxResult Result = fxBoneSetCreate(&ActorData.BonesRawData[0], ActorData.BonesRawData.Num(), FX_DATA_VALIDATION_ON, BoneSetCreationFlags, &BoneSet, &Allocator);
+	ResetMorphTargets();
+	ResetMaterialParameters();
+	ResetMaterialParametersToDefaults();
+	ResetAnimationCurves();
+	ResetCustomPrimitiveData();
+	ResetLODMasks();
+	ResetActiveTracks();
+
+	//the tracks output as animation curves are excluded from the game thread setters
+	if (UFaceFXConfig::Get().IsOutputTracksAsCurves() && !SetupAnimationCurves())
+	{
+		Reset();
+		return false;
+	}
+
+	//SetupMaterialParameters after SetupMorphTargets and SetupCustomPrimitiveData as we ignore their tracks as material parameters
+	if ( !SetupCustomPrimitiveData() ||
+		(!bDisabledMorphTargets && !SetupMorphTargets()) ||
+		(!IsDisableMaterialParameters && !SetupMaterialParameters(MorphTargetNames + AnimationCurveNames + CustomPrimitiveDataNames)) )
+	{
+		Reset();
+		return false;
+	}
+
+	if (!SetupLODMasks())
+	{
+		Reset();
+		return false;
+	}
+
+	RegisterWithSubsystem();
+
+	return true;
+}
+
+void UFaceFXCharacter::ProcessMorphTargets()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FaceFXProcessMorphTargets);
+
+	const int32 MorphTargetsToProcess = MorphTargetNames.Num();
+
+	if (MorphTargetsToProcess == 0)
+	{
+		return;
+	}
 
-		if (!FX_SUCCEEDED(Result))
+	if (USkeletalMeshComponent* SkelMeshComp = GetOwningSkelMeshComponent())
+	{
+		if (MorphTargetValues.Num() != MorphTargetsToProcess)
 		{
-			UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Load. Unable to create FaceFX bone set. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
-			Reset();
-			return false;
+			//force the first write of each morph target
+			MorphTargetValues.Init(TNumericLimits<float>::Max(), MorphTargetsToProcess);
 		}
 
-		if (Result == FX_WARNING_LEGACY_DATA_FORMAT)
+		//the tracks the current animation does not change and the tracks skipped by the LOD mask keep their last values
+		const int32 NumActive = bIsAllOutputsActive ? MorphTargetsToProcess : ActiveMorphTargets.Num();
+
+		int32 NumSkipped = MorphTargetsToProcess - NumActive;
+
+		for (int32 ActiveIdx = 0; ActiveIdx < NumActive; ++ActiveIdx)
 		{
-			UE_LOG(LogFaceFX, Verbose, TEXT("UFaceFXCharacter::Load. Loaded a legacy data format. Please recompile the content with the latest FaceFX Runtime compiler. Asset: %s"), *GetNameSafe(FaceFXActor));
+			const int32 Idx = bIsAllOutputsActive ? ActiveIdx : ActiveMorphTargets[ActiveIdx];
+			const int32 TrackIdx = MorphTargetIndices[Idx];
+			const float Value = TrackValues[TrackIdx];
+
+			if (FMath::IsNearlyEqual(Value, MorphTargetValues[Idx], FaceFXOutputEpsilon))
+			{
+				++NumSkipped;
+				continue;
+			}
+
+			MorphTargetValues[Idx] = Value;
+			SkelMeshComp->SetMorphTarget(MorphTargetNames[Idx], Value);
+			CountPendingResetWrite(TrackIdx);
 		}
+
+		INC_DWORD_STAT_BY(STAT_FaceFXMorphTargetsWritten, MorphTargetsToProcess - NumSkipped);
+		INC_DWORD_STAT_BY(STAT_FaceFXMorphTargetsSkipped, NumSkipped);
+	}
+	else
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::ProcessMorphTargets. Unable to find owners skel mesh component. Actor: %s. Asset: %s"), *GetNameSafe(GetOwningActor()), *GetNameSafe(FaceFXActor));
 	}
+}
+
+bool UFaceFXCharacter::SetupAnimationCurves()
+{
+	check(IsLoaded());
+	check(ActorTemplate.IsValid());
 
-	//make sure there is actor data
-	if (ActorData.ActorRawData.Num() == 0)
+	USkeletalMeshComponent* SkelMeshComp = GetOwningSkelMeshComponent();
+
+	if (!SkelMeshComp || !SkelMeshComp->SkeletalMesh)
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Load. No FaceFX actor data present. Asset: %s"), *GetNameSafe(FaceFXActor));
-		Reset();
-		return false;
+		return true;
 	}
 
-	constexpr size_t ChannelCount = FACEFX_CHANNELS;
+	FFaceFXTrackBindings Bindings = ActorTemplate->GetAnimationCurveBindings(SkelMeshComp->SkeletalMesh->GetSkeleton(), !bDisabledMorphTargets, !bDisabledMaterialParameters);
+	AnimationCurveNames = MoveTemp(Bindings.Names);
+	AnimationCurveIndices = MoveTemp(Bindings.Indices);
 
-	FxEventCallbacks EventHandler;
-	EventHandler.pfnEventFired = UFaceFXCharacter::OnFaceFXEvent;
-	EventHandler.pUserData = this;
+	return true;
+}
+
+bool UFaceFXCharacter::SetupMorphTargets()
+{
+	check(IsLoaded());
+	check(ActorTemplate.IsValid());
 
-	FxResult Result = fxActorCreateWithEventHandler(&ActorData.ActorRawData[0], ActorData.ActorRawData.Num(), FX_DATA_VALIDATION_ON, ChannelCount, &Actor, &EventHandler, &Allocator);
+	USkeletalMeshComponent* SkelMeshComp = GetOwningSkelMeshComponent();
 
-	if (!FX_SUCCEEDED(Result))
+	if (!SkelMeshComp)
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Load. Unable to create FaceFX actor handle. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
-		Reset();
-		return false;
+		return true;
 	}
 
-	if (Result == FX_WARNING_LEGACY_DATA_FORMAT)
+	FFaceFXTrackBindings Bindings = ActorTemplate->GetMorphTargetBindings(SkelMeshComp);
+	MorphTargetNames = MoveTemp(Bindings.Names);
+	MorphTargetIndices = MoveTemp(Bindings.Indices);
+
+	//the morph targets driven as animation curves are applied by the anim graph
+	for (int32 Idx = MorphTargetNames.Num() - 1; Idx >= 0; --Idx)
 	{
-		UE_LOG(LogFaceFX, Verbose, TEXT("UFaceFXCharacter::Load. Loaded a legacy data format. Please recompile the content with the latest FaceFX Runtime compiler. Asset: %s"), *GetNameSafe(FaceFXActor));
+		if (AnimationCurveNames.Contains(MorphTargetNames[Idx]))
+		{
+			MorphTargetNames.RemoveAt(Idx, 1, false);
+			MorphTargetIndices.RemoveAt(Idx, 1, false);
+		}
 	}
 
-	size_t TrackCount = 0;
+	return true;
+}
 
-	Result = fxActorGetTracks(Actor, nullptr, &TrackCount);
+bool UFaceFXCharacter::SetupMaterialParameters(const TArray<FName>& IgnoredTracks)
+{
+	check(IsLoaded());
+	check(ActorTemplate.IsValid());
+
+	USkeletalMeshComponent* SkelMeshComp = GetOwningSkelMeshComponent();
 
-	if (!FX_SUCCEEDED(Result))
+	if (!SkelMeshComp || SkelMeshComp->GetNumMaterials() == 0)
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Load. Unable to retrieve FaceFX tracks. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
-		Reset();
 		return false;
 	}
 
-	TrackValues.AddUninitialized(TrackCount);
+	FFaceFXTrackBindings Bindings = ActorTemplate->GetMaterialParameterBindings(SkelMeshComp, IgnoredTracks);
+	MaterialParameterNames = MoveTemp(Bindings.Names);
+	MaterialParameterIndices = MoveTemp(Bindings.Indices);
+
+	SetupMaterialParameterTargets(SkelMeshComp);
+
+	return true;
+}
+
+void UFaceFXCharacter::SetupMaterialParameterTargets(USkeletalMeshComponent* SkelMeshComp)
+{
+	check(SkelMeshComp);
 
-	TArray<uint64_t> TrackIds;
-	TrackIds.AddUninitialized(TrackCount);
+	ResetMaterialParameterTargets();
 
-	Result = fxActorGetTracks(Actor, &TrackIds[0], &TrackCount);
+	const int32 NumParameters = MaterialParameterNames.Num();
 
-	if (!FX_SUCCEEDED(Result))
+	if (NumParameters == 0)
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Load. Unable to retrieve FaceFX tracks. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
-		Reset();
-		return false;
+		return;
 	}
 
-	Result = fxFrameStateCreate(Actor, &FrameState, &Allocator);
+	//force the first write of each parameter
+	MaterialParameterValues.Init(TNumericLimits<float>::Max(), NumParameters);
+
+	//the defaults are looked up once so LOD masks and resets don't search the materials by name
+	MaterialParameterDefaults.SetNumUninitialized(NumParameters);
 
-	if (!FX_SUCCEEDED(Result))
+	for (int32 BindingIdx = 0; BindingIdx < NumParameters; ++BindingIdx)
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Load. Unable to create FaceFX frame state. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
-		Reset();
-		return false;
+		MaterialParameterDefaults[BindingIdx] = SkelMeshComp->GetScalarParameterDefaultValue(MaterialParameterNames[BindingIdx]);
 	}
 
-	if (BoneSet)
+	const int32 NumMaterials = SkelMeshComp->GetNumMaterials();
+
+	for (int32 SlotIdx = 0; SlotIdx < NumMaterials; ++SlotIdx)
 	{
-		size_t XFormCount = 0;
+		UMaterialInterface* Material = SkelMeshComp->GetMaterial(SlotIdx);
+
+		if (!Material)
+		{
+			continue;
+		}
 
-		Result = fxBoneSetGetBones(BoneSet, nullptr, &XFormCount);
+		//only create dynamic material instances for the slots that use any of the parameters
+		bool IsUsingParameters = false;
+		float ParameterValue;
 
-		if (!FX_SUCCEEDED(Result))
+		for (int32 BindingIdx = 0; BindingIdx < NumParameters && !IsUsingParameters; ++BindingIdx)
 		{
-			UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Load. Unable to retrieve FaceFX bone count. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
-			Reset();
-			return false;
+			IsUsingParameters = Material->GetScalarParameterValue(MaterialParameterNames[BindingIdx], ParameterValue);
 		}
 
-		if (XFormCount > 0)
+		if (!IsUsingParameters)
 		{
-			//prepare buffer
-			FaceFXBoneTransforms.AddUninitialized(XFormCount);
+			continue;
+		}
 
-			//retrieve bone names
-			BoneIds.AddUninitialized(XFormCount);
+		UMaterialInstanceDynamic* MID = Cast<UMaterialInstanceDynamic>(Material);
 
-			Result = fxBoneSetGetBones(BoneSet, BoneIds.GetData(), &XFormCount);
+		if (!MID)
+		{
+			MID = SkelMeshComp->CreateAndSetMaterialInstanceDynamic(SlotIdx);
 
-			if (!FX_SUCCEEDED(Result))
+			if (!MID)
 			{
-				UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::Load. Unable to retrieve FaceFX bones. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
-				Reset();
-				return false;
+				UE_LOG(LogFaceFX, Warning, TEXT("UFaceFXCharacter::SetupMaterialParameterTargets. Unable to create dynamic material instance. Slot: %i. Actor: %s. Asset: %s"), SlotIdx, *GetNameSafe(GetOwningActor()), *GetNameSafe(FaceFXActor));
+				continue;
 			}
+		}
 
-			//prepare transform buffer
-			BoneTransforms.AddZeroed(XFormCount);
+		const int32 MIDIdx = MaterialParameterMIDs.Add(MID);
+		MaterialParameterSlots.Add(SlotIdx);
 
-			//match bone ids with names from the .ffxids assets
-			for (const uint64_t& BoneIdHash : BoneIds)
+		for (int32 BindingIdx = 0; BindingIdx < NumParameters; ++BindingIdx)
+		{
+			const FName& ParameterName = MaterialParameterNames[BindingIdx];
+
+			int32 ParameterIdx = INDEX_NONE;
+
+			if (MID->GetScalarParameterValue(ParameterName, ParameterValue) && MID->InitializeScalarParameterAndGetIndex(ParameterName, ParameterValue, ParameterIdx) && ParameterIdx != INDEX_NONE)
 			{
-				if (const FFaceFXIdData* BoneId = ActorData.Ids.FindByKey(BoneIdHash))
-				{
-					BoneNames.Add(BoneId->Name);
-				}
-				else
-				{
-					UE_LOG(LogFaceFX, Warning, TEXT("UFaceFXCharacter::Load. Unknown bone id. %i. Asset: %s"), BoneIdHash, *GetNameSafe(FaceFXActor));
-				}
+				MaterialParameterTargets.Add(FMaterialParameterTarget(MIDIdx, ParameterIdx, BindingIdx));
 			}
 		}
 	}
 
-	bCompensatedForForceFrontXAxis = IsCompensateForForceFrontXAxis;
-	bDisabledMorphTargets = IsDisabledMorphTargets;
-	bDisabledMaterialParameters = IsDisableMaterialParameters;
+	//group the targets per binding so each track value gets compared only once per tick
+	MaterialParameterTargets.StableSort([](const FMaterialParameterTarget& A, const FMaterialParameterTarget& B)
+	{
+		return A.BindingIdx < B.BindingIdx;
+	});
 
-	ResetMorphTargets();
-	ResetMaterialParameters();
-	ResetMaterialParametersToDefaults();
+	//the range of each binding within the sorted targets
+	MaterialParameterTargetOffsets.Init(0, NumParameters + 1);
 
-	//SetupMaterialParameters after SetupMorphTargets as we ignore the morph target tracks as material parameters
-	if ( (!bDisabledMorphTargets && !SetupMorphTargets(Dataset, TrackIds)) ||
-		(!IsDisableMaterialParameters && !SetupMaterialParameters(Dataset, TrackIds, MorphTargetNames)) )
+	for (const FMaterialParameterTarget& Target : MaterialParameterTargets)
 	{
-		Reset();
-		return false;
+		++MaterialParameterTargetOffsets[Target.BindingIdx + 1];
 	}
 
-	return true;
+	for (int32 BindingIdx = 0; BindingIdx < NumParameters; ++BindingIdx)
+	{
+		MaterialParameterTargetOffsets[BindingIdx + 1] += MaterialParameterTargetOffsets[BindingIdx];
+	}
 }
 
-void UFaceFXCharacter::ProcessMorphTargets()
+bool UFaceFXCharacter::IsMaterialParameterTargetsValid(const USkeletalMeshComponent* SkelMeshComp) const
 {
-	SCOPE_CYCLE_COUNTER(STAT_FaceFXProcessMorphTargets);
+	check(SkelMeshComp);
 
-	const int32 MorphTargetsToProcess = MorphTargetNames.Num();
-
-	if (MorphTargetsToProcess == 0)
+	if (MaterialParameterValues.Num() != MaterialParameterNames.Num())
 	{
-		return;
+		return false;
 	}
 
-	if (USkeletalMeshComponent* SkelMeshComp = GetOwningSkelMeshComponent())
+	//the materials may have been replaced since the targets were resolved
+	for (int32 Idx = 0; Idx < MaterialParameterSlots.Num(); ++Idx)
 	{
-		for (int32 Idx = 0; Idx < MorphTargetsToProcess; ++Idx)
+		const UMaterialInstanceDynamic* MID = MaterialParameterMIDs[Idx].Get();
+
+		if (!MID || SkelMeshComp->GetMaterial(MaterialParameterSlots[Idx]) != MID)
 		{
-			SkelMeshComp->SetMorphTarget(MorphTargetNames[Idx], TrackValues[MorphTargetIndices[Idx]]);
+			return false;
 		}
 	}
-	else
+
+	return true;
+}
+
+void UFaceFXCharacter::WriteMaterialParameter(int32 BindingIdx, float Value)
+{
+	for (int32 TargetIdx = MaterialParameterTargetOffsets[BindingIdx]; TargetIdx < MaterialParameterTargetOffsets[BindingIdx + 1]; ++TargetIdx)
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::ProcessMorphTargets. Unable to find owners skel mesh component. Actor: %s. Asset: %s"), *GetNameSafe(GetOwningActor()), *GetNameSafe(FaceFXActor));
+		const FMaterialParameterTarget& Target = MaterialParameterTargets[TargetIdx];
+
+		if (UMaterialInstanceDynamic* MID = MaterialParameterMIDs[Target.MIDIdx].Get())
+		{
+			MID->SetScalarParameterByIndex(Target.ParameterIdx, Value);
+		}
 	}
 }
 
-bool UFaceFXCharacter::SetupMorphTargets(const UFaceFXActor* Dataset, const TArray<uint64_t>& TrackIds)
+void UFaceFXCharacter::SetCustomPrimitiveDataTracks(const TMap<FName, int32>& Tracks)
 {
-	check(IsLoaded());
-	check(Dataset);
+	CustomPrimitiveDataTracks = Tracks;
 
-	USkeletalMeshComponent* SkelMeshComp = GetOwningSkelMeshComponent();
+	if (!IsLoaded())
+	{
+		//applied during Load
+		return;
+	}
 
-	if (!SkelMeshComp)
+	ResetMaterialParametersToDefaults();
+	ResetMaterialParameters();
+	ResetCustomPrimitiveData();
+
+	SetupCustomPrimitiveData();
+
+	if (!bDisabledMaterialParameters)
 	{
-		return true;
+		SetupMaterialParameters(MorphTargetNames + AnimationCurveNames + CustomPrimitiveDataNames);
 	}
 
-	const int32 NumMorphTargets = SkelMeshComp->SkeletalMesh ? SkelMeshComp->SkeletalMesh->GetMorphTargetIndexMap().Num() : 0;
+	UpdateActiveOutputs();
+}
+
+bool UFaceFXCharacter::SetupCustomPrimitiveData()
+{
+	check(IsLoaded());
+	check(ActorTemplate.IsValid());
 
-	if (NumMorphTargets == 0)
+	if (CustomPrimitiveDataTracks.Num() == 0)
 	{
 		return true;
 	}
 
-	MorphTargetNames.Reserve(NumMorphTargets);
-	MorphTargetIndices.Reserve(NumMorphTargets);
+	//order by custom primitive data index so indices driven by multiple tracks are next to each other
+	TArray<TPair<int32, FName>> SortedTracks;
+	SortedTracks.Reserve(CustomPrimitiveDataTracks.Num());
 
-	int32 NumTracks = TrackIds.Num();
+	for (const TPair<FName, int32>& Track : CustomPrimitiveDataTracks)
+	{
+		SortedTracks.Add(TPair<int32, FName>(Track.Value, Track.Key));
+	}
 
-	for (int32 TrackIndex = 0; TrackIndex < NumTracks; ++TrackIndex)
+	SortedTracks.Sort([](const TPair<int32, FName>& A, const TPair<int32, FName>& B)
 	{
-		const uint64_t TrackId = TrackIds[TrackIndex];
+		return A.Key < B.Key;
+	});
 
-		const FFaceFXIdData* AssetIdData = Dataset->GetData().Ids.FindByKey(TrackId);
+	const FFaceFXActorData& ActorData = FaceFXActor->GetData();
+
+	for (const TPair<int32, FName>& Track : SortedTracks)
+	{
+		const int32 Slot = Track.Key;
+		const FName& TrackName = Track.Value;
 
-		if (!AssetIdData)
+		if (Slot < 0 || Slot >= FCustomPrimitiveData::NumCustomPrimitiveDataFloats)
 		{
+			UE_LOG(LogFaceFX, Warning, TEXT("UFaceFXCharacter::SetupCustomPrimitiveData. Custom primitive data index out of range. Track: %s. Index: %i. Asset: %s"), *TrackName.ToString(), Slot, *GetNameSafe(FaceFXActor));
 			continue;
 		}
 
-		if (SkelMeshComp->SkeletalMesh->GetMorphTargetIndexMap().Contains(AssetIdData->Name))
+		if (CustomPrimitiveDataSlots.Num() > 0 && CustomPrimitiveDataSlots.Last() == Slot)
 		{
-			MorphTargetNames.Add(AssetIdData->Name);
-			MorphTargetIndices.Add((size_t)TrackIndex);
+			UE_LOG(LogFaceFX, Warning, TEXT("UFaceFXCharacter::SetupCustomPrimitiveData. Custom primitive data index already driven by track %s. Track: %s. Index: %i. Asset: %s"), *CustomPrimitiveDataNames.Last().ToString(), *TrackName.ToString(), Slot, *GetNameSafe(FaceFXActor));
+			continue;
+		}
 
-			UE_LOG(LogFaceFX, Verbose, TEXT("UFaceFXCharacter::SetupMorphTargets. driving morph target named %s (Asset: %s)"), *AssetIdData->Name.ToString(), *GetNameSafe(FaceFXActor));
+		const FFaceFXIdData* TrackId = ActorData.FindId(TrackName);
+		const int32 TrackIndex = TrackId ? ActorTemplate->GetTrackIndex(TrackId->Id) : INDEX_NONE;
+
+		if (TrackIndex == INDEX_NONE)
+		{
+			UE_LOG(LogFaceFX, Warning, TEXT("UFaceFXCharacter::SetupCustomPrimitiveData. Unknown FaceFX track. Track: %s. Asset: %s"), *TrackName.ToString(), *GetNameSafe(FaceFXActor));
+			continue;
 		}
+
+		CustomPrimitiveDataNames.Add(TrackName);
+		CustomPrimitiveDataSlots.Add(Slot);
+		CustomPrimitiveDataIndices.Add((size_t)TrackIndex);
 	}
 
+	//force the first write of each value
+	CustomPrimitiveDataValues.Init(TNumericLimits<float>::Max(), CustomPrimitiveDataSlots.Num());
+
 	return true;
 }
 
-bool UFaceFXCharacter::SetupMaterialParameters(const UFaceFXActor* Dataset, const TArray<uint64_t>& TrackIds, const TArray<FName>& IgnoredTracks)
+void UFaceFXCharacter::ProcessCustomPrimitiveData()
 {
-	check(IsLoaded());
-	check(Dataset);
+	SCOPE_CYCLE_COUNTER(STAT_FaceFXProcessCustomPrimitiveData);
 
-	USkeletalMeshComponent* SkelMeshComp = GetOwningSkelMeshComponent();
+	const int32 NumSlots = CustomPrimitiveDataSlots.Num();
 
-	if (!SkelMeshComp)
+	if (NumSlots == 0)
 	{
-		return false;
+		return;
 	}
 
-	const int32 NumMaterials = SkelMeshComp->GetNumMaterials();
-
-	if (NumMaterials == 0)
+	if (USkeletalMeshComponent* SkelMeshComp = GetOwningSkelMeshComponent())
 	{
-		return false;
-	}
+		//write all changed values into the primitive data of the component and push it to the scene once. Each SetCustomPrimitiveData call pushes the whole data.
+		//MarkRenderStateDirty would recreate the render state of the skinned mesh instead
+		TArray<float>& PrimitiveData = const_cast<FCustomPrimitiveData&>(SkelMeshComp->GetCustomPrimitiveData()).Data;
 
-	MaterialParameterNames.Reserve(NumMaterials);
-	MaterialParameterIndices.Reserve(NumMaterials);
+		const int32 NumPrimitiveData = CustomPrimitiveDataSlots.Last() + 1;
+		if (PrimitiveData.Num() < NumPrimitiveData)
+		{
+			PrimitiveData.SetNumZeroed(NumPrimitiveData);
+		}
 
-	int32 NumTracks = TrackIds.Num();
+		int32 LastChangedIdx = INDEX_NONE;
 
-	for (int32 TrackIndex = 0; TrackIndex < NumTracks; ++TrackIndex)
-	{
-		const uint64_t TrackId = TrackIds[TrackIndex];
+		for (int32 Idx = 0; Idx < NumSlots; ++Idx)
+		{
+			const float Value = TrackValues[CustomPrimitiveDataIndices[Idx]];
 
-		const FFaceFXIdData* AssetIdData = Dataset->GetData().Ids.FindByKey(TrackId);
+			if (!FMath::IsNearlyEqual(Value, CustomPrimitiveDataValues[Idx], FaceFXOutputEpsilon))
+			{
+				CustomPrimitiveDataValues[Idx] = Value;
+				PrimitiveData[CustomPrimitiveDataSlots[Idx]] = Value;
+				LastChangedIdx = Idx;
+			}
+		}
 
-		if (!AssetIdData)
+		if (LastChangedIdx != INDEX_NONE)
 		{
-			continue;
+			//rewrite the last changed value through the component so the scene receives a single update. The component skips unchanged values
+			const int32 Slot = CustomPrimitiveDataSlots[LastChangedIdx];
+			PrimitiveData[Slot] = TNumericLimits<float>::Max();
+			SkelMeshComp->SetCustomPrimitiveDataFloat(Slot, CustomPrimitiveDataValues[LastChangedIdx]);
+
+			INC_DWORD_STAT(STAT_FaceFXCustomPrimitiveDataUpdates);
 		}
+	}
+	else
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::ProcessCustomPrimitiveData. Unable to find owners skel mesh component. Actor: %s. Asset: %s"), *GetNameSafe(GetOwningActor()), *GetNameSafe(FaceFXActor));
+	}
+}
+
+void UFaceFXCharacter::ProcessMaterialParameters()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FaceFXProcessMaterialParameters);
+
+	const int32 MaterialParametersToProcess = MaterialParameterNames.Num();
+
+	if (MaterialParametersToProcess == 0)
+	{
+		return;
+	}
 
-		if (IgnoredTracks.Contains(AssetIdData->Name))
+	if (USkeletalMeshComponent* SkelMeshComp = GetOwningSkelMeshComponent())
+	{
+		if (!IsMaterialParameterTargetsValid(SkelMeshComp))
 		{
-			continue;
+			SetupMaterialParameterTargets(SkelMeshComp);
 		}
 
-		for (int32 MaterialIndex = 0; MaterialIndex < NumMaterials; ++MaterialIndex)
+		//the tracks the current animation does not change and the tracks skipped by the LOD mask keep their last values
+		const int32 NumActive = bIsAllOutputsActive ? MaterialParametersToProcess : ActiveMaterialParameters.Num();
+
+		int32 NumSkipped = MaterialParametersToProcess - NumActive;
+
+		for (int32 ActiveIdx = 0; ActiveIdx < NumActive; ++ActiveIdx)
 		{
-			if (UMaterialInterface* Material = SkelMeshComp->GetMaterial(MaterialIndex))
+			const int32 Idx = bIsAllOutputsActive ? ActiveIdx : ActiveMaterialParameters[ActiveIdx];
+			const int32 TrackIdx = MaterialParameterIndices[Idx];
+			const float Value = TrackValues[TrackIdx];
+
+			if (FMath::IsNearlyEqual(Value, MaterialParameterValues[Idx], FaceFXOutputEpsilon))
 			{
-				float ParamterValue;
+				++NumSkipped;
+				continue;
+			}
 
-				if (Material->GetScalarParameterValue(AssetIdData->Name, ParamterValue))
-				{
-					MaterialParameterNames.Add(AssetIdData->Name);
-					MaterialParameterIndices.Add((size_t)TrackIndex);
+			MaterialParameterValues[Idx] = Value;
+			CountPendingResetWrite(TrackIdx);
 
-					UE_LOG(LogFaceFX, Verbose, TEXT("UFaceFXCharacter::SetupMaterialParameters. driving material parameter named %s (Asset: %s)"), *AssetIdData->Name.ToString(), *GetNameSafe(FaceFXActor));
+			WriteMaterialParameter(Idx, Value);
+		}
 
-					break;
-				}
+		INC_DWORD_STAT_BY(STAT_FaceFXMaterialParametersWritten, MaterialParametersToProcess - NumSkipped);
+		INC_DWORD_STAT_BY(STAT_FaceFXMaterialParametersSkipped, NumSkipped);
+	}
+	else
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::ProcessMaterialParameters. Unable to find owners skel mesh component. Actor: %s. Asset: %s"), *GetNameSafe(GetOwningActor()), *GetNameSafe(FaceFXActor));
+	}
+}
+
+void UFaceFXCharacter::ProcessTrackOutputs()
+{
+	NumPendingResetWrites = 0;
+
+	UpdateLODMask();
+
+	ProcessMorphTargets();
+	ProcessMaterialParameters();
+	ProcessCustomPrimitiveData();
+
+	//the tracks of the previous animation settled once a new output got processed without changing any of them
+	if (bIsActiveTracksPending && NumPendingResetWrites == 0 && GetOutputVersion() != PendingActiveTracksVersion)
+	{
+		bIsActiveTracksPending = false;
+
+		ActiveTracks = MoveTemp(PendingActiveTracks);
+		PendingActiveTracks.Empty();
+
+		UpdateActiveOutputs();
+	}
+}
+
+void UFaceFXCharacter::SetActiveTracks(const TArray<int32>* TrackIndices)
+{
+	const int32 NumTracks = TrackValues.Num();
+
+	TBitArray<> NewActiveTracks;
+
+	if (TrackIndices && NumTracks > 0)
+	{
+		NewActiveTracks.Init(false, NumTracks);
+
+		for (const int32 TrackIdx : *TrackIndices)
+		{
+			if (!NewActiveTracks.IsValidIndex(TrackIdx))
+			{
+				UE_LOG(LogFaceFX, Warning, TEXT("UFaceFXCharacter::SetActiveTracks. Invalid track index %i. Processing all tracks. Asset: %s"), TrackIdx, *GetNameSafe(FaceFXActor));
+				NewActiveTracks.Empty();
+				break;
 			}
+
+			NewActiveTracks[TrackIdx] = true;
 		}
 	}
 
-	return true;
+	//keep processing the tracks of the previous animation until they returned to their rest values
+	if (NewActiveTracks.Num() == 0)
+	{
+		ActiveTracks.Empty();
+	}
+	else if (ActiveTracks.Num() > 0)
+	{
+		for (TConstSetBitIterator<> It(NewActiveTracks); It; ++It)
+		{
+			ActiveTracks[It.GetIndex()] = true;
+		}
+	}
+
+	PendingActiveTracks = MoveTemp(NewActiveTracks);
+	PendingActiveTracksVersion = GetOutputVersion();
+	bIsActiveTracksPending = true;
+
+	UpdateActiveOutputs();
 }
 
-void UFaceFXCharacter::ProcessMaterialParameters()
+void UFaceFXCharacter::UpdateActiveOutputs()
 {
-	SCOPE_CYCLE_COUNTER(STAT_FaceFXProcessMaterialParameters);
+	ActiveMorphTargets.Reset();
+	ActiveMaterialParameters.Reset();
 
-	const int32 MaterialParametersToProcess = MaterialParameterNames.Num();
+	const TBitArray<>* ExcludedTracks = LODMasks.IsValidIndex(CurrentLODMaskIdx) && LODMasks[CurrentLODMaskIdx].ExcludedTracks.Num() > 0 ? &LODMasks[CurrentLODMaskIdx].ExcludedTracks : nullptr;
 
-	if (MaterialParametersToProcess == 0)
+	bIsAllOutputsActive = ActiveTracks.Num() == 0 && !ExcludedTracks;
+
+	if (bIsAllOutputsActive)
 	{
 		return;
 	}
 
-	if (USkeletalMeshComponent* SkelMeshComp = GetOwningSkelMeshComponent())
+	auto IsTrackActive = [this, ExcludedTracks](int32 TrackIdx)
+	{
+		return (ActiveTracks.Num() == 0 || ActiveTracks[TrackIdx]) && !(ExcludedTracks && (*ExcludedTracks)[TrackIdx]);
+	};
+
+	for (int32 Idx = 0; Idx < MorphTargetIndices.Num(); ++Idx)
 	{
-		for (int32 Idx = 0; Idx < MaterialParametersToProcess; ++Idx)
+		if (IsTrackActive(MorphTargetIndices[Idx]))
 		{
-			SkelMeshComp->SetScalarParameterValueOnMaterials(MaterialParameterNames[Idx], TrackValues[MaterialParameterIndices[Idx]]);
+			ActiveMorphTargets.Add(Idx);
 		}
 	}
-	else
+
+	for (int32 Idx = 0; Idx < MaterialParameterIndices.Num(); ++Idx)
 	{
-		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::ProcessMaterialParameters. Unable to find owners skel mesh component. Actor: %s. Asset: %s"), *GetNameSafe(GetOwningActor()), *GetNameSafe(FaceFXActor));
+		if (IsTrackActive(MaterialParameterIndices[Idx]))
+		{
+			ActiveMaterialParameters.Add(Idx);
+		}
 	}
 }
 
-void UFaceFXCharacter::ResetMaterialParametersToDefaults()
+bool UFaceFXCharacter::SetupLODMasks()
 {
-	if (USkeletalMeshComponent* SkelMeshComp = GetOwningSkelMeshComponent())
+	check(IsLoaded());
+	check(ActorTemplate.IsValid());
+
+	const TArray<FFaceFXActorLODMask>& SourceMasks = FaceFXActor->GetLODMasks();
+
+	if (SourceMasks.Num() == 0)
 	{
-		for (int32 Idx = 0; Idx < MaterialParameterNames.Num(); ++Idx)
+		return true;
+	}
+
+	const TArray<FName>& TrackNames = ActorTemplate->GetTrackNames();
+	const int32 NumBones = FaceFXBoneTransforms.Num();
+	const int32 NumTracks = TrackValues.Num();
+
+	LODMasks.Reserve(SourceMasks.Num());
+
+	for (const FFaceFXActorLODMask& SourceMask : SourceMasks)
+	{
+		FLODMask& Mask = LODMasks[LODMasks.AddDefaulted()];
+		Mask.MinLOD = SourceMask.MinLOD;
+
+		for (const FName& BoneName : SourceMask.ExcludedBones)
 		{
-			const FName& ParameterName = MaterialParameterNames[Idx];
+			const int32 BoneIdx = GetBoneNameTransformIndex(BoneName);
+
+			if (BoneIdx == INDEX_NONE)
+			{
+				UE_LOG(LogFaceFX, Warning, TEXT("UFaceFXCharacter::SetupLODMasks. Unknown FaceFX bone. Bone: %s. LOD: %i. Asset: %s"), *BoneName.ToString(), SourceMask.MinLOD, *GetNameSafe(FaceFXActor));
+				continue;
+			}
+
+			if (Mask.ExcludedBones.Num() == 0)
+			{
+				Mask.ExcludedBones.Init(false, NumBones);
+			}
+			Mask.ExcludedBones[BoneIdx] = true;
+		}
+
+		for (const FName& TrackName : SourceMask.ExcludedTracks)
+		{
+			const int32 TrackIdx = TrackNames.IndexOfByKey(TrackName);
+
+			if (TrackIdx == INDEX_NONE)
+			{
+				UE_LOG(LogFaceFX, Warning, TEXT("UFaceFXCharacter::SetupLODMasks. Unknown FaceFX track. Track: %s. LOD: %i. Asset: %s"), *TrackName.ToString(), SourceMask.MinLOD, *GetNameSafe(FaceFXActor));
+				continue;
+			}
+
+			if (Mask.ExcludedTracks.Num() == 0)
+			{
+				Mask.ExcludedTracks.Init(false, NumTracks);
+			}
+			Mask.ExcludedTracks[TrackIdx] = true;
+		}
+	}
 
-			const float DefaultValue = SkelMeshComp->GetScalarParameterDefaultValue(ParameterName);
+	LODMasks.StableSort([](const FLODMask& A, const FLODMask& B)
+	{
+		return A.MinLOD < B.MinLOD;
+	});
+
+	++LODMasksVersion;
+
+	return true;
+}
 
-			SkelMeshComp->SetScalarParameterValueOnMaterials(ParameterName, DefaultValue);
+int32 UFaceFXCharacter::GetLODMaskIndex(int32 LODLevel) const
+{
+	for (int32 MaskIdx = LODMasks.Num() - 1; MaskIdx >= 0; --MaskIdx)
+	{
+		if (LODMasks[MaskIdx].MinLOD <= LODLevel)
+		{
+			return MaskIdx;
 		}
 	}
+	return INDEX_NONE;
 }
 
-bool UFaceFXCharacter::IsCanPlay(const UFaceFXAnim* Animation) const
+void UFaceFXCharacter::GetLODMaskExclusions(int32 MaskIdx, TBitArray<>& OutExcludedBones, TBitArray<>& OutExcludedTracks) const
+{
+	if (LODMasks.IsValidIndex(MaskIdx))
+	{
+		OutExcludedBones = LODMasks[MaskIdx].ExcludedBones;
+		OutExcludedTracks = LODMasks[MaskIdx].ExcludedTracks;
+	}
+	else
+	{
+		OutExcludedBones.Empty();
+		OutExcludedTracks.Empty();
+	}
+}
+
+void UFaceFXCharacter::UpdateLODMask()
 {
-	bool CanPlay = false;
+	if (LODMasks.Num() == 0)
+	{
+		return;
+	}
+
+	//apply the LOD mask of the predicted skeletal mesh LOD
+	const USkeletalMeshComponent* SkelMeshComp = GetOwningSkelMeshComponent();
+	const int32 MaskIdx = SkelMeshComp ? GetLODMaskIndex(SkelMeshComp->GetPredictedLODLevel()) : INDEX_NONE;
 
-	if (Animation)
+	if (MaskIdx != CurrentLODMaskIdx)
 	{
-		FxAnimation NewAnimation = FaceFX::LoadAnimation(Animation->GetData());
+		ApplyLODMask(MaskIdx);
+	}
+}
 
-		CanPlay = IsCanPlay(NewAnimation);
+void UFaceFXCharacter::ApplyLODMask(int32 MaskIdx)
+{
+	CurrentLODMaskIdx = MaskIdx;
 
-		//destroy the animation so it isn't leaked.
-		FxResult Result = fxAnimationDestroy(&NewAnimation, nullptr, nullptr);
+	UpdateActiveOutputs();
 
-		if (!FX_SUCCEEDED(Result))
+	const TBitArray<>* ExcludedTracks = LODMasks.IsValidIndex(MaskIdx) && LODMasks[MaskIdx].ExcludedTracks.Num() > 0 ? &LODMasks[MaskIdx].ExcludedTracks : nullptr;
+	USkeletalMeshComponent* SkelMeshComp = GetOwningSkelMeshComponent();
+
+	if (!ExcludedTracks || !SkelMeshComp)
+	{
+		return;
+	}
+
+	//the skipped tracks return to their rest values instead of freezing at their last values
+	for (int32 Idx = 0; Idx < MorphTargetValues.Num(); ++Idx)
+	{
+		if ((*ExcludedTracks)[MorphTargetIndices[Idx]] && MorphTargetValues[Idx] != 0.f)
+		{
+			MorphTargetValues[Idx] = 0.f;
+			SkelMeshComp->SetMorphTarget(MorphTargetNames[Idx], 0.f);
+		}
+	}
+
+	if (MaterialParameterValues.Num() > 0 && !IsMaterialParameterTargetsValid(SkelMeshComp))
+	{
+		SetupMaterialParameterTargets(SkelMeshComp);
+	}
+
+	for (int32 Idx = 0; Idx < MaterialParameterValues.Num(); ++Idx)
+	{
+		if ((*ExcludedTracks)[MaterialParameterIndices[Idx]])
 		{
-			UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::IsCanPlay. FaceFX call <fxAnimationDestroy> failed. %s. Actor: %s Animation: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor), *GetNameSafe(Animation));
+			const float DefaultValue = MaterialParameterDefaults[Idx];
+
+			if (MaterialParameterValues[Idx] != DefaultValue)
+			{
+				MaterialParameterValues[Idx] = DefaultValue;
+				WriteMaterialParameter(Idx, DefaultValue);
+			}
 		}
 	}
+}
+
+void UFaceFXCharacter::ResetMaterialParametersToDefaults()
+{
+	//only the dynamic material instances the parameters got written into need to be restored
+	for (int32 Idx = 0; Idx < MaterialParameterDefaults.Num(); ++Idx)
+	{
+		WriteMaterialParameter(Idx, MaterialParameterDefaults[Idx]);
+	}
 
-	return Animation && CanPlay;
+	//force the next write of each parameter
+	for (float& Value : MaterialParameterValues)
+	{
+		Value = TNumericLimits<float>::Max();
+	}
+
+	//force the next publish so the parameters get restored even if the output does not change
+	PublishedTrackValues.Reset();
 }
 
-bool UFaceFXCharacter::IsCanPlay(FxAnimation Animation) const
+bool UFaceFXCharacter::IsCanPlay(const UFaceFXAnim* Animation) const
 {
-	return Actor && Animation && (FX_SUCCEEDED(fxActorCheckCompatibilityWithAnimation(Actor, Animation)));
+	return Animation && FaceFXActor && IsLoaded() && Evaluator->IsCanPlay(Animation);
 }
 
 bool UFaceFXCharacter::IsPlayingAudio() const
@@ -1136,48 +1922,26 @@ void UFaceFXCharacter::SetAudioComponent(UActorComponent* Component)
 	AudioPlayer->SetAudioComponent(Component);
 }
 
-bool UFaceFXCharacter::IsAudioStarted()
+int32 UFaceFXCharacter::GetBoneNameTransformIndex(const FName& Name) const
 {
-	FxChannelFlags ChannelFlags[FACEFX_CHANNELS];
-
-	FxResult Result = fxFrameStateGetChannelFlags(FrameState, ChannelFlags, FACEFX_CHANNELS);
-
-	if (FX_SUCCEEDED(Result))
-	{
-		return (ChannelFlags[0] & FX_CHANNEL_START_AUDIO_BIT) != 0;
-	}
-	else
-	{
-		UE_LOG(LogFaceFX, Warning, TEXT("UFaceFXCharacter::IsAudioStarted. Retrieving channel flags for StartAudio event failed. %s"), *FaceFX::GetFaceFXResultString(Result));
-	}
-
-	return false;
+	return ActorTemplate.IsValid() ? ActorTemplate->GetBoneTransformIndex(Name) : INDEX_NONE;
 }
 
-int32 UFaceFXCharacter::GetBoneNameTransformIndex(const FName& Name) const
+void UFaceFXCharacter::GetBoneNameTransformIndices(const TArray<FName>& Names, TArray<int32>& OutIndices) const
 {
-	if (const FFaceFXIdData* BoneId = FaceFXActor ? FaceFXActor->GetData().Ids.FindByKey(Name) : nullptr)
+	OutIndices.Reset(Names.Num());
+
+	for (const FName& Name : Names)
 	{
-		//get index of the FaceFX bone
-		int32 FaceFXBoneIdx;
-		if (BoneIds.Find(BoneId->Id, FaceFXBoneIdx))
-		{
-			return FaceFXBoneIdx;
-		}
+		OutIndices.Add(GetBoneNameTransformIndex(Name));
 	}
-	return INDEX_NONE;
 }
 
 void UFaceFXCharacter::UnloadCurrentAnim()
 {
-	if (CurrentAnimation)
+	if (Evaluator.IsValid())
 	{
-		FxResult Result = fxAnimationDestroy(&CurrentAnimation, nullptr, nullptr);
-
-		if (!FX_SUCCEEDED(Result))
-		{
-			UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::UnloadCurrentAnim. FaceFX call <fxAnimationDestroy> failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
-		}
+		Evaluator->UnloadAnimation();
 	}
 
 	CurrentAnim = nullptr;
@@ -1199,35 +1963,157 @@ UFaceFXComponent* UFaceFXCharacter::GetOwningFaceFXComponent() const
 	return IsPendingKill() ? nullptr : Cast<UFaceFXComponent>(GetOuter());
 }
 
-void UFaceFXCharacter::UpdateTransforms()
+bool UFaceFXCharacter::PublishOutput()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FaceFXPublishOutput);
+
+	if (!ComputeBoneTransforms())
+	{
+		return false;
+	}
+
+	//flat curves (i.e. pauses or held expressions) produce the same output over and over again. Keep the previous one
+	if (OutputBuffer.HasOutput() && PublishedBoneTransforms.Num() == FaceFXBoneTransforms.Num() && PublishedTrackValues.Num() == TrackValues.Num() &&
+		IsOutputEqual(TrackValues.GetData(), PublishedTrackValues.GetData(), TrackValues.Num()) &&
+		IsOutputEqual(FaceFXBoneTransforms.GetData(), PublishedBoneTransforms.GetData(), FaceFXBoneTransforms.Num()))
+	{
+		INC_DWORD_STAT(STAT_FaceFXUnchangedOutputs);
+		return false;
+	}
+
+	PublishedBoneTransforms = FaceFXBoneTransforms;
+	PublishedTrackValues = TrackValues;
+
+	//write into the next buffer. Readers keep using the previously published one until EndWrite
+	ConvertOutput(OutputBuffer.BeginWrite());
+	OutputBuffer.EndWrite();
+
+	return true;
+}
+
+bool UFaceFXCharacter::ComputeBoneTransforms()
 {
-	SCOPE_CYCLE_COUNTER(STAT_FaceFXUpdateTransforms);
+	return !Evaluator.IsValid() || Evaluator->ComputeBoneTransforms(FaceFXBoneTransforms.GetData(), FaceFXBoneTransforms.Num());
+}
 
+void UFaceFXCharacter::ConvertOutput(FFaceFXCharacterOutput& Output) const
+{
 	const int32 FaceFXBoneTransformsNum = FaceFXBoneTransforms.Num();
-	if (BoneSet && FaceFXBoneTransformsNum > 0)
+	checkSlow(Output.BoneTransforms.Num() == FaceFXBoneTransformsNum && Output.TrackValues.Num() == TrackValues.Num());
+
+	//fill transform buffer
+	FaceFX::ConvertBoneTransforms(FaceFXBoneTransforms.GetData(), Output.BoneTransforms.GetData(), FaceFXBoneTransformsNum);
+
+	if (TrackValues.Num() > 0)
 	{
-		FxResult Result = fxFrameStateComputeBoneTransforms(BoneSet, FrameState, &FaceFXBoneTransforms[0], FaceFXBoneTransformsNum);
+		FMemory::Memcpy(Output.TrackValues.GetData(), TrackValues.GetData(), TrackValues.Num() * sizeof(float));
+	}
+}
 
-		if (!FX_SUCCEEDED(Result))
-		{
-			UE_LOG(LogFaceFX, Error, TEXT("UFaceFXCharacter::UpdateTransforms. Calculating bone transforms failed. %s. Asset: %s"), *FaceFX::GetFaceFXResultString(Result), *GetNameSafe(FaceFXActor));
-			return;
-		}
+void UFaceFXCharacter::PushInterpolationKey()
+{
+	//the previous latest key becomes the oldest one and gets overwritten by the new key
+	Swap(InterpolationKeys[0], InterpolationKeys[1]);
+	InterpolationKeyTimes[0] = InterpolationKeyTimes[1];
 
-		//fill transform buffer
-		for (int32 i=0; i<FaceFXBoneTransformsNum; ++i)
-		{
-			const FxBoneTransform& XForm = FaceFXBoneTransforms[i];
+	FFaceFXCharacterOutput& Key = InterpolationKeys[1];
+	Key.BoneTransforms.SetNumUninitialized(FaceFXBoneTransforms.Num(), false);
+	Key.TrackValues.SetNumUninitialized(TrackValues.Num(), false);
+	ConvertOutput(Key);
+	InterpolationKeyTimes[1] = CurrentTime;
 
-			// Revert rotaiton.z and translation.y to convert from FaceFX to UE4 coordinates.
-			BoneTransforms[i].SetComponents(
-				FQuat(XForm.rotation.x, -XForm.rotation.y, XForm.rotation.z, XForm.rotation.w),
-				FVector(XForm.translation.x, -XForm.translation.y, XForm.translation.z),
-				FVector(XForm.scale.x, XForm.scale.y, XForm.scale.z));
-		}
+	if (NumInterpolationKeys == 0)
+	{
+		//no history yet. Start off with a constant output
+		InterpolationKeys[0] = Key;
+		InterpolationKeyTimes[0] = CurrentTime;
+	}
+
+	NumInterpolationKeys = 2;
+
+	//equal keys produce the same output regardless of the interpolation time. It only needs to get published once
+	const FFaceFXCharacterOutput& KeyFrom = InterpolationKeys[0];
+
+	bIsInterpolationKeysEqual = KeyFrom.BoneTransforms.Num() == Key.BoneTransforms.Num() && KeyFrom.TrackValues.Num() == Key.TrackValues.Num() &&
+		IsOutputEqual(KeyFrom.TrackValues.GetData(), Key.TrackValues.GetData(), Key.TrackValues.Num()) &&
+		IsOutputEqual(KeyFrom.BoneTransforms.GetData(), Key.BoneTransforms.GetData(), Key.BoneTransforms.Num());
+	bIsInterpolatedOutputSettled = false;
+}
+
+bool UFaceFXCharacter::PublishInterpolatedOutput()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FaceFXPublishOutput);
+
+	check(NumInterpolationKeys > 0);
+
+	if (bIsInterpolationKeysEqual && bIsInterpolatedOutputSettled && OutputBuffer.HasOutput())
+	{
+		INC_DWORD_STAT(STAT_FaceFXUnchangedOutputs);
+		return false;
+	}
+
+	const FFaceFXCharacterOutput& KeyFrom = InterpolationKeys[0];
+	const FFaceFXCharacterOutput& KeyTo = InterpolationKeys[1];
+
+	//we blend towards the latest evaluation within one interval, which delays the output by that interval
+	const float KeyDelta = InterpolationKeyTimes[1] - InterpolationKeyTimes[0];
+	const float Alpha = KeyDelta > SMALL_NUMBER ? FMath::Clamp((CurrentTime - InterpolationKeyTimes[1]) / KeyDelta, 0.F, 1.F) : 1.F;
+
+	const int32 NumTrackValues = TrackValues.Num();
+	for (int32 i=0; i<NumTrackValues; ++i)
+	{
+		TrackValues[i] = FMath::Lerp(KeyFrom.TrackValues[i], KeyTo.TrackValues[i], Alpha);
+	}
+
+	FFaceFXCharacterOutput& Output = OutputBuffer.BeginWrite();
+
+	const int32 NumBoneTransforms = Output.BoneTransforms.Num();
+	for (int32 i=0; i<NumBoneTransforms; ++i)
+	{
+		Output.BoneTransforms[i].Blend(KeyFrom.BoneTransforms[i], KeyTo.BoneTransforms[i], Alpha);
+	}
+
+	if (NumTrackValues > 0)
+	{
+		FMemory::Memcpy(Output.TrackValues.GetData(), TrackValues.GetData(), NumTrackValues * sizeof(float));
+	}
+
+	OutputBuffer.EndWrite();
 
-		bIsDirty = false;
+	bIsInterpolatedOutputSettled = bIsInterpolationKeysEqual;
+
+	return true;
+}
+
+void UFaceFXCharacter::ResetEvaluationHistory()
+{
+	NumInterpolationKeys = 0;
+	bIsInterpolationKeysEqual = false;
+	bIsInterpolatedOutputSettled = false;
+	PublishedBoneTransforms.Reset();
+	PublishedTrackValues.Reset();
+	TimeSinceEvaluation = 0.F;
+	bForceEvaluation = true;
+}
+
+void UFaceFXCharacter::SetEvaluationRate(float Interval, bool IsInterpolate, bool IsFreezeOutput)
+{
+	EvaluationInterval = FMath::Max(Interval, 0.F);
+
+	if (!IsInterpolate || IsFreezeOutput)
+	{
+		//history becomes outdated while not interpolating
+		NumInterpolationKeys = 0;
 	}
+
+	if (bFreezeOutput && !IsFreezeOutput)
+	{
+		//unfreeze right away
+		bForceEvaluation = true;
+	}
+
+	bInterpolateOutput = IsInterpolate && EvaluationInterval > 0.F;
+	bFreezeOutput = IsFreezeOutput;
 }
 
 
@@ -0,0 +1,440 @@
+/*******************************************************************************
+  The MIT License (MIT)
+  Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "FaceFXCharacterSubsystem.h"
+#include "FaceFX.h"
+#include "FaceFXCharacter.h"
+#include "Animation/FaceFXComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Tick Batch"), STAT_FaceFXTickBatch, STATGROUP_FACEFX);
+DECLARE_CYCLE_STAT(TEXT("Tick Batch - Evaluate"), STAT_FaceFXTickBatchEvaluate, STATGROUP_FACEFX);
+DECLARE_CYCLE_STAT(TEXT("Tick Batch - Game Thread"), STAT_FaceFXTickBatchGameThread, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ticked Characters"), STAT_FaceFXTickedCharacters, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Reduced Rate Characters"), STAT_FaceFXReducedRateCharacters, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Frozen Characters"), STAT_FaceFXFrozenCharacters, STATGROUP_FACEFX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Budget Deferred Characters"), STAT_FaceFXDeferredCharacters, STATGROUP_FACEFX);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Budget (ms)"), STAT_FaceFXBudget, STATGROUP_FACEFX);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Budget Used (ms)"), STAT_FaceFXBudgetUsed, STATGROUP_FACEFX);
+
+//Indicator if the character evaluation shall be spread across worker threads. 0 = game thread only, 1 = parallel (Default)
+static int32 FaceFXParallelTick = 1;
+FAutoConsoleVariableRef CVarFaceFXParallelTick(TEXT("FaceFX.ParallelTick"), FaceFXParallelTick, TEXT("Sets if the FaceFX character evaluation is spread across worker threads. 0=Game thread only, 1=Parallel (Default)"));
+
+//The minimum number of characters that need to get ticked within a frame before the evaluation is spread across worker threads
+static int32 FaceFXParallelTickMinBatchSize = 4;
+FAutoConsoleVariableRef CVarFaceFXParallelTickMinBatchSize(TEXT("FaceFX.ParallelTickMinBatchSize"), FaceFXParallelTickMinBatchSize, TEXT("Sets the minimum number of ticking FaceFX characters required to spread the evaluation across worker threads. Default: 4"));
+
+//Indicator if the characters evaluation rate gets reduced based on their screen size and visibility. 0 = evaluate every frame, 1 = use the update rate settings of the FaceFX components (Default)
+static int32 FaceFXUpdateRateEnable = 1;
+FAutoConsoleVariableRef CVarFaceFXUpdateRateEnable(TEXT("FaceFX.UpdateRate.Enable"), FaceFXUpdateRateEnable, TEXT("Sets if FaceFX characters reduce their evaluation rate based on screen size and visibility. 0=Evaluate every frame, 1=Use the update rate settings of the FaceFX components (Default)"));
+
+//Indicator if outputs get interpolated between evaluations. 0 = never, 1 = use the update rate settings of the FaceFX components (Default)
+static int32 FaceFXUpdateRateInterpolate = 1;
+FAutoConsoleVariableRef CVarFaceFXUpdateRateInterpolate(TEXT("FaceFX.UpdateRate.Interpolate"), FaceFXUpdateRateInterpolate, TEXT("Sets if FaceFX characters with a reduced evaluation rate interpolate their outputs. 0=Never, 1=Use the update rate settings of the FaceFX components (Default)"));
+
+//The global scale applied to all computed screen sizes. Values below 1 favor lower update rates
+static float FaceFXUpdateRateScreenSizeScale = 1.F;
+FAutoConsoleVariableRef CVarFaceFXUpdateRateScreenSizeScale(TEXT("FaceFX.UpdateRate.ScreenSizeScale"), FaceFXUpdateRateScreenSizeScale, TEXT("Sets the scale applied to the screen sizes of FaceFX characters when selecting their update rate. Default: 1.0"));
+
+//The number of evaluations per second of frozen characters to keep events and audio in sync
+static float FaceFXUpdateRateHeartbeat = 4.F;
+FAutoConsoleVariableRef CVarFaceFXUpdateRateHeartbeat(TEXT("FaceFX.UpdateRate.HeartbeatRate"), FaceFXUpdateRateHeartbeat, TEXT("Sets the number of evaluations per second of frozen FaceFX characters which only process events and audio. Default: 4"));
+
+//The time in seconds a skelmesh counts as recently rendered
+static float FaceFXUpdateRateRenderTolerance = .2F;
+FAutoConsoleVariableRef CVarFaceFXUpdateRateRenderTolerance(TEXT("FaceFX.UpdateRate.RenderTolerance"), FaceFXUpdateRateRenderTolerance, TEXT("Sets the time in seconds after its last render in which a skelmesh counts as visible for the FaceFX update rate selection. Default: 0.2"));
+
+//The evaluation budget per frame in milliseconds. Negative values use the project settings (Default), 0 disables the budget
+static float FaceFXBudgetMilliseconds = -1.F;
+FAutoConsoleVariableRef CVarFaceFXBudgetMilliseconds(TEXT("FaceFX.Budget.Milliseconds"), FaceFXBudgetMilliseconds, TEXT("Sets the time in milliseconds all FaceFX characters may spend on evaluation per frame. <0=Use the project settings (Default), 0=Unlimited"));
+
+//The number of most significant characters that always get evaluated regardless of the budget
+static int32 FaceFXBudgetMinCharacters = 1;
+FAutoConsoleVariableRef CVarFaceFXBudgetMinCharacters(TEXT("FaceFX.Budget.MinCharacters"), FaceFXBudgetMinCharacters, TEXT("Sets the number of most significant FaceFX characters that always get evaluated regardless of the budget. Default: 1"));
+
+//The distance in which speaking characters count as audible
+static float FaceFXBudgetAudibleDistance = 2000.F;
+FAutoConsoleVariableRef CVarFaceFXBudgetAudibleDistance(TEXT("FaceFX.Budget.AudibleDistance"), FaceFXBudgetAudibleDistance, TEXT("Sets the distance to the closest view in which speaking FaceFX characters count as audible for the budget significance. Default: 2000"));
+
+//The half angle of the view cone in which characters count as focused by the player
+static float FaceFXBudgetFocusAngle = 10.F;
+FAutoConsoleVariableRef CVarFaceFXBudgetFocusAngle(TEXT("FaceFX.Budget.FocusAngle"), FaceFXBudgetFocusAngle, TEXT("Sets the half angle in degrees of the view cone in which FaceFX characters count as focused for the budget significance. Default: 10"));
+
+//The significance a character gains per tick its evaluation got deferred
+static float FaceFXBudgetAgeWeight = .25F;
+FAutoConsoleVariableRef CVarFaceFXBudgetAgeWeight(TEXT("FaceFX.Budget.AgeWeight"), FaceFXBudgetAgeWeight, TEXT("Sets the significance a FaceFX character gains per tick its evaluation got deferred by the budget. Default: 0.25"));
+
+namespace
+{
+	//The significance weights of the budget. The screen size adds up to 1
+	const float SignificanceSpeaking = 4.F;
+	const float SignificanceAudible = 2.F;
+	const float SignificanceFocused = 1.F;
+}
+
+UFaceFXCharacterSubsystem* UFaceFXCharacterSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UFaceFXCharacterSubsystem>() : nullptr;
+}
+
+void UFaceFXCharacterSubsystem::Deinitialize()
+{
+	for (UFaceFXCharacter* Character : Characters)
+	{
+		Character->Subsystem.Reset();
+		Character->SubsystemIndex = INDEX_NONE;
+	}
+
+	Characters.Empty();
+	TickBatch.Empty();
+	Schedule.Empty();
+
+	Super::Deinitialize();
+}
+
+void UFaceFXCharacterSubsystem::RegisterCharacter(UFaceFXCharacter* Character)
+{
+	check(IsInGameThread());
+	check(Character);
+	checkf(Character->SubsystemIndex == INDEX_NONE, TEXT("Internal Error: FaceFX character is already registered."));
+
+	Character->Subsystem = this;
+	Character->SubsystemIndex = Characters.Add(Character);
+}
+
+void UFaceFXCharacterSubsystem::UnregisterCharacter(UFaceFXCharacter* Character)
+{
+	check(IsInGameThread());
+	check(Character);
+
+	const int32 Index = Character->SubsystemIndex;
+	if (!Characters.IsValidIndex(Index) || Characters[Index] != Character)
+	{
+		return;
+	}
+
+	//keep the list dense. The last character takes over the free slot
+	Characters.RemoveAtSwap(Index, 1, false);
+	if (Characters.IsValidIndex(Index))
+	{
+		Characters[Index]->SubsystemIndex = Index;
+	}
+
+	//characters reset or destroyed by listeners of other characters of the running batch are skipped
+	const int32 BatchIdx = TickBatch.Find(Character);
+	if (BatchIdx != INDEX_NONE)
+	{
+		TickBatch[BatchIdx] = nullptr;
+	}
+
+	Character->Subsystem.Reset();
+	Character->SubsystemIndex = INDEX_NONE;
+}
+
+void UFaceFXCharacterSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FaceFXTickBatch);
+
+	//gather all characters that need to get ticked this frame
+	TickBatch.Reset();
+	Schedule.Reset();
+	GatherViewPoints();
+
+	const bool IsBudgetActive = GetEvaluationBudget() > 0.F;
+
+	for (UFaceFXCharacter* Character : Characters)
+	{
+		//LOD changes apply to idle characters and unchanged outputs as well
+		Character->UpdateLODMask();
+
+		if (Character->IsTickable())
+		{
+			const FViewMetrics Metrics = ComputeViewMetrics(Character);
+			UpdateEvaluationRate(Character, Metrics);
+
+			if (IsBudgetActive)
+			{
+				Schedule.Add(FScheduleEntry(Character, ComputeSignificance(Character, Metrics)));
+			}
+
+			TickBatch.Add(Character);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_FaceFXTickedCharacters, TickBatch.Num());
+
+	ScheduleEvaluations(DeltaTime);
+
+	if (TickBatch.Num() == 0)
+	{
+		return;
+	}
+
+	//evaluate all characters. Each evaluation only touches the state of its own character
+	{
+		SCOPE_CYCLE_COUNTER(STAT_FaceFXTickBatchEvaluate);
+
+		const bool bForceSingleThread = FaceFXParallelTick == 0 || TickBatch.Num() < FaceFXParallelTickMinBatchSize;
+		ParallelFor(TickBatch.Num(), [this, DeltaTime](int32 Idx)
+		{
+			TickBatch[Idx]->TickEvaluate(DeltaTime);
+		}, bForceSingleThread);
+	}
+
+	//process everything that needs the game thread within a single pass
+	{
+		SCOPE_CYCLE_COUNTER(STAT_FaceFXTickBatchGameThread);
+
+		for (int32 Idx = 0; Idx < TickBatch.Num(); ++Idx)
+		{
+			if (UFaceFXCharacter* Character = TickBatch[Idx])
+			{
+				Character->TickGameThread();
+			}
+		}
+	}
+
+	//don't keep pointers to characters beyond the tick
+	TickBatch.Reset();
+}
+
+void UFaceFXCharacterSubsystem::GatherViewPoints()
+{
+	ViewPoints.Reset();
+
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		const APlayerCameraManager* CameraManager = PlayerController && PlayerController->IsLocalController() ? PlayerController->PlayerCameraManager : nullptr;
+
+		if (CameraManager)
+		{
+			const float HalfFOV = FMath::DegreesToRadians(FMath::Clamp(CameraManager->GetFOVAngle(), 1.F, 170.F) * .5F);
+			ViewPoints.Add(FViewPoint(CameraManager->GetCameraLocation(), CameraManager->GetCameraRotation().Vector(), 1.F / FMath::Tan(HalfFOV)));
+		}
+	}
+}
+
+UFaceFXCharacterSubsystem::FViewMetrics UFaceFXCharacterSubsystem::ComputeViewMetrics(const UFaceFXCharacter* Character) const
+{
+	FViewMetrics Metrics;
+
+	const UFaceFXComponent* FaceFXComp = Character->GetOwningFaceFXComponent();
+	const USkeletalMeshComponent* SkelMeshComp = FaceFXComp ? FaceFXComp->GetSkelMeshTarget(Character) : nullptr;
+
+	if (!SkelMeshComp)
+	{
+		return Metrics;
+	}
+
+	Metrics.UpdateRateSettings = &FaceFXComp->UpdateRateSettings;
+	Metrics.bWasRecentlyRendered = SkelMeshComp->WasRecentlyRendered(FaceFXUpdateRateRenderTolerance);
+
+	if (ViewPoints.Num() == 0)
+	{
+		//no views to measure against (i.e. editor viewports) -> consider as fully visible
+		Metrics.ScreenSize = 1.F;
+		return Metrics;
+	}
+
+	//use the largest screen size and closest distance of all views
+	const FBoxSphereBounds& Bounds = SkelMeshComp->Bounds;
+	const float FocusCos = FMath::Cos(FMath::DegreesToRadians(FaceFXBudgetFocusAngle));
+
+	Metrics.Distance = BIG_NUMBER;
+
+	for (const FViewPoint& ViewPoint : ViewPoints)
+	{
+		const FVector ToBounds = Bounds.Origin - ViewPoint.Location;
+		const float Distance = FMath::Max(ToBounds.Size(), 1.F);
+
+		Metrics.ScreenSize = FMath::Max(Metrics.ScreenSize, Bounds.SphereRadius * ViewPoint.ScreenScale / Distance);
+		Metrics.Distance = FMath::Min(Metrics.Distance, Distance);
+		Metrics.bIsFocused |= FVector::DotProduct(ViewPoint.Direction, ToBounds / Distance) >= FocusCos;
+	}
+
+	Metrics.ScreenSize *= FaceFXUpdateRateScreenSizeScale;
+
+	return Metrics;
+}
+
+void UFaceFXCharacterSubsystem::UpdateEvaluationRate(UFaceFXCharacter* Character, const FViewMetrics& Metrics) const
+{
+	const FFaceFXUpdateRateSettings* Settings = Metrics.UpdateRateSettings;
+
+	if (!FaceFXUpdateRateEnable || !Settings || !Settings->bIsEnabled)
+	{
+		Character->SetEvaluationRate(0.F, false, false);
+		return;
+	}
+
+	//negative update rate means full rate
+	float UpdateRate = -1.F;
+
+	if (!Metrics.bWasRecentlyRendered)
+	{
+		UpdateRate = Settings->NotRenderedUpdateRate;
+	}
+	else if (Metrics.ScreenSize < Settings->FullRateScreenSize)
+	{
+		UpdateRate = 0.F;
+		for (const FFaceFXUpdateRateLevel& Level : Settings->Levels)
+		{
+			if (Metrics.ScreenSize >= Level.MinScreenSize)
+			{
+				UpdateRate = Level.UpdateRate;
+				break;
+			}
+		}
+	}
+
+	if (UpdateRate < 0.F)
+	{
+		Character->SetEvaluationRate(0.F, false, false);
+		return;
+	}
+
+	//frozen characters keep evaluating with the heartbeat rate to process events and audio
+	const bool IsFreeze = UpdateRate <= 0.F;
+	const float Interval = 1.F / FMath::Max(IsFreeze ? FaceFXUpdateRateHeartbeat : UpdateRate, KINDA_SMALL_NUMBER);
+
+	Character->SetEvaluationRate(Interval, FaceFXUpdateRateInterpolate && Settings->bIsInterpolate, IsFreeze);
+
+	if (IsFreeze)
+	{
+		INC_DWORD_STAT(STAT_FaceFXFrozenCharacters);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_FaceFXReducedRateCharacters);
+	}
+}
+
+float UFaceFXCharacterSubsystem::ComputeSignificance(const UFaceFXCharacter* Character, const FViewMetrics& Metrics)
+{
+	float Significance = FMath::Clamp(Metrics.ScreenSize, 0.F, 1.F);
+
+	if (Character->IsPlayingAudio())
+	{
+		Significance += SignificanceSpeaking;
+
+		if (Metrics.Distance <= FaceFXBudgetAudibleDistance)
+		{
+			Significance += SignificanceAudible;
+		}
+	}
+
+	if (Metrics.bIsFocused)
+	{
+		Significance += SignificanceFocused;
+	}
+
+	//deferred characters age into priority so nobody starves
+	return Significance + Character->NumDeferredTicks * FaceFXBudgetAgeWeight;
+}
+
+float UFaceFXCharacterSubsystem::GetEvaluationBudget()
+{
+	return FaceFXBudgetMilliseconds >= 0.F ? FaceFXBudgetMilliseconds : UFaceFXConfig::Get().GetEvaluationBudget();
+}
+
+void UFaceFXCharacterSubsystem::ScheduleEvaluations(float DeltaTime)
+{
+	const float Budget = GetEvaluationBudget();
+	SET_FLOAT_STAT(STAT_FaceFXBudget, Budget);
+
+	if (Budget <= 0.F)
+	{
+		return;
+	}
+
+	//most significant first
+	Schedule.Sort([](const FScheduleEntry& A, const FScheduleEntry& B)
+	{
+		return A.Significance > B.Significance;
+	});
+
+	float BudgetUsed = 0.F;
+	int32 NumScheduled = 0;
+	int32 NumDeferred = 0;
+
+	for (const FScheduleEntry& Entry : Schedule)
+	{
+		UFaceFXCharacter* Character = Entry.Character;
+
+		if (!Character->IsEvaluationDue(DeltaTime))
+		{
+			//won't evaluate this tick anyway
+			continue;
+		}
+
+		//enforced evaluations (playback start, animation end) always run even if they exceed the budget
+		const float Cost = Character->EvaluationCost;
+		if (Character->IsEvaluationEnforced(DeltaTime) || NumScheduled < FaceFXBudgetMinCharacters || BudgetUsed + Cost <= Budget)
+		{
+			BudgetUsed += Cost;
+			++NumScheduled;
+			Character->NumDeferredTicks = 0;
+		}
+		else
+		{
+			Character->bDeferEvaluation = true;
+			++Character->NumDeferredTicks;
+			++NumDeferred;
+		}
+	}
+
+	SET_FLOAT_STAT(STAT_FaceFXBudgetUsed, BudgetUsed);
+	SET_DWORD_STAT(STAT_FaceFXDeferredCharacters, NumDeferred);
+}
+
+bool UFaceFXCharacterSubsystem::IsTickable() const
+{
+	return Characters.Num() > 0;
+}
+
+ETickableTickType UFaceFXCharacterSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* UFaceFXCharacterSubsystem::GetTickableGameObjectWorld() const
+{
+	//tick only within our own world. Prevents ticking twice per frame when running multiple PIE instances
+	return GetWorld();
+}
+
+TStatId UFaceFXCharacterSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFaceFXCharacterSubsystem, STATGROUP_Tickables);
+}
@@ -292,6 +292,12 @@ void FFaceFXAnimationExecutionToken::Execute(FPersistentEvaluationData& Persiste
 
 			if (SkelMeshTarget)
 			{
+				//evaluate the requested jump right away so the refreshed bones already pick it up
+				if (UFaceFXCharacter* Character = FaceFXComponent->GetCharacter(SkelMeshTarget))
+				{
+					Character->FlushRequests();
+				}
+
 				//enforce an update on the bones to trigger blend nodes
 				SkelMeshTarget->RefreshBoneTransforms();
 			}
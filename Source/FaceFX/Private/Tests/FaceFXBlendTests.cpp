@@ -0,0 +1,178 @@
+/*******************************************************************************
+The MIT License (MIT)
+Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Animation/AnimNode_BlendFaceFXAnimation.h"
+#include "Animation/Skeleton.h"
+#include "BonePose.h"
+#include "ReferenceSkeleton.h"
+#include "FaceFXConfig.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/Package.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFaceFXBlendLocalSpaceTest, "FaceFX.Animation.BlendLocalSpace", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FFaceFXBlendLocalSpaceTest::RunTest(const FString& Parameters)
+{
+	//synthetic skeleton as binary tree with two of three bones being driven by FaceFX
+	const int32 NumBones = 255;
+
+	USkeleton* Skeleton = NewObject<USkeleton>(GetTransientPackage());
+	{
+		FReferenceSkeletonModifier Modifier(Skeleton);
+		for (int32 i = 0; i < NumBones; ++i)
+		{
+			const FTransform RefTM(FRotator(float(i * 7 % 90), float(i * 13 % 90), float(i * 3 % 45)), FVector(float(i % 5 + 1), float(i % 3), 2.f));
+			Modifier.Add(FMeshBoneInfo(*FString::Printf(TEXT("Bone%d"), i), FString::Printf(TEXT("Bone%d"), i), i > 0 ? (i - 1) / 2 : INDEX_NONE), RefTM);
+		}
+	}
+
+	TArray<FBoneIndexType> RequiredBones;
+	for (int32 i = 0; i < NumBones; ++i)
+	{
+		RequiredBones.Add(FBoneIndexType(i));
+	}
+
+	FBoneContainer BoneContainer(RequiredBones, FCurveEvaluationOption(false), *Skeleton);
+
+	FCompactPose InputPose;
+	InputPose.SetBoneContainer(&BoneContainer);
+	InputPose.ResetToRefPose();
+
+	FAnimNode_BlendFaceFXAnimation Node;
+	Node.TargetBlendTransform.AddZeroed(1);
+
+	for (int32 i = 0; i < NumBones; ++i)
+	{
+		if (i % 3 != 0)
+		{
+			Node.CompactPoseEntries.Add(FAnimNode_BlendFaceFXAnimation::FCompactPoseEntry(FCompactPoseBoneIndex(i), Node.FaceFXBoneTransforms.Num()));
+			Node.FaceFXBoneTransforms.AddDefaulted();
+		}
+	}
+
+	//blends into a fresh copy of the input pose that got changed in component space by an upstream node
+	auto InitOutputPose = [&InputPose](FCSPose<FCompactPose>& OutPose)
+	{
+		OutPose.InitPose(InputPose);
+
+		TArray<FBoneTransform> UpstreamTransforms;
+		UpstreamTransforms.Add(FBoneTransform(FCompactPoseBoneIndex(2), FTransform(FRotator(20.f, 0.f, 10.f), FVector(3.f, 1.f, 0.f))));
+		OutPose.SafeSetCSBoneTransforms(UpstreamTransforms);
+	};
+
+	//the component space transforms of all bones after blending
+	auto Blend = [&Node, &InitOutputPose](bool IsLocalSpace, float BlendWeight, TArray<FTransform>& OutTransforms)
+	{
+		FCSPose<FCompactPose> Pose;
+		InitOutputPose(Pose);
+
+		if (IsLocalSpace)
+		{
+			Node.BlendLocalSpace(Pose, BlendWeight);
+		}
+		else
+		{
+			Node.BlendComponentSpace(Pose, BlendWeight);
+		}
+
+		OutTransforms.Reset();
+		for (const FCompactPoseBoneIndex BoneIndex : Pose.GetPose().ForEachBoneIndex())
+		{
+			OutTransforms.Add(Pose.GetComponentSpaceTransform(BoneIndex));
+		}
+	};
+
+	const EFaceFXBlendMode BlendModes[] = { EFaceFXBlendMode::Replace, EFaceFXBlendMode::Additive };
+
+	for (const EFaceFXBlendMode BlendMode : BlendModes)
+	{
+		const bool IsReplace = BlendMode == EFaceFXBlendMode::Replace;
+		const TCHAR* BlendModeName = IsReplace ? TEXT("Replace") : TEXT("Additive");
+
+		Node.BlendMode = BlendMode;
+		for (int32 i = 0; i < Node.FaceFXBoneTransforms.Num(); ++i)
+		{
+			//additive transforms are offsets and add to the scale
+			Node.FaceFXBoneTransforms[i] = IsReplace ?
+				FTransform(FRotator(float(i % 30), float(i % 17), 5.f), FVector(1.f, float(i % 4), 2.f)) :
+				FTransform(FRotator(float(i % 5), 0.f, 1.f).Quaternion(), FVector(.1f, 0.f, float(i % 3) * .1f), FVector::ZeroVector);
+		}
+
+		//both paths need to produce the same pose at full alpha
+		TArray<FTransform> ComponentSpaceResult;
+		TArray<FTransform> LocalSpaceResult;
+		Blend(false, 1.f, ComponentSpaceResult);
+		Blend(true, 1.f, LocalSpaceResult);
+
+		if (TestEqual(FString::Printf(TEXT("%s. Number of bones"), BlendModeName), LocalSpaceResult.Num(), ComponentSpaceResult.Num()))
+		{
+			for (int32 i = 0; i < LocalSpaceResult.Num(); ++i)
+			{
+				if (!LocalSpaceResult[i].Equals(ComponentSpaceResult[i], 1.e-3f))
+				{
+					AddError(FString::Printf(TEXT("%s. Bone %d differs. Component space: %s. Local space: %s"), BlendModeName, i, *ComponentSpaceResult[i].ToString(), *LocalSpaceResult[i].ToString()));
+				}
+			}
+		}
+
+		//measure the cost per blended bone including the component space transforms of the whole pose required by the following nodes
+		const int32 NumIterations = 200;
+		double Seconds[2] = { 0., 0. };
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			for (int32 Path = 0; Path < 2; ++Path)
+			{
+				FCSPose<FCompactPose> Pose;
+				InitOutputPose(Pose);
+
+				const double StartTime = FPlatformTime::Seconds();
+
+				if (Path == 0)
+				{
+					Node.BlendComponentSpace(Pose, 1.f);
+				}
+				else
+				{
+					Node.BlendLocalSpace(Pose, 1.f);
+				}
+
+				for (const FCompactPoseBoneIndex BoneIndex : Pose.GetPose().ForEachBoneIndex())
+				{
+					Pose.GetComponentSpaceTransform(BoneIndex);
+				}
+
+				Seconds[Path] += FPlatformTime::Seconds() - StartTime;
+			}
+		}
+
+		const double NanosecondsPerBone = 1.e9 / (double(NumIterations) * Node.CompactPoseEntries.Num());
+		AddInfo(FString::Printf(TEXT("%s. %d of %d bones blended. Component space: %.1f ns per bone. Local space: %.1f ns per bone"), BlendModeName, Node.CompactPoseEntries.Num(), NumBones, Seconds[0] * NanosecondsPerBone, Seconds[1] * NanosecondsPerBone));
+	}
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
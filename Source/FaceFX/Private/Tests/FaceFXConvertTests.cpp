@@ -0,0 +1,122 @@
+/*******************************************************************************
+The MIT License (MIT)
+Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "FaceFX.h"
+#include "HAL/PlatformTime.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFaceFXConvertBoneTransformsTest, "FaceFX.Animation.ConvertBoneTransforms", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FFaceFXConvertBoneTransformsTest::RunTest(const FString& Parameters)
+{
+	//a crowd of characters with a face rig each
+	const int32 NumBones = 160;
+	const int32 NumCharacters = 32;
+	const int32 NumTransforms = NumBones * NumCharacters;
+
+	TArray<FxBoneTransform> Source;
+	Source.SetNumUninitialized(NumTransforms);
+
+	for (int32 i = 0; i < NumTransforms; ++i)
+	{
+		const FQuat Rotation = FRotator(float(i * 7 % 90), float(i * 13 % 90), float(i * 3 % 45)).Quaternion();
+
+		FxBoneTransform& XForm = Source[i];
+		XForm.rotation.x = Rotation.X;
+		XForm.rotation.y = Rotation.Y;
+		XForm.rotation.z = Rotation.Z;
+		XForm.rotation.w = Rotation.W;
+		XForm.translation.x = float(i % 5);
+		XForm.translation.y = float(i % 3) - 1.f;
+		XForm.translation.z = 2.f;
+		XForm.scale.x = 1.f;
+		XForm.scale.y = float(i % 2) + 1.f;
+		XForm.scale.z = 1.f;
+	}
+
+	//the per component conversion the vectorized path replaces
+	auto ConvertScalar = [](const FxBoneTransform* RESTRICT InSource, FTransform* RESTRICT OutTarget, int32 Num)
+	{
+		for (int32 i = 0; i < Num; ++i)
+		{
+			const FxBoneTransform& XForm = InSource[i];
+			OutTarget[i].SetComponents(
+				FQuat(XForm.rotation.x, -XForm.rotation.y, XForm.rotation.z, XForm.rotation.w),
+				FVector(XForm.translation.x, -XForm.translation.y, XForm.translation.z),
+				FVector(XForm.scale.x, XForm.scale.y, XForm.scale.z));
+		}
+	};
+
+	TArray<FTransform> Expected;
+	TArray<FTransform> Converted;
+	Expected.SetNum(NumTransforms);
+	Converted.SetNum(NumTransforms);
+
+	ConvertScalar(Source.GetData(), Expected.GetData(), NumTransforms);
+	FaceFX::ConvertBoneTransforms(Source.GetData(), Converted.GetData(), NumTransforms);
+
+	for (int32 i = 0; i < NumTransforms; ++i)
+	{
+		if (!Converted[i].Equals(Expected[i], 0.f))
+		{
+			AddError(FString::Printf(TEXT("Transform %d differs. Expected: %s. Converted: %s"), i, *Expected[i].ToString(), *Converted[i].ToString()));
+			break;
+		}
+	}
+
+	//measure the cost per bone the way the characters convert their buffers, one call per character
+	const int32 NumIterations = 200;
+	double Seconds[2] = { 0., 0. };
+
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		for (int32 Path = 0; Path < 2; ++Path)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+
+			for (int32 Character = 0; Character < NumCharacters; ++Character)
+			{
+				const int32 Offset = Character * NumBones;
+
+				if (Path == 0)
+				{
+					ConvertScalar(Source.GetData() + Offset, Converted.GetData() + Offset, NumBones);
+				}
+				else
+				{
+					FaceFX::ConvertBoneTransforms(Source.GetData() + Offset, Converted.GetData() + Offset, NumBones);
+				}
+			}
+
+			Seconds[Path] += FPlatformTime::Seconds() - StartTime;
+		}
+	}
+
+	const double NanosecondsPerBone = 1.e9 / (double(NumIterations) * NumTransforms);
+	AddInfo(FString::Printf(TEXT("%d characters with %d bones. Scalar: %.2f ns per bone. ConvertBoneTransforms: %.2f ns per bone"), NumCharacters, NumBones, Seconds[0] * NanosecondsPerBone, Seconds[1] * NanosecondsPerBone));
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
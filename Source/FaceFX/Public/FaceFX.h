@@ -30,6 +30,8 @@ DECLARE_STATS_GROUP(TEXT("FaceFX"),STATGROUP_FACEFX, STATCAT_Advance);
 
 class UFaceFXAnim;
 struct FFaceFXAnimData;
+struct FFaceFXActorData;
+struct FFaceFXBakedAnimData;
 
 struct FACEFX_API FaceFX
 {
@@ -58,9 +60,31 @@ struct FACEFX_API FaceFX
 	* @returns The FaceFX handle if succeeded, else nullptr
 	*/
 	static FxAnimation LoadAnimation(const FFaceFXAnimData& AnimData);
+
+	/**
+	* Gets if a set of animation data can be loaded without data validation. See FACEFX_TRUST_VALIDATED_DATA
+	* @param AnimData The data to check
+	* @returns True if the data passed the validation during cook and did not change since, else false
+	*/
+	static bool IsTrustedData(const FFaceFXAnimData& AnimData);
+
+	/**
+	* Gets if a set of actor data can be loaded without data validation. See FACEFX_TRUST_VALIDATED_DATA
+	* @param ActorData The data to check
+	* @returns True if the data passed the validation during cook and did not change since, else false
+	*/
+	static bool IsTrustedData(const FFaceFXActorData& ActorData);
+
+	/**
+	* Computes the start and end time of a set of animation data and stores them within the data.
+	* This parses the raw data and is meant to be called once during import or when upgrading older assets
+	* @param AnimData The data to compute the bounds for
+	* @returns True if succeeded, else false
+	*/
+	static bool ComputeAnimationBounds(FFaceFXAnimData& AnimData);
 	
 	/**
-	* Gets the start and end time of a given animation
+	* Gets the start and end time of a given animation. Uses the bounds stored within the asset data
 	* @param pAnimation The animation to fetch the bounds for
 	* @param Start The start time if call succeeded
 	* @param End The end time if call succeeded
@@ -68,6 +92,61 @@ struct FACEFX_API FaceFX
 	*/
 	static bool GetAnimationBounds(const UFaceFXAnim* pAnimation, float& Start, float& End);
 
+	/**
+	* Converts a set of FaceFX bone transforms into UE4 coordinates. Uses vector registers when the engine uses vectorized transforms.
+	* Each character converts its own transforms. See the FaceFX.Animation.ConvertBoneTransforms automation test for the cost per bone
+	* @param Source The FaceFX bone transforms
+	* @param Target The target transforms. Must hold at least Num entries
+	* @param Num The number of transforms to convert
+	*/
+	static void ConvertBoneTransforms(const FxBoneTransform* RESTRICT Source, FTransform* RESTRICT Target, int32 Num);
+
+	/**
+	* Gets the blend mode a FaceFX actor asset is played with
+	* @param Dataset The actor asset
+	* @returns The blend mode of the asset or the global default blend mode
+	*/
+	static EFaceFXBlendMode GetBlendMode(const UFaceFXActor* Dataset);
+
+	/**
+	* Gets the creation flags of the bone set a FaceFX actor gets played with
+	* @param BlendMode The blend mode
+	* @param IsCompensateForForceFrontXAxis Indicator if the bone transforms compensate for Force Front XAxis
+	* @returns The bone set creation flags
+	*/
+	static FxBoneSetFlags GetBoneSetCreationFlags(EFaceFXBlendMode BlendMode, bool IsCompensateForForceFrontXAxis);
+
+	/**
+	* Samples a baked animation. Interpolates linearly between the two closest frames
+	* @param BakedData The baked animation
+	* @param Time The animation time in seconds. Clamped to the baked range
+	* @param OutTrackValues The track values. Must hold BakedData.NumTracks entries
+	* @param OutBoneTransforms The FaceFX bone transforms. Must hold the bone transforms of BakedData.NumBoneValues
+	*/
+	static void SampleBakedAnimation(const FFaceFXBakedAnimData& BakedData, float Time, float* RESTRICT OutTrackValues, FxBoneTransform* RESTRICT OutBoneTransforms);
+
+#if WITH_EDITOR
+	/**
+	* Bakes an animation by sampling it against an actor at a fixed rate. Measures the error of the baked output against the live output in between the frames
+	* @param Dataset The actor asset to sample the animation with
+	* @param AnimData The animation to bake. Requires the timeline to be extracted already. See ComputeAnimationTimeline
+	* @param SampleRate The number of frames per second
+	* @param IsCompensateForForceFrontXAxis Indicator if the bone transforms compensate for Force Front XAxis
+	* @param OutBakedData The baked animation
+	* @returns True if succeeded, else false
+	*/
+	static bool BakeAnimation(const UFaceFXActor* Dataset, const FFaceFXAnimData& AnimData, float SampleRate, bool IsCompensateForForceFrontXAxis, FFaceFXBakedAnimData& OutBakedData);
+
+	/**
+	* Extracts the audio start and the events of a set of animation data by playing it against an actor at FACEFX_TIMELINE_SAMPLE_RATE and stores them within the data.
+	* Meant to be called once during import
+	* @param Dataset The actor asset to play the animation with
+	* @param AnimData The data to extract the timeline for
+	* @returns True if succeeded, else false
+	*/
+	static bool ComputeAnimationTimeline(const UFaceFXActor* Dataset, FFaceFXAnimData& AnimData);
+#endif //WITH_EDITOR
+
 private:
 
 	FaceFX() {}
@@ -0,0 +1,314 @@
+/*******************************************************************************
+  The MIT License (MIT)
+  Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#pragma once
+
+#include "FaceFXConfig.h"
+#include "UObject/ObjectKey.h"
+#include "Templates/SharedPointer.h"
+
+class UFaceFXActor;
+class UFaceFXAnim;
+class USkeletalMeshComponent;
+struct FFaceFXActorData;
+class USkeleton;
+
+/** The mapping of FaceFX tracks onto named targets like morph targets or material parameters */
+struct FFaceFXTrackBindings
+{
+	/** The names of the bound targets */
+	TArray<FName> Names;
+
+	/** The indexes of the bound targets in the FaceFX track values array */
+	TArray<size_t> Indices;
+};
+
+/**
+* Immutable data of a FaceFX actor asset that is shared by all characters created from it.
+* Holds the parsed bone set, the track and bone ids as well as the discovered morph target and material parameter bindings
+*/
+class FACEFX_API FFaceFXActorTemplate
+{
+public:
+
+	~FFaceFXActorTemplate();
+
+	/**
+	* Creates a FaceFX actor handle and optionally its frame state. All actor handles of the plugin get created through here
+	* @param ActorData The actor data to create the handle from
+	* @param IsDataValidated Indicator if the data passed the validation of the FaceFX runtime already. Skips the validation if so
+	* @param EventHandler The callbacks for the events fired by the actor
+	* @param OutActor The created actor handle
+	* @param OutFrameState The created frame state. Optional
+	* @returns The result of the FaceFX runtime. Nothing is created if failed
+	*/
+	static FxResult CreateActor(const FFaceFXActorData& ActorData, bool IsDataValidated, FxEventCallbacks EventHandler, FxActor& OutActor, FxFrameState* OutFrameState = nullptr);
+
+	/**
+	* Gets if the actor data contains bones
+	* @returns True if there is a bone set, else false
+	*/
+	inline bool HasBoneSet() const
+	{
+		return BoneSet != FX_INVALID_BONESET;
+	}
+
+	/**
+	* Computes the bone transforms of a processed frame with the bone set shared by all characters of the template.
+	* The FaceFX runtime does not document bone sets as safe for concurrent use, hence the computations of a template are serialized
+	* @param FrameState The processed frame state
+	* @param OutBoneTransforms The bone transforms. Must hold Num entries
+	* @param Num The number of bone transforms
+	* @returns The result of the FaceFX runtime. FX_SUCCESS if there is no bone set
+	*/
+	FxResult ComputeBoneTransforms(FxFrameState FrameState, FxBoneTransform* OutBoneTransforms, int32 Num) const;
+
+	/**
+	* Gets if an animation can be played with the actor. Uses the compatibility computed during cook if available
+	* @param Animation The animation to check
+	* @param Actor The actor handle to check against if there is no cooked result. A temporary handle gets created if invalid
+	* @returns True if compatible, else false
+	*/
+	bool IsCompatible(const UFaceFXAnim* Animation, FxActor Actor = FX_INVALID_ACTOR) const;
+
+	/**
+	* Gets the creation flags of the bone set
+	* @returns The bone set creation flags
+	*/
+	inline FxBoneSetFlags GetBoneSetFlags() const
+	{
+		return BoneSetFlags;
+	}
+
+	/**
+	* Gets the FaceFX track ids
+	* @returns The track ids
+	*/
+	inline const TArray<uint64_t>& GetTrackIds() const
+	{
+		return TrackIds;
+	}
+
+	/**
+	* Gets the track names matching the track ids
+	* @returns The track names. NAME_None for tracks without id data
+	*/
+	inline const TArray<FName>& GetTrackNames() const
+	{
+		return TrackNames;
+	}
+
+	/**
+	* Gets the index within the track values for a given track id
+	* @param TrackId The FaceFX track id to look up. See FFaceFXActorData::FindId to get the id of a track name
+	* @returns The index or INDEX_NONE if not found
+	*/
+	inline int32 GetTrackIndex(uint64 TrackId) const
+	{
+		const int32* Idx = TrackIndices.Find(TrackId);
+		return Idx ? *Idx : INDEX_NONE;
+	}
+
+	/**
+	* Gets the FaceFX bone ids
+	* @returns The bone ids
+	*/
+	inline const TArray<uint64_t>& GetBoneIds() const
+	{
+		return BoneIds;
+	}
+
+	/**
+	* Gets the bone names matching the bone ids
+	* @returns The bone names
+	*/
+	inline const TArray<FName>& GetBoneNames() const
+	{
+		return BoneNames;
+	}
+
+	/**
+	* Gets the index within the bone transforms for a given bone name
+	* @param Name The bone name to look up
+	* @returns The index or INDEX_NONE if not found
+	*/
+	inline int32 GetBoneTransformIndex(const FName& Name) const
+	{
+		const int32* Idx = BoneTransformIndices.Find(Name);
+		return Idx ? *Idx : INDEX_NONE;
+	}
+
+	/**
+	* Gets if the actor data passed the data validation of the FaceFX runtime already. Further handles can be created without validation
+	* @returns True if validated, else false
+	*/
+	inline bool IsDataValidated() const
+	{
+		return bIsDataValidated;
+	}
+
+	/**
+	* Gets the tracks that drive morph targets of a skel mesh component. Computed once per skeletal mesh
+	* @param SkelMeshComp The skel mesh component to get the bindings for
+	* @returns The bindings
+	*/
+	FFaceFXTrackBindings GetMorphTargetBindings(const USkeletalMeshComponent* SkelMeshComp) const;
+
+	/**
+	* Gets the tracks that drive material parameters of a skel mesh component. Computed once per set of materials
+	* @param SkelMeshComp The skel mesh component to get the bindings for
+	* @param IgnoredTracks The list of tracks to ignore
+	* @returns The bindings
+	*/
+	FFaceFXTrackBindings GetMaterialParameterBindings(const USkeletalMeshComponent* SkelMeshComp, const TArray<FName>& IgnoredTracks) const;
+
+	/**
+	* Gets the tracks that match morph target or material curves of a skeleton. Computed once per skeleton
+	* @param Skeleton The skeleton to get the bindings for
+	* @param IsMorphTargets Indicator if morph target curves shall be bound
+	* @param IsMaterialParameters Indicator if material curves shall be bound
+	* @returns The bindings
+	*/
+	FFaceFXTrackBindings GetAnimationCurveBindings(const USkeleton* Skeleton, bool IsMorphTargets, bool IsMaterialParameters) const;
+
+private:
+
+	friend class FFaceFXActorTemplateCache;
+
+	FFaceFXActorTemplate(const UFaceFXActor* InAsset) : Asset(InAsset), BoneSet(FX_INVALID_BONESET), BoneSetFlags(0), bIsDataValidated(false) {}
+
+	/**
+	* Parses the actor data
+	* @param InBoneSetFlags The creation flags of the bone set
+	* @returns True if succeeded, else false
+	*/
+	bool Init(FxBoneSetFlags InBoneSetFlags);
+
+	/** The morph target bindings for a set of morph targets */
+	struct FMorphTargetBindings
+	{
+		FMorphTargetBindings() : MorphTargetsHash(0) {}
+
+		/** The hash of the morph target names the bindings got computed for. Changes when the skeletal mesh gets reimported with other morph targets */
+		uint32 MorphTargetsHash;
+
+		/** The computed bindings */
+		FFaceFXTrackBindings Bindings;
+	};
+
+	/** The material parameter bindings for a set of materials */
+	struct FMaterialBindings
+	{
+		/** The materials the bindings got computed for */
+		TArray<FObjectKey> Materials;
+
+		/** The tracks ignored during the computation */
+		TArray<FName> IgnoredTracks;
+
+		/** The computed bindings */
+		FFaceFXTrackBindings Bindings;
+	};
+
+	/** The asset the template was created from */
+	TWeakObjectPtr<const UFaceFXActor> Asset;
+
+	/** The bone set handle */
+	FxBoneSet BoneSet;
+
+	/** The creation flags of the bone set */
+	FxBoneSetFlags BoneSetFlags;
+
+	/** The FaceFX track ids */
+	TArray<uint64_t> TrackIds;
+
+	/** The track names matching the track ids */
+	TArray<FName> TrackNames;
+
+	/** The indices within the track ids keyed by track id */
+	TMap<uint64, int32> TrackIndices;
+
+	/** The FaceFX bone ids */
+	TArray<uint64_t> BoneIds;
+
+	/** The bone names matching the bone ids */
+	TArray<FName> BoneNames;
+
+	/** The indices within the bone ids keyed by bone name */
+	TMap<FName, int32> BoneTransformIndices;
+
+	/** Indicator if the actor data passed the data validation */
+	bool bIsDataValidated;
+
+	/** The morph target bindings per skeletal mesh */
+	mutable TMap<FObjectKey, FMorphTargetBindings> MorphTargetBindings;
+
+	/** The material parameter bindings per skeletal mesh */
+	mutable TMap<FObjectKey, FMaterialBindings> MaterialParameterBindings;
+
+	/** The animation curve bindings per skeleton and bound curve types */
+	mutable TMap<TTuple<FObjectKey, bool, bool>, FFaceFXTrackBindings> AnimationCurveBindings;
+
+	/** Guards the lazily computed bindings */
+	mutable FCriticalSection BindingsLock;
+
+	/** Serializes the use of the bone set */
+	mutable FCriticalSection BoneSetLock;
+};
+
+typedef TSharedPtr<const FFaceFXActorTemplate, ESPMode::ThreadSafe> FFaceFXActorTemplatePtr;
+
+/** Process wide cache of actor templates keyed by actor asset and bone set creation flags */
+class FACEFX_API FFaceFXActorTemplateCache
+{
+public:
+
+	/**
+	* Gets the global template cache
+	* @returns The cache
+	*/
+	static FFaceFXActorTemplateCache& Get();
+
+	/**
+	* Gets the template for an actor asset. Creates the template on first use
+	* @param Asset The actor asset to get the template for
+	* @param BoneSetFlags The creation flags of the bone set
+	* @returns The template or nullptr if the actor data could not be parsed
+	*/
+	FFaceFXActorTemplatePtr Acquire(const UFaceFXActor* Asset, FxBoneSetFlags BoneSetFlags);
+
+	/**
+	* Drops all templates of an actor asset. Used whenever the asset data changes or the asset gets destroyed. Characters keep their current template until reloaded
+	* @param Asset The actor asset to drop the templates for
+	*/
+	void Purge(const UFaceFXActor* Asset);
+
+	/** Drops all templates */
+	void Empty();
+
+private:
+
+	FFaceFXActorTemplateCache() {}
+
+	/** The cached templates keyed by asset and bone set creation flags */
+	TMap<TPair<const UFaceFXActor*, FxBoneSetFlags>, FFaceFXActorTemplatePtr> Templates;
+
+	/** Guards the templates */
+	FCriticalSection CriticalSection;
+};
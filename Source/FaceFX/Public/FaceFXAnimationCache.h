@@ -0,0 +1,131 @@
+/*******************************************************************************
+  The MIT License (MIT)
+  Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#pragma once
+
+#include "FaceFXConfig.h"
+
+class UFaceFXAnim;
+
+/**
+* Process wide cache of FaceFX runtime animation handles keyed by animation asset. Thread safe.
+* Handles are reference counted. Unused handles stay cached until they get evicted in least recently used order.
+* With FACEFX_SHARE_ANIMATION_HANDLES all users of an asset share a single handle, otherwise each user gets its own handle out of a pool per asset
+*/
+class FACEFX_API FFaceFXAnimationCache
+{
+public:
+
+	/**
+	* Gets the global animation cache
+	* @returns The cache
+	*/
+	static FFaceFXAnimationCache& Get();
+
+	/**
+	* Acquires an animation handle for an animation asset. Creates the handle if none is cached. Each acquired handle must be given back via Release
+	* @param Animation The animation asset to acquire the handle for
+	* @returns The handle or FX_INVALID_ANIMATION if the animation data could not be loaded
+	*/
+	FxAnimation Acquire(const UFaceFXAnim* Animation);
+
+	/**
+	* Gives back a previously acquired animation handle
+	* @param Handle The handle to release. Gets reset to FX_INVALID_ANIMATION
+	*/
+	void Release(FxAnimation& Handle);
+
+	/**
+	* Drops all cached handles of an animation asset. Used whenever the asset data changes or the asset gets destroyed. Handles still in use get destroyed on release
+	* @param Animation The animation asset to drop the handles for
+	*/
+	void Purge(const UFaceFXAnim* Animation);
+
+	/** Drops all cached handles. Handles still in use get destroyed on release */
+	void Empty();
+
+private:
+
+	FFaceFXAnimationCache() : UseCounter(0) {}
+
+	/** The cached handles of a single animation asset */
+	struct FEntry
+	{
+		FEntry() : NumUsers(0), NumBytes(0), LastUsed(0) {}
+
+		/** All handles that were created for the asset. A single one when sharing handles */
+		TArray<FxAnimation> Handles;
+
+		/** The handles that are currently not in use. Only used when not sharing handles */
+		TArray<FxAnimation> FreeHandles;
+
+		/** The number of handles that are currently acquired */
+		int32 NumUsers;
+
+		/** The size of the raw animation data. Used as memory estimate per handle */
+		uint32 NumBytes;
+
+		/** The use counter value of the last acquire or release. Used for the least recently used eviction */
+		uint64 LastUsed;
+	};
+
+	/** A handle that got purged while still being in use */
+	struct FStaleHandle
+	{
+		FStaleHandle(int32 InNumUsers, uint32 InNumBytes) : NumUsers(InNumUsers), NumBytes(InNumBytes) {}
+
+		/** The number of users that still need to release the handle */
+		int32 NumUsers;
+
+		/** The memory estimate of the handle */
+		uint32 NumBytes;
+	};
+
+	/**
+	* Removes all handles of an entry from the handle lookup. Destroys unused handles and marks the used ones as stale
+	* @param Entry The entry to remove the handles of
+	*/
+	void RemoveHandles(const FEntry& Entry);
+
+	/**
+	* Destroys a single animation handle
+	* @param Handle The handle to destroy
+	* @param NumBytes The memory estimate of the handle
+	*/
+	static void DestroyHandle(FxAnimation Handle, uint32 NumBytes);
+
+	/** Evicts the least recently used entries without any users until the configured maximum of unused entries is met */
+	void EvictUnusedEntries();
+
+	/** The cached entries */
+	TMap<const UFaceFXAnim*, FEntry> Entries;
+
+	/** The asset each cached handle belongs to */
+	TMap<FxAnimation, const UFaceFXAnim*> HandleOwners;
+
+	/** The handles that got purged while still being in use */
+	TMap<FxAnimation, FStaleHandle> StaleHandles;
+
+	/** Increases with each acquire and release */
+	uint64 UseCounter;
+
+	/** Guards all members */
+	FCriticalSection CriticalSection;
+};
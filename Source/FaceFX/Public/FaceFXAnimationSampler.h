@@ -0,0 +1,189 @@
+/*******************************************************************************
+The MIT License (MIT)
+Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#pragma once
+
+#include "FaceFXConfig.h"
+#include "FaceFXCharacterOutput.h"
+#include "Templates/Function.h"
+
+class UFaceFXActor;
+class UFaceFXAnim;
+class FFaceFXActorTemplate;
+
+/**
+* Process wide stateless evaluation of FaceFX animations at arbitrary times. Thread safe.
+* Unlike playing an animation on a character this does not touch any playback, audio or event state, which makes it suitable for
+* scrubbing, temporal sub-samples of offline renders and gameplay queries. Evaluations run on a pool of scratch FaceFX actor handles
+* so any number of threads can evaluate at once. Times are quantized by FACEFX_SAMPLER_TIME_STEP and the results get cached per
+* actor, animation and quantized time. Callers need to keep the assets alive during the evaluation
+*/
+class FACEFX_API FFaceFXAnimationSampler
+{
+public:
+
+	/**
+	* Gets the global sampler
+	* @returns The sampler
+	*/
+	static FFaceFXAnimationSampler& Get();
+
+	/**
+	* Evaluates an animation at a given time. Uses the baked curves of the animation if they match the actor
+	* @param Dataset The actor asset to evaluate the animation with
+	* @param Animation The animation to evaluate
+	* @param Time The animation time in seconds. Clamped to the animation range
+	* @param IsCompensateForForceFrontXAxis Indicator if the bone transforms compensate for Force Front XAxis
+	* @param OutOutput The evaluated bone transforms and track values. The indices match the bone and track ids of the actor template
+	* @returns True if succeeded, else false
+	*/
+	bool Evaluate(const UFaceFXActor* Dataset, const UFaceFXAnim* Animation, float Time, bool IsCompensateForForceFrontXAxis, FFaceFXCharacterOutput& OutOutput);
+
+	/**
+	* Drops the scratch handles and cached results of an actor asset. Used whenever the asset data changes or the asset gets destroyed
+	* @param Dataset The actor asset to drop the data for
+	*/
+	void Purge(const UFaceFXActor* Dataset);
+
+	/**
+	* Drops the cached results of an animation asset. Used whenever the asset data changes or the asset gets destroyed
+	* @param Animation The animation asset to drop the results for
+	*/
+	void Purge(const UFaceFXAnim* Animation);
+
+	/** Drops all scratch handles and cached results */
+	void Empty();
+
+private:
+
+	FFaceFXAnimationSampler() : NextResultIdx(0), ContextPurgeCounter(0), ResultPurgeCounter(0) {}
+
+	/** The scratch handles a single evaluation runs on */
+	struct FContext
+	{
+		FContext() : Actor(FX_INVALID_ACTOR), FrameState(FX_INVALID_FRAMESTATE) {}
+
+		/** The actor handle. Created without event handling */
+		FxActor Actor;
+
+		/** The frame state handle */
+		FxFrameState FrameState;
+	};
+
+	/** The key of a cached result */
+	struct FResultKey
+	{
+		FResultKey(const UFaceFXActor* InDataset, const UFaceFXAnim* InAnimation, FxBoneSetFlags InBoneSetFlags, int32 InStep) : Dataset(InDataset), Animation(InAnimation), BoneSetFlags(InBoneSetFlags), Step(InStep) {}
+
+		inline bool operator==(const FResultKey& Other) const
+		{
+			return Dataset == Other.Dataset && Animation == Other.Animation && BoneSetFlags == Other.BoneSetFlags && Step == Other.Step;
+		}
+
+		friend inline uint32 GetTypeHash(const FResultKey& Key)
+		{
+			return HashCombine(HashCombine(GetTypeHash(Key.Dataset), GetTypeHash(Key.Animation)), HashCombine(GetTypeHash(Key.BoneSetFlags), GetTypeHash(Key.Step)));
+		}
+
+		/** The actor asset */
+		const UFaceFXActor* Dataset;
+
+		/** The animation asset */
+		const UFaceFXAnim* Animation;
+
+		/** The creation flags of the bone set */
+		FxBoneSetFlags BoneSetFlags;
+
+		/** The quantized time in FACEFX_SAMPLER_TIME_STEP units */
+		int32 Step;
+	};
+
+	/**
+	* Takes a scratch context of an actor asset out of the pool. Creates a new one if none is available
+	* @param Dataset The actor asset
+	* @param IsDataValidated Indicator if the actor data passed the data validation already
+	* @param OutContext The context
+	* @returns True if succeeded, else false
+	*/
+	bool AcquireContext(const UFaceFXActor* Dataset, bool IsDataValidated, FContext& OutContext);
+
+	/**
+	* Gives back a scratch context into the pool
+	* @param Dataset The actor asset the context got acquired for
+	* @param Context The context
+	* @param AcquirePurgeCounter The purge counter at the time of the acquire. Contexts acquired before a purge get destroyed
+	*/
+	void ReleaseContext(const UFaceFXActor* Dataset, FContext& Context, uint32 AcquirePurgeCounter);
+
+	/**
+	* Destroys the handles of a scratch context
+	* @param Context The context to destroy
+	*/
+	static void DestroyContext(FContext& Context);
+
+	/**
+	* Evaluates an animation with the FaceFX runtime
+	* @param Dataset The actor asset
+	* @param ActorTemplate The template of the actor asset
+	* @param Animation The animation asset
+	* @param Time The animation time in seconds
+	* @param OutTrackValues The track values. Must hold the tracks of the actor template
+	* @param OutBoneTransforms The FaceFX bone transforms. Must hold the bones of the actor template
+	* @returns True if succeeded, else false
+	*/
+	bool EvaluateRuntime(const UFaceFXActor* Dataset, const FFaceFXActorTemplate& ActorTemplate, const UFaceFXAnim* Animation, float Time, TArray<float>& OutTrackValues, TArray<FxBoneTransform>& OutBoneTransforms);
+
+	/**
+	* Adds a result to the cache. Evicts the oldest result once the maximum number of cached results is reached
+	* @param Key The key of the result
+	* @param Output The result
+	*/
+	void AddResult(const FResultKey& Key, const FFaceFXCharacterOutput& Output);
+
+	/** Drops all cached results. Expects the lock to be held */
+	void EmptyResults();
+
+	/**
+	* Drops the cached results that match a predicate and removes their keys from the eviction order. Expects the lock to be held
+	* @param Predicate The predicate that returns true for the keys of the results to drop
+	*/
+	void RemoveResults(TFunctionRef<bool(const FResultKey&)> Predicate);
+
+	/** The pooled scratch contexts per actor asset */
+	TMap<const UFaceFXActor*, TArray<FContext>> FreeContexts;
+
+	/** The cached results */
+	TMap<FResultKey, FFaceFXCharacterOutput> Results;
+
+	/** The keys of the cached results in insertion order. Used as ring buffer for the eviction */
+	TArray<FResultKey> ResultOrder;
+
+	/** The index of the oldest entry within ResultOrder once it is full */
+	int32 NextResultIdx;
+
+	/** Increases with each purge of actor data. Contexts acquired before are destroyed on release */
+	uint32 ContextPurgeCounter;
+
+	/** Increases with each purge. Results of evaluations that overlapped with a purge are not cached */
+	uint32 ResultPurgeCounter;
+
+	/** Guards all members */
+	FCriticalSection CriticalSection;
+};
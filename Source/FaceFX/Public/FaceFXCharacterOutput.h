@@ -0,0 +1,248 @@
+/*******************************************************************************
+  The MIT License (MIT)
+  Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Atomic.h"
+#include "Misc/ScopeRWLock.h"
+
+/** The outputs of a single evaluation of a FaceFX character */
+struct FFaceFXCharacterOutput
+{
+	/** The bone transforms in UE4 coordinates. The indices match the bone ids of the character */
+	TArray<FTransform> BoneTransforms;
+
+	/** The FaceFX track values. The indices match the track ids of the character */
+	TArray<float> TrackValues;
+};
+
+/**
+* Triple buffer of character outputs. A single writer (the evaluating character) publishes a new output per evaluation
+* while any number of readers on any thread copy out the latest completely written output.
+* Publishing does not lock. Each buffer carries a sequence number which is odd while the buffer is being written (seqlock).
+* Readers validate the sequence number before and after copying and retry in the rare case the writer lapped them.
+* Init and Reset publish a fresh set of buffers instead of resizing the current ones. Readers that are still copying keep the
+* previous set alive until they are done. Init and Reset must not overlap with writes (i.e. during character loading).
+* Reading is not lock free: each Read takes StorageLock shared to copy the storage pointer, i.e. an uncontended lock plus two
+* atomic reference count changes on top of the copy. It only waits while Init or Reset swap the storage on the game thread
+*/
+class FFaceFXCharacterOutputBuffer
+{
+public:
+
+	FFaceFXCharacterOutputBuffer() : Storage(MakeShared<FStorage, ESPMode::ThreadSafe>()), Version(0), WriteIndex(INDEX_NONE) {}
+
+	/**
+	* Allocates the buffers. Invalidates any previously published output
+	* @param NumBones The number of bone transforms per output
+	* @param NumTracks The number of track values per output
+	*/
+	void Init(int32 NumBones, int32 NumTracks)
+	{
+		TSharedRef<FStorage, ESPMode::ThreadSafe> NewStorage = MakeShared<FStorage, ESPMode::ThreadSafe>();
+
+		for (FFaceFXCharacterOutput& Buffer : NewStorage->Buffers)
+		{
+			Buffer.BoneTransforms.AddDefaulted(NumBones);
+			Buffer.TrackValues.AddZeroed(NumTracks);
+		}
+
+		SetStorage(NewStorage);
+	}
+
+	/** Frees the buffers and invalidates any previously published output. The buffers are freed once the last reader is done */
+	void Reset()
+	{
+		SetStorage(MakeShared<FStorage, ESPMode::ThreadSafe>());
+	}
+
+	/**
+	* Starts writing a new output. Must be followed by EndWrite once all data got written
+	* @returns The buffer to write into. Never the one that got published last
+	*/
+	FFaceFXCharacterOutput& BeginWrite()
+	{
+		checkf(WriteIndex == INDEX_NONE, TEXT("Internal Error: FaceFX character output is already being written."));
+
+		//the writer never overlaps with Init/Reset and can access the storage without the lock
+		FStorage& WriteStorage = *Storage;
+
+		WriteIndex = (FMath::Max(WriteStorage.LatestIndex.Load(EMemoryOrder::Relaxed), 0) + 1) % NumBuffers;
+
+		//odd sequence number marks the buffer as being written
+		WriteStorage.Sequences[WriteIndex].IncrementExchange();
+		FPlatformMisc::MemoryBarrier();
+
+		return WriteStorage.Buffers[WriteIndex];
+	}
+
+	/** Publishes the buffer that got written since BeginWrite */
+	void EndWrite()
+	{
+		checkf(WriteIndex != INDEX_NONE, TEXT("Internal Error: FaceFX character output is not being written."));
+
+		FStorage& WriteStorage = *Storage;
+
+		FPlatformMisc::MemoryBarrier();
+		WriteStorage.Sequences[WriteIndex].IncrementExchange();
+
+		WriteStorage.LatestIndex = WriteIndex;
+		WriteIndex = INDEX_NONE;
+		Version.IncrementExchange();
+	}
+
+	/**
+	* Copies out the latest published output. Can be called from any thread
+	* @param OutBoneTransforms The bone transforms target. Optional
+	* @param OutTrackValues The track values target. Optional
+	* @returns True if a complete output was copied, else false. The targets may contain partial data on failure
+	*/
+	bool Read(TArray<FTransform>* OutBoneTransforms, TArray<float>* OutTrackValues) const
+	{
+		//keep the buffers alive while copying even if the game thread initializes or resets them meanwhile
+		TSharedPtr<FStorage, ESPMode::ThreadSafe> ReadStorage;
+		{
+			FRWScopeLock Lock(StorageLock, SLT_ReadOnly);
+			ReadStorage = Storage;
+		}
+
+		//each retry means the writer published twice while we were copying. This practically never happens more than once
+		static const int32 MaxAttempts = 4;
+
+		for (int32 Attempt = 0; Attempt < MaxAttempts; ++Attempt)
+		{
+			const int32 Idx = ReadStorage->LatestIndex;
+			if (Idx == INDEX_NONE)
+			{
+				return false;
+			}
+
+			const uint32 Sequence = ReadStorage->Sequences[Idx];
+			if (Sequence & 1)
+			{
+				//writer lapped us and is currently writing into this buffer
+				continue;
+			}
+
+			const FFaceFXCharacterOutput& Buffer = ReadStorage->Buffers[Idx];
+			if (OutBoneTransforms)
+			{
+				CopyArray(Buffer.BoneTransforms, *OutBoneTransforms);
+			}
+			if (OutTrackValues)
+			{
+				CopyArray(Buffer.TrackValues, *OutTrackValues);
+			}
+
+			FPlatformMisc::MemoryBarrier();
+			if (ReadStorage->Sequences[Idx] == Sequence)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	* Gets the indicator if any output got published since the last Init/Reset. Writer only
+	* @returns True if published, else false
+	*/
+	inline bool HasOutput() const
+	{
+		return Storage->LatestIndex != INDEX_NONE;
+	}
+
+	/**
+	* Gets the version of the latest published output. Changes with each publish, Init and Reset. Can be called from any thread
+	* @returns The version
+	*/
+	inline uint32 GetVersion() const
+	{
+		return Version;
+	}
+
+private:
+
+	enum { NumBuffers = 3 };
+
+	/** A set of output buffers. Replaced as a whole by Init and Reset */
+	struct FStorage
+	{
+		FStorage() : LatestIndex(INDEX_NONE)
+		{
+			for (int32 Idx = 0; Idx < NumBuffers; ++Idx)
+			{
+				Sequences[Idx] = 0;
+			}
+		}
+
+		/** The output buffers */
+		FFaceFXCharacterOutput Buffers[NumBuffers];
+
+		/** The sequence numbers of the buffers. Odd while the buffer is being written */
+		TAtomic<uint32> Sequences[NumBuffers];
+
+		/** The index of the latest published buffer. INDEX_NONE if nothing got published yet */
+		TAtomic<int32> LatestIndex;
+	};
+
+	/** Publishes a new set of buffers. Readers still copying from the previous set keep it alive */
+	void SetStorage(const TSharedRef<FStorage, ESPMode::ThreadSafe>& NewStorage)
+	{
+		checkf(WriteIndex == INDEX_NONE, TEXT("Internal Error: FaceFX character output is being written."));
+
+		TSharedPtr<FStorage, ESPMode::ThreadSafe> PrevStorage;
+		{
+			FRWScopeLock Lock(StorageLock, SLT_Write);
+			PrevStorage = MoveTemp(Storage);
+			Storage = NewStorage;
+		}
+
+		Version.IncrementExchange();
+
+		//the previous buffers get freed outside of the lock once the last reader released them
+		PrevStorage.Reset();
+	}
+
+	/** Copies the content of an array without reallocating the target as long as its size does not change */
+	template <typename T>
+	static inline void CopyArray(const TArray<T>& Source, TArray<T>& Target)
+	{
+		Target.SetNumUninitialized(Source.Num(), false);
+		if (Source.Num() > 0)
+		{
+			FMemory::Memcpy(Target.GetData(), Source.GetData(), Source.Num() * sizeof(T));
+		}
+	}
+
+	/** The current set of output buffers */
+	TSharedPtr<FStorage, ESPMode::ThreadSafe> Storage;
+
+	/** Guards the exchange of the storage pointer. Only held while copying the pointer */
+	mutable FRWLock StorageLock;
+
+	/** The version of the latest published output */
+	TAtomic<uint32> Version;
+
+	/** The index of the buffer that is currently being written. Only accessed by the writer */
+	int32 WriteIndex;
+};
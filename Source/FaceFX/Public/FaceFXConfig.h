@@ -68,6 +68,49 @@
 // .ffxanim left inside after loading compiled data. Default Value: 1
 #define FACEFX_DELETE_EMPTY_COMPILATION_FOLDER 1
 
+// Indicator if all FaceFX characters playing the same animation asset share
+// a single FaceFX animation handle. Default Value: 0
+// When true each animation asset gets loaded once and the handle is used by
+// all playing characters and the animation sampler, possibly from several
+// threads at once. Only enable this once the FaceFX runtime in use documents
+// that animation handles can be used by multiple actors concurrently.
+// When false each user gets its own handle out of a pool of handles per
+// animation asset. The number of unused pooled handles per asset is bounded
+// by FaceFX.AnimationCache.MaxFreeHandles
+#define FACEFX_SHARE_ANIMATION_HANDLES 0
+
+// Indicator if FaceFX data that passed the data validation during cook gets
+// loaded without validation. Default Value: UE_BUILD_SHIPPING
+// When true actor and animation data whose content hash still matches the
+// hash stored during cook is loaded with FX_DATA_VALIDATION_OFF.
+// When false all data gets validated on each load.
+#define FACEFX_TRUST_VALIDATED_DATA UE_BUILD_SHIPPING
+
+// The default minimal change of a FaceFX output value that counts as a change.
+// Default Value: 1.e-4f
+// Smaller changes of track values are not written into morph targets, material
+// parameters and custom primitive data. Characters whose whole output changed
+// less skip publishing it. Can be overridden via FaceFX.Output.Epsilon
+#define FACEFX_OUTPUT_EPSILON 1.e-4f
+
+// The rate in samples per second at which linked animations are sampled to
+// find the tracks they change. Default Value: 60.f
+// Characters only process the changed tracks while playing such an animation.
+// Tracks that change only in between two samples may be missed.
+#define FACEFX_ACTIVE_TRACKS_SAMPLE_RATE 60.f
+
+// The rate in samples per second at which imported animations are sampled to
+// extract the audio start and the events of their timeline. Default Value: 240.f
+// Jumps look up the audio state and the skipped events within the timeline.
+// The timeline times are rounded up to the next sample.
+#define FACEFX_TIMELINE_SAMPLE_RATE 240.f
+
+// The time step in seconds the stateless animation sampler quantizes times to.
+// Default Value: 1.f / 1000.f
+// Evaluations at times within the same step produce the same output and share
+// a single cached result. Fine enough for temporal sub-samples of renders.
+#define FACEFX_SAMPLER_TIME_STEP (1.f / 1000.f)
+
 // The root namespace for any ini file entry
 #define FACEFX_CONFIG_NS TEXT("FaceFX")
 
@@ -136,6 +179,16 @@ public:
         return DefaultBlendMode;
     }
 
+    inline float GetEvaluationBudget() const
+    {
+        return EvaluationBudget;
+    }
+
+    inline bool IsOutputTracksAsCurves() const
+    {
+        return bOutputTracksAsCurves;
+    }
+
 private:
 
     /*
@@ -145,4 +198,20 @@ Can be overridden directly via an FaceFXActor asset properties.
     */
     UPROPERTY(config, EditAnywhere, Category = FaceFX)
     EFaceFXBlendMode DefaultBlendMode = EFaceFXBlendMode::Replace;
+
+    /*
+    The time in milliseconds all FaceFX characters may spend on evaluation per frame. 0 for no limit.
+Characters are ranked by significance (speaking, audible, screen size and player focus) and the least significant ones get deferred once the budget is used up.
+Can be set per platform within the platform specific Game.ini and overridden via the FaceFX.Budget.Milliseconds console variable.
+    */
+    UPROPERTY(config, EditAnywhere, Category = Performance, meta = (ClampMin = 0.0, DisplayName = "Evaluation Budget (ms)"))
+    float EvaluationBudget = 0.F;
+
+    /*
+    Indicator if FaceFX tracks that match a morph target or material curve of the skeleton shall be output as animation curves by the FaceFX blend node.
+Those tracks are then applied by the parallel animation evaluation, respect the LOD threshold of the blend node and skip the per frame setters on the game thread.
+Requires the Blend FaceFX Animation node within the animation graph. Tracks without a matching skeleton curve keep using the game thread setters.
+    */
+    UPROPERTY(config, EditAnywhere, Category = Performance)
+    bool bOutputTracksAsCurves = false;
 };
@@ -0,0 +1,39 @@
+/*******************************************************************************
+  The MIT License (MIT)
+  Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "FaceFXValidateCommandlet.generated.h"
+
+/**
+* Validates the data of all FaceFX actor and animation assets with the FaceFX runtime and writes a JSON report of the failures.
+* Usage: UE4Editor-Cmd.exe <Project> -run=FaceFXValidate [-Report=<File>] [-Paths=<Path1>+<Path2>]
+* The report defaults to <ProjectSaved>/FaceFX/ValidationReport.json. Returns 1 if any asset failed the validation, else 0
+*/
+UCLASS()
+class UFaceFXValidateCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	//UCommandlet
+	virtual int32 Main(const FString& Params) override;
+	//~UCommandlet
+};
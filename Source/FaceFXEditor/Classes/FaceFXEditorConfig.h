@@ -102,6 +102,33 @@ public:
 		return bShowToasterMessageOnIncompatibleAnim;
 	}
 
+	/**
+	* Gets the indicator if imported animations shall get baked against the FaceFX actor they got imported with
+	* @returns True if enabled, else false
+	*/
+	inline bool IsBakeAnimations() const
+	{
+		return bIsBakeAnimations;
+	}
+
+	/**
+	* Gets the number of frames per second animations get baked with
+	* @returns The sample rate
+	*/
+	inline float GetBakeSampleRate() const
+	{
+		return BakeSampleRate;
+	}
+
+	/**
+	* Gets the indicator if the baked bone transforms compensate for Force Front XAxis
+	* @returns True if enabled, else false
+	*/
+	inline bool IsBakeCompensateForForceFrontXAxis() const
+	{
+		return bIsBakeCompensateForForceFrontXAxis;
+	}
+
 private:
 
 	/** The plugin folder path */
@@ -134,4 +161,17 @@ Note: This might affect performance when there are a lot of UFaceFXAnimation ass
 	/* Indicates if the editor should show a warning message when a UFaceFXAnimation is attempted to be played on an incompatible UFaceFXCharacter. */
 	UPROPERTY(config, EditAnywhere, Category = FaceFX, DisplayName="Display message when playing incompatible animations")
 	bool bShowToasterMessageOnIncompatibleAnim = true;
+
+	/* Indicates if imported animations should be baked against the FaceFX actor they got imported with. Characters play the baked curves instead of evaluating the animation
+as long as the actor data and the Force Front XAxis setting of the character match. */
+	UPROPERTY(config, EditAnywhere, Category = Baking, DisplayName="Bake animations during import")
+	bool bIsBakeAnimations = false;
+
+	/* The number of frames per second imported animations get baked with. */
+	UPROPERTY(config, EditAnywhere, Category = Baking, DisplayName="Bake sample rate", meta=(ClampMin="1.0", ClampMax="240.0", EditCondition="bIsBakeAnimations"))
+	float BakeSampleRate = 30.f;
+
+	/* Indicates if the baked bone transforms should compensate for Force Front XAxis. Must match the setting of the FaceFX components playing the animations. */
+	UPROPERTY(config, EditAnywhere, Category = Baking, DisplayName="Bake with Force Front XAxis compensation", meta=(EditCondition="bIsBakeAnimations"))
+	bool bIsBakeCompensateForForceFrontXAxis = false;
 };
@@ -49,6 +49,7 @@ public class FaceFXEditor : ModuleRules
                 "MovieSceneTools",
                 "TimeManagement",
                 "Settings",
+                "Json",
                 "FaceFX",
             }
         );
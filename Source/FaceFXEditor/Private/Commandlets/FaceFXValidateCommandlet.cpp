@@ -0,0 +1,126 @@
+/*******************************************************************************
+  The MIT License (MIT)
+  Copyright (c) 2015-2024 OC3 Entertainment, Inc. All rights reserved.
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "Commandlets/FaceFXValidateCommandlet.h"
+#include "FaceFX.h"
+#include "FaceFXActor.h"
+#include "FaceFXAnim.h"
+#include "AssetRegistryModule.h"
+#include "Dom/JsonObject.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+UFaceFXValidateCommandlet::UFaceFXValidateCommandlet(const class FObjectInitializer& PCIP) : Super(PCIP)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UFaceFXValidateCommandlet::Main(const FString& Params)
+{
+	FString ReportFile = FPaths::Combine(*FPaths::ProjectSavedDir(), TEXT("FaceFX"), TEXT("ValidationReport.json"));
+	FParse::Value(*Params, TEXT("Report="), ReportFile);
+
+	FString PathsParam;
+	TArray<FString> Paths;
+	if (FParse::Value(*Params, TEXT("Paths="), PathsParam))
+	{
+		PathsParam.ParseIntoArray(Paths, TEXT("+"));
+	}
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.ClassNames.Add(UFaceFXActor::StaticClass()->GetFName());
+	Filter.ClassNames.Add(UFaceFXAnim::StaticClass()->GetFName());
+	Filter.bRecursivePaths = true;
+	for (const FString& Path : Paths)
+	{
+		Filter.PackagePaths.Add(FName(*Path));
+	}
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	UE_LOG(LogFaceFX, Display, TEXT("UFaceFXValidateCommandlet::Main. Validating %i FaceFX assets."), Assets.Num());
+
+	TArray<TSharedPtr<FJsonValue>> Failures;
+	int32 NumValidated = 0;
+
+	for (const FAssetData& AssetData : Assets)
+	{
+		UObject* Asset = AssetData.GetAsset();
+
+		FString ErrorMessage;
+		bool IsValid = false;
+
+		if (UFaceFXActor* Actor = Cast<UFaceFXActor>(Asset))
+		{
+			IsValid = Actor->ValidateData(&ErrorMessage);
+		}
+		else if (UFaceFXAnim* Anim = Cast<UFaceFXAnim>(Asset))
+		{
+			IsValid = Anim->ValidateData(&ErrorMessage);
+		}
+		else
+		{
+			ErrorMessage = TEXT("Unable to load asset");
+		}
+
+		if (IsValid)
+		{
+			++NumValidated;
+			continue;
+		}
+
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXValidateCommandlet::Main. Validation failed. %s. Asset: %s"), *ErrorMessage, *AssetData.ObjectPath.ToString());
+
+		TSharedPtr<FJsonObject> Failure = MakeShareable(new FJsonObject);
+		Failure->SetStringField(TEXT("asset"), AssetData.ObjectPath.ToString());
+		Failure->SetStringField(TEXT("class"), AssetData.AssetClass.ToString());
+		Failure->SetStringField(TEXT("error"), ErrorMessage);
+		Failures.Add(MakeShareable(new FJsonValueObject(Failure)));
+	}
+
+	TSharedPtr<FJsonObject> Report = MakeShareable(new FJsonObject);
+	Report->SetStringField(TEXT("version"), FaceFX::GetVersion());
+	Report->SetNumberField(TEXT("assets"), Assets.Num());
+	Report->SetNumberField(TEXT("validated"), NumValidated);
+	Report->SetArrayField(TEXT("failures"), Failures);
+
+	FString ReportString;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ReportString);
+	FJsonSerializer::Serialize(Report.ToSharedRef(), Writer);
+
+	if (!FFileHelper::SaveStringToFile(ReportString, *ReportFile))
+	{
+		UE_LOG(LogFaceFX, Error, TEXT("UFaceFXValidateCommandlet::Main. Unable to write report file: %s"), *ReportFile);
+		return 1;
+	}
+
+	UE_LOG(LogFaceFX, Display, TEXT("UFaceFXValidateCommandlet::Main. %i of %i FaceFX assets passed the validation. Report: %s"), NumValidated, Assets.Num(), *ReportFile);
+
+	return Failures.Num() > 0 ? 1 : 0;
+}
@@ -21,6 +21,9 @@
 #include "FaceFXEditorTools.h"
 #include "FaceFXEditor.h"
 #include "FaceFX.h"
+#include "FaceFXAnimationCache.h"
+#include "FaceFXActorTemplate.h"
+#include "FaceFXAnimationSampler.h"
 #include "Audio/FaceFXAudio.h"
 #include "EditorStyleSet.h"
 #include "Include/Slate/FaceFXComboChoiceWidget.h"
@@ -96,6 +99,120 @@ FString GetAnimAssetFileName(const FString& Folder, const FString& Group, const
 	return Folder / Group / (AnimationId + FACEFX_FILEEXT_ANIM);
 }
 
+/**
+* Bakes an animation against the actor it got imported with. Drops previously baked curves if baking is disabled within the editor config
+* @param FaceFXActor The actor asset the animation got imported with
+* @param Asset The animation asset to bake
+* @param OutResultMessages The message container to push the size and quality report into
+*/
+void BakeAnimation(const UFaceFXActor* FaceFXActor, UFaceFXAnim* Asset, FFaceFXImportResult& OutResultMessages)
+{
+	FFaceFXAnimData& AnimData = Asset->GetData();
+	const UFaceFXEditorConfig& Config = UFaceFXEditorConfig::Get();
+
+	if (!Config.IsBakeAnimations())
+	{
+		AnimData.BakedData.Reset();
+		return;
+	}
+
+	if (!FaceFX::BakeAnimation(FaceFXActor, AnimData, Config.GetBakeSampleRate(), Config.IsBakeCompensateForForceFrontXAxis(), AnimData.BakedData))
+	{
+		OutResultMessages.AddModifyWarning(LOCTEXT("BakeAnimationFailed", "Baking the animation failed. The animation gets evaluated by the FaceFX runtime."), Asset);
+		return;
+	}
+
+	const FFaceFXBakedAnimData& BakedData = AnimData.BakedData;
+
+	FFormatOrderedArguments Args;
+	Args.Add(FText::AsNumber(BakedData.SampleRate));
+	Args.Add(FText::AsMemory(BakedData.GetDataSize()));
+	Args.Add(FText::AsMemory(AnimData.RawData.Num()));
+	Args.Add(FText::AsNumber(BakedData.MaxTrackError));
+	Args.Add(FText::AsNumber(BakedData.MaxTranslationError));
+	Args.Add(FText::AsNumber(BakedData.MaxRotationError));
+	Args.Add(FText::AsNumber(BakedData.MaxScaleError));
+
+	const FText Report = FText::Format(LOCTEXT("BakeAnimationSuccess", "Baked animation at {0} fps. Size: {1} (raw: {2}). Max error against the runtime output - Tracks: {3}, Translation: {4}, Rotation: {5}, Scale: {6}"), Args);
+
+	UE_LOG(LogFaceFX, Log, TEXT("FFaceFXEditorTools::BakeAnimation. %s. Asset: %s"), *Report.ToString(), *GetNameSafe(Asset));
+	OutResultMessages.AddModifySuccess(Report, Asset);
+}
+
+/**
+* Extracts the timeline, samples the active tracks and bakes an imported animation against an actor. Needed on every import path that changes animation or actor data
+* @param FaceFXActor The actor asset to process the animation with
+* @param Asset The imported animation asset
+* @param OutResultMessages The message container to push warnings and reports into
+*/
+void ProcessImportedAnimation(UFaceFXActor* FaceFXActor, UFaceFXAnim* Asset, FFaceFXImportResult& OutResultMessages)
+{
+	//store the audio start and the events so jumps can look them up
+	if (!FaceFX::ComputeAnimationTimeline(FaceFXActor, Asset->GetData()))
+	{
+		OutResultMessages.AddModifyWarning(LOCTEXT("ComputeTimelineFailed", "Extracting the animation timeline failed. Jumps within the animation get evaluated by the FaceFX runtime."), Asset);
+	}
+
+#if FACEFX_USEANIMATIONLINKAGE
+	//store which tracks the animation changes so characters only process those
+	FaceFXActor->BuildAnimationActiveTracks(Asset);
+#endif //FACEFX_USEANIMATIONLINKAGE
+
+	BakeAnimation(FaceFXActor, Asset, OutResultMessages);
+}
+
+/**
+* Finds the actor asset an animation asset got imported with. Prefers actors that link the animation, else matches the FaceFX source asset
+* @param Asset The animation asset
+* @returns The actor asset or nullptr if not found
+*/
+UFaceFXActor* FindImportActor(const UFaceFXAnim* Asset)
+{
+	IFileManager& FileManager = IFileManager::Get();
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(AssetRegistryConstants::ModuleName).Get();
+
+	TArray<FAssetData> Assets;
+	if (!AssetRegistry.GetAssetsByClass(UFaceFXActor::StaticClass()->GetFName(), Assets))
+	{
+		return nullptr;
+	}
+
+	const FString AssetFolderAbs = FileManager.ConvertToAbsolutePathForExternalAppForRead(*Asset->GetAssetFolder());
+
+	UFaceFXActor* SourceActor = nullptr;
+
+	for (const FAssetData& AssetData : Assets)
+	{
+		UFaceFXActor* Actor = Cast<UFaceFXActor>(AssetData.GetAsset());
+
+		if (!Actor)
+		{
+			//synchronously load asset.
+			Actor = Cast<UFaceFXActor>(StaticLoadObject(UFaceFXActor::StaticClass(), nullptr, *AssetData.ToSoftObjectPath().ToString()));
+		}
+
+		if (!Actor)
+		{
+			continue;
+		}
+
+#if FACEFX_USEANIMATIONLINKAGE
+		if (Actor->Animations.Contains(Asset))
+		{
+			return Actor;
+		}
+#endif //FACEFX_USEANIMATIONLINKAGE
+
+		if (!SourceActor && Actor->GetAssetName().Equals(Asset->GetAssetName(), ESearchCase::IgnoreCase) &&
+			FileManager.ConvertToAbsolutePathForExternalAppForRead(*Actor->GetAssetFolder()).Equals(AssetFolderAbs, ESearchCase::IgnoreCase))
+		{
+			SourceActor = Actor;
+		}
+	}
+
+	return SourceActor;
+}
+
 /** A single audio map entry*/
 struct FFaceFXAudioMapEntry
 {
@@ -333,6 +450,46 @@ bool FFaceFXEditorTools::ImportFaceFXAsset(UFaceFXAsset* Asset, const FString& A
 
 	const bool ImportResult = LoadFromCompilationFolder(Asset, CompilationFolder, SoundRegistry, OutResultMessages);
 
+	if (ImportResult)
+	{
+		if (UFaceFXAnim* AnimAsset = Cast<UFaceFXAnim>(Asset))
+		{
+			if (UFaceFXActor* FaceFXActor = FindImportActor(AnimAsset))
+			{
+				ProcessImportedAnimation(FaceFXActor, AnimAsset, OutResultMessages);
+
+#if FACEFX_USEANIMATIONLINKAGE
+				//the active tracks are stored within the actor
+				SavePackage(FaceFXActor->GetOutermost());
+#endif //FACEFX_USEANIMATIONLINKAGE
+			}
+			else
+			{
+				OutResultMessages.AddModifyWarning(LOCTEXT("ImportActorMissing", "No FaceFX actor asset found for the animation. Jumps within the animation and the animation itself get evaluated by the FaceFX runtime."), AnimAsset);
+			}
+		}
+#if FACEFX_USEANIMATIONLINKAGE
+		else if (UFaceFXActor* ActorAsset = Cast<UFaceFXActor>(Asset))
+		{
+			//a bound callback reimports the animations of the actor, which processes them along the way
+			if (!BeforeDeletionCallback.IsBound())
+			{
+				for (UFaceFXAnim* Animation : ActorAsset->Animations)
+				{
+					if (Animation)
+					{
+						ProcessImportedAnimation(ActorAsset, Animation, OutResultMessages);
+						SavePackage(Animation->GetOutermost());
+
+						//inform FaceFX characters about updated asset
+						UFaceFXCharacter::OnAssetChanged.Broadcast(Animation);
+					}
+				}
+			}
+		}
+#endif //FACEFX_USEANIMATIONLINKAGE
+	}
+
 	BeforeDeletionCallback.ExecuteIfBound(Asset, CompilationFolder, ImportResult, OutResultMessages);
 
 	if (ImportResult)
@@ -390,6 +547,10 @@ bool FFaceFXEditorTools::LoadCompiledActorData(UFaceFXActor* Asset, const FStrin
 
 	bool DataPreviouslyHadBones = Data.BonesRawData.Num() > 0;
 
+	//the actor data is about to change -> drop the shared templates and sampler handles of the previous data
+	FFaceFXActorTemplateCache::Get().Purge(Asset);
+	FFaceFXAnimationSampler::Get().Purge(Asset);
+
 	Asset->Reset();
 
 	Data.Reset();
@@ -412,6 +573,8 @@ bool FFaceFXEditorTools::LoadCompiledActorData(UFaceFXActor* Asset, const FStrin
 	    }
 	}
 
+	Data.UpdateDataHash();
+
 	TArray<FString> Lines;
 	if (FFileHelper::LoadANSITextFileToStrings(*AssetPathIds, nullptr, Lines))
 	{
@@ -436,6 +599,8 @@ bool FFaceFXEditorTools::LoadCompiledActorData(UFaceFXActor* Asset, const FStrin
 		}
 	}
 
+	Data.UpdateIdLookup();
+
 	return true;
 }
 
@@ -604,8 +769,10 @@ UFaceFXAnim* FFaceFXEditorTools::ReimportOrCreateAnimAsset(const FString& Compil
 #if FACEFX_USEANIMATIONLINKAGE
 				//link to the new asset
 				FaceFXActor->LinkTo(ExistingAnim);
+				ProcessImportedAnimation(FaceFXActor, ExistingAnim, OutResultMessages);
 				OutResultMessages.AddModifySuccess(LOCTEXT("CreateAssetAnimExistSuccess", "Reimported already existing animation Asset and linked to Import Triggering FaceFX Actor Asset."), ExistingAnim);
 #else
+				ProcessImportedAnimation(FaceFXActor, ExistingAnim, OutResultMessages);
 				OutResultMessages.AddModifySuccess(LOCTEXT("CreateAssetAnimExistSuccess", "Reimported already existing animation Asset."), ExistingAnim);
 #endif //FACEFX_USEANIMATIONLINKAGE
 
@@ -641,8 +808,10 @@ UFaceFXAnim* FFaceFXEditorTools::ReimportOrCreateAnimAsset(const FString& Compil
 #if FACEFX_USEANIMATIONLINKAGE
 			//link to the new asset
 			FaceFXActor->LinkTo(NewAsset);
+			ProcessImportedAnimation(FaceFXActor, NewAsset, OutResultMessages);
 			OutResultMessages.AddCreateSuccess(LOCTEXT("CreateAssetAnimSuccess", "Animation Asset successfully created and linked to Import Triggering FaceFX Actor Asset."), NewAsset);
 #else
+			ProcessImportedAnimation(FaceFXActor, NewAsset, OutResultMessages);
 			OutResultMessages.AddCreateSuccess(LOCTEXT("CreateAssetAnimSuccess", "Animation Asset successfully created."), NewAsset);
 #endif //FACEFX_USEANIMATIONLINKAGE
 
@@ -815,6 +984,10 @@ bool FFaceFXEditorTools::LoadFromCompilationFolder(UFaceFXAnim* Asset, const FSt
 		return false;
 	}
 
+	//the animation data is about to change -> drop the runtime handles and sampled results of the previous data
+	FFaceFXAnimationCache::Get().Purge(Asset);
+	FFaceFXAnimationSampler::Get().Purge(Asset);
+
 #if FACEFX_DELETE_IMPORTED_ANIM
 	//The list of successfully imported files. Those will be deleted afterwards
 	TArray<FString> ImportedFiles;
@@ -881,6 +1054,18 @@ bool FFaceFXEditorTools::LoadFromCompilationFolder(UFaceFXAnim* Asset, const FSt
 		return false;
 	}
 
+	//compute the animation bounds once so runtime queries don't need to parse the data
+	if (!FaceFX::ComputeAnimationBounds(Data))
+	{
+		OutResultMessages.AddModifyError(FText::Format(LOCTEXT("LoadingCompiledAssetBoundsFailed", "Computing the animation bounds failed. File: {0}"),
+		                                               FText::FromString(File)));
+
+		Asset->Reset();
+		return false;
+	}
+
+	Data.UpdateDataHash();
+
 #if FACEFX_DELETE_IMPORTED_ANIM
 	for (const FString& ImportedFile : ImportedFiles)
 	{